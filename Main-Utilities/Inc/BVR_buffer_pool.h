@@ -0,0 +1,159 @@
+/**
+********************************************************************************
+* @author       Byron Palavikas
+* @date
+* @file         BVR_buffer_pool.h
+* @brief        reference counted fixed block buffer pool for DMA
+* @version      V0.1.0
+* @copyright    (C) COPYRIGHT
+* @target       ARM STM32
+* @IDE
+* @repo         git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*           Fixed size blocks handed out and taken back in O(1) from a lock
+*           free list, so alloc and release are safe from tasks and ISRs
+*           without masking interrupts. Every block starts on a
+*           BVR_POOL_ALIGN boundary so it can be given straight to a DMA,
+*           on a Cortex-M7 keep it at the 32 byte cache line.
+*
+*           A block is filled once and shared by every sink that sends it.
+*           Each sink takes a reference before it starts its DMA and
+*           releases it in its complete callback, the block goes back to
+*           the pool when the last reference is released.
+*
+*           EXAMPLE
+*           static uint8_t frame_blocks[8 * 256] __attribute__((aligned(BVR_POOL_ALIGN)));
+*           static pool_meta_t frame_meta[8];
+*           buffer_pool_t frame_pool;
+*
+*           BVR_pool_init(&frame_pool, frame_blocks, frame_meta, 256, 8);
+*
+*           uint8_t *frame = BVR_pool_alloc(&frame_pool);
+*           length = build_frame(frame);
+*
+*           BVR_pool_ref(&frame_pool, frame);
+*           HAL_UART_Transmit_DMA(&huart2, frame, length);
+*           BVR_pool_ref(&frame_pool, frame);
+*           sd_queue_write(frame, length);
+*           // drop the reference from the alloc, the sinks hold it now
+*           BVR_pool_release(&frame_pool, frame);
+*
+*           // in each sink complete callback
+*           BVR_pool_release(&frame_pool, frame);
+*
+********************************************************************************
+*/
+#ifndef BVR_BUFFER_POOL_H_
+#define BVR_BUFFER_POOL_H_
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <stdint.h>
+#include <stddef.h>
+#include "BVR_error.h"
+#include "BVR_common_defs.h"
+
+
+/*--DEFINES-------------------------------------------------------------------*/
+#define POOL_MAX_BLOCKS     0xFFFE  /**< most blocks in one pool */
+
+/*--PLATFORM-CONF-------------------------------------------------------------*/
+// Block alignment, 4 for DMA word transfers, 32 for the Cortex-M7 cache line
+#ifndef BVR_POOL_ALIGN
+#define BVR_POOL_ALIGN 32
+#endif
+/*--PLATFORM-CONF-------------------------------------------------------------*/
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+/**@struct pool_meta_t
+ * @brief per block bookkeeping type definition
+ * @details kept out of the blocks so every block stays aligned
+ */
+typedef struct
+{
+    uint16_t next;  /**< next free block + 1, 0 ends the list */
+    uint16_t refs;  /**< references held, 0 when free */
+}pool_meta_t;
+
+/**@struct buffer_pool_t
+ * @brief buffer pool type definition
+ * @details the free list top is the block index + 1 in the low 16 bits and
+ *          a tag in the high 16 bits that changes on every update, so a
+ *          block freed and taken again under a compare and swap is caught
+ */
+typedef struct
+{
+    uint8_t *p_blocks;      /**< block storage, count * block_size */
+    pool_meta_t *p_meta;    /**< count entries */
+    int block_size;         /**< bytes per block, multiple of BVR_POOL_ALIGN */
+    int count;              /**< number of blocks */
+    uint32_t free_top;      /**< tag (high 16) and first free block + 1 (low 16) */
+    int free_count;         /**< blocks in the free list */
+}buffer_pool_t;
+
+
+/*--FUNCTION--PROTOTYPE-------------------------------------------------------*/
+
+/**
+  * @brief Initialise a pool over caller storage
+  * @note  blocks must be aligned to BVR_POOL_ALIGN
+  * @param buffer_pool_t *pool
+  * @param uint8_t blocks[] count * block_size bytes
+  * @param pool_meta_t meta[] count entries
+  * @param int block_size multiple of BVR_POOL_ALIGN
+  * @param int count 1 to POOL_MAX_BLOCKS
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_pool_init(buffer_pool_t *pool, uint8_t blocks[], pool_meta_t meta[],
+                                  int block_size, int count);
+
+/**
+  * @brief Take a block from the pool
+  * @note  the block comes with one reference, ISR safe
+  * @param buffer_pool_t *pool
+  * @retval uint8_t * NULL when the pool is empty
+  */
+extern uint8_t *BVR_pool_alloc(buffer_pool_t *pool);
+
+/**
+  * @brief Take another reference to a block
+  * @note  only on a block that already holds a reference, ISR safe
+  * @param buffer_pool_t *pool
+  * @param uint8_t *block as returned by BVR_pool_alloc
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_pool_ref(buffer_pool_t *pool, uint8_t *block);
+
+/**
+  * @brief Drop a reference, the last one gives the block back
+  * @note  ISR safe, call from a DMA complete callback
+  * @param buffer_pool_t *pool
+  * @param uint8_t *block as returned by BVR_pool_alloc
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_pool_release(buffer_pool_t *pool, uint8_t *block);
+
+/**
+  * @brief Number of free blocks
+  * @param buffer_pool_t *pool
+  * @retval int
+  */
+extern int BVR_pool_free_count(buffer_pool_t *pool);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BVR_BUFFER_POOL_H_ */
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
@@ -1,53 +1,71 @@
-/**
-********************************************************************************
-* @author   Byron Palavikas
-* @date 
-* @file
-* @brief
-* @version  V0.1
-* @copyright (C) COPYRIGHT
-* @target   STM32
-* @IDE
-* @repo    git@github.com:bpalavikas/STM32-helper.git
-*
-********************************************************************************
-* @attention
-*
-********************************************************************************
-*/
-#ifndef BVR_COMMON_DEFS_H_
-#define BVR_COMMON_DEFS_H_
-/******************************************************************************/
-/*                                                                            */
-/******************************************************************************/
-#ifdef __cplusplus
-extern "C"
-{
-#endif
-
-
-/*--INCLUDES------------------------------------------------------------------*/
-
-/******************************************************************************/
-/*                        PLATFORM CONF                                       */
-/******************************************************************************/
-
-
-/******************************************************************************/
-/*                        PLATFORM CONF                                       */
-/******************************************************************************/
-
-/*--DEFINES-------------------------------------------------------------------*/
-
-
-
-/*--MACROS--------------------------------------------------------------------*/
-
-#ifdef __cplusplus
-}
-#endif
-
-#endif /* */
-/******************************************************************************/
-/*                             END OF FILE                                    */
-/******************************************************************************/
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date 
+* @file
+* @brief
+* @version  V0.1
+* @copyright (C) COPYRIGHT
+* @target   STM32
+* @IDE
+* @repo    git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*
+********************************************************************************
+*/
+#ifndef BVR_COMMON_DEFS_H_
+#define BVR_COMMON_DEFS_H_
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+
+/******************************************************************************/
+/*                        PLATFORM CONF                                       */
+/******************************************************************************/
+// HAL header for the MCU, change to suit MCU
+// A native build on a PC can point this at a stand in header
+// e.g. -DBVR_MCU_HAL='"host_hal.h"' to run the utilities without a board
+#ifndef BVR_MCU_HAL
+#define BVR_MCU_HAL "stm32f4xx_hal.h"
+#endif
+
+/******************************************************************************/
+/*                        PLATFORM CONF                                       */
+/******************************************************************************/
+
+/*--DEFINES-------------------------------------------------------------------*/
+
+
+
+/*--MACROS--------------------------------------------------------------------*/
+
+/* Shared memory access between tasks, ISRs and DMA.
+ * GCC lowers these to ldr/str + dmb on Cortex-M and to the C11 memory model
+ * on the host, so the same code runs on both. */
+#define BVR_LOAD_ACQUIRE(p)         __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define BVR_STORE_RELEASE(p, v)     __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define BVR_MEMORY_BARRIER()        __atomic_thread_fence(__ATOMIC_SEQ_CST)
+/* ldrex/strex loops on Cortex-M3/M4/M7, not available on Cortex-M0 */
+#define BVR_COMPARE_EXCHANGE(p, e, v) \
+    __atomic_compare_exchange_n((p), (e), (v), 1, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#define BVR_ATOMIC_ADD(p, v)        __atomic_add_fetch((p), (v), __ATOMIC_ACQ_REL)
+#define BVR_ATOMIC_SUB(p, v)        __atomic_sub_fetch((p), (v), __ATOMIC_ACQ_REL)
+#define BVR_ATOMIC_AND(p, v)        __atomic_and_fetch((p), (v), __ATOMIC_ACQ_REL)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* */
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
@@ -1,332 +1,531 @@
-/**
-*******************************************************************************
-*
-* @author       Byron Palavikas 
-* @date         10/09/2023
-* @file         debug_logger.h
-* @brief        embedded debug logging
-* @version      V0.1.0
-* @copyright    (C) COPYRIGHT
-* @target       STM32 MCU
-* @IDE          NVIM
-* @repo         git@github.com:bpalavikas/STM32-helper.git
-*
-*
-*******************************************************************************
-*@attention
-*   This is the debug logger 
-    Warning levels are set 
-    TRACE to trace the flow of the firmware show function entry and exit
-
-    DBG use for debug prints that are only to make sure something is working 
-    getting the values of sensors
-
-    INFO use to log info that is not an error and above debug values like
-    start stop services connection to pipes and ports
-
-    WARN use for error checking on potential issues that should have correction 
-    in the code  
-
-    ERR errors that are fatal to an operation that can not be specifically 
-    corrected in the code, but system operation will continue
-
-    FATAL when the system has crashed and something can not be recovered 
-    hardfault errors watchdog forced restarts error handlers
-
-    STARTUP is only used for start up information like firmware version
-    and any other information always needed at start up this will always print
-    no matter what the log level is set to so do not put sensitive information here
-    Use DBG for sensetive start up information 
-
-    To set an ID for each print in the c file add const char* ID = <"Sensor">
-    different ID can be set and passed. 
-
-    This uses the BVR_fifo_buffer.h so make sure you have this included in your project
-    Make sure to change the defines for the uart and dma handles to match settings and
-    the MCU
-    If using segger system view make sure to include everything and set the define 
-*    
-*   EXAMPLE
-*   static const char* ID = "CO2";
-*   BVR_LOG_ID(INFO, ID, "This is the INFO message");
-*   
-*   OUTPUT
-*   INFO <-> CO2 : This is the INFO message
-*
-*   EXAMPLE WITH NO ID
-*   BVR_LOG(TRACE, "This is the TRACE message");
-*
-*   OUTPUT
-*   TRACE   : This is the TRACE message 
-*
-*   In main.c
-*   Make sure to create fifo_t dbg_uart_tx_fifo; in private variables
-*   EAXAMPLE CODE FOR MAIN.C
-
-// Private typedef 
-fifo_t dbg_uart_tx_fifo;
-
-
-// USER CODE BEGIN 0
-// set up the call back for the uart and fifo
-void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
-{ 
-    volatile temp_buffer_t temp_dma;
-    if(huart == &DBG_HUART)
-    {
-        // pop from the fifo 
-        temp_dma = BVR_fifo_pop_from_temp(&dbg_uart_tx_fifo);
-        // Send to the DMA
-        HAL_UART_Transmit_DMA(  &DBG_HUART, 
-                                temp_dma.p_temp_buff, 
-                                temp_dma.buff_size);
-    }
-}
-
-// USER CODE BEGIN 2
-#if !SEGGER_DBG
-    // init the uart debug
-    BVR_uart_debug_init();
-#endif
-
-If not using Segger you only need the init function not the segger guards
-// Init the debug uart
-BVR_uart_debug_init();
-
-// OTHER CODE HERE
-
-! Only needed using segger system view
-// SEGGER SYSTEM VIEW
-// THIS MUST BE CALLED AFTER EVERYTHING ELSE
-// ONLY MX_FREERTOS_Init() then osKernelStart() should be called after this
-#if SEGGER_DBG
-    SystemInit();
-    SEGGER_SYSVIEW_Conf();
-    SEGGER_SYSVIEW_Start();
-#endif
-
-TROUBLE SHOOTING
- Make sure to set the uart DMA 
- Set the rx DMA as circular ! rx is your FIFO
- Make sure to set the the Global Interrupt NVIC settings
- Dont forget to initialise with the initialise function.
-
-*
-*******************************************************************************
-*/
-#ifndef BVR_DEBUG_LOGGER_H_
-#define BVR_DEBUG_LOGGER_H_
-/******************************************************************************/
-/*                                                                            */
-/******************************************************************************/
-#ifdef __cplusplus
-extern "C"
-{
-#endif
-
-/*--INCLUDES------------------------------------------------------------------*/
-#include <stdio.h>
-#include <string.h>
-#include <stdarg.h>
-#include <stdint.h>
-#include <ctype.h>
-#include <stdarg.h>
-#include "BVR_error.h"
-// Change for MCU
-#include "stm32f4xx_hal.h"
-
-/*--DEFINES-------------------------------------------------------------------*/
-#define LOG_BUFFER_SIZE 200
-
-// debug levels
-#define TRACE   6   /**< print out everything all */
-#define DBG     5   /**< for debug */
-#define INFO    4   /**< information like functions where code is*/
-#define WARN    3   /**< warnings */
-#define ERR     2   /**< error this is bad */
-#define FATAL   1   /**< System issue */
-#define STARTUP 1   /**< start up information on firmware version */
-
-
-/*--PLATFORM-CONF-------------------------------------------------------------*/
-// Set log level
-#define LOG_LEVEL TRACE
-// Set segger Logging = 1 UART = 0
-#define SEGGER 1
-/*--PLATFORM-CONF-------------------------------------------------------------*/
-
-#define ARRAY_SIZE(A) (sizeof(A)/sizeof(A[0]))
-#define UART_BUFFER_LENGTH 256
-#define STRING_LENGTH 128
-
-/** This is to be set dependent on your MCU and uart*/
-#define DBG_HUART   huart2
-#define DBG_HDMA_RX hdma_usart2_rx
-#define DBG_HDMA_TX hdma_usart2_tx
-
-
-/*--MACROS--------------------------------------------------------------------*/
-
-#define BVR_LOG(level, format, ...) _LOG_##level(NULL, format, ##__VA_ARGS__)
-
-#define BVR_LOG_ID(level, id, format, ...) _LOG_##level(id, format, ##__VA_ARGS__)
-
-// Define your level-specific macros as before
-#if LOG_LEVEL >= TRACE 
-#define _LOG_TRACE(id, format, ...) __LOG(TRACE, id, format, ##__VA_ARGS__)
-#else
-#define _LOG_TRACE(...)
-#endif
-
-#if LOG_LEVEL >= DBG
-#define _LOG_DBG(id, format, ...) __LOG(DBG, id, format, ##__VA_ARGS__)
-#else
-#define _LOG_DBG(...)
-#endif
-
-#if LOG_LEVEL >= INFO
-#define _LOG_INFO(id, format, ...) __LOG(INFO, id, format, ##__VA_ARGS__)
-#else
-#define _LOG_INFO(...)
-#endif
-
-#if LOG_LEVEL >= WARN
-#define _LOG_WARN(id, format, ...) __LOG(WARN, id, format, ##__VA_ARGS__)
-#else
-#define _LOG_WARN(...)
-#endif
-
-#if LOG_LEVEL >= ERR 
-#define _LOG_ERR(id, format, ...) __LOG(ERR, id, format, ##__VA_ARGS__)
-#else
-#define _LOG_ERR(...)
-#endif
-
-#if LOG_LEVEL >= FATAL 
-#define _LOG_FATAL(id, format, ...) __LOG(FATAL, id, format, ##__VA_ARGS__)
-#else
-#define _LOG_FATAL(...)
-#endif
-
-#if LOG_LEVEL >= STARTUP
-#define _LOG_STARTUP(id, format, ...) __LOG(STARTUP, id, format, ##__VA_ARGS__)
-#else
-#define _LOG_STARTUP(...)
-#endif
-
-// Log functions
-#define __LOG(level, id, format, ...) \
-    do { \
-        if (id) { \
-            log_print(#level " <-> %s : " format "\r\n", id, ##__VA_ARGS__); \
-        } else { \
-            log_print(#level "\t: " format "\r\n", ##__VA_ARGS__); \
-        } \
-    } while (0)
-
-
-    
-
-/*--DATA--TYPE--------------------------------------------------------------*/
-// external uart dma handles types
-extern UART_HandleTypeDef huart2; 
-extern DMA_HandleTypeDef  hdma_usart2_rx;
-extern DMA_HandleTypeDef  hdma_usart2_tx;
-
-
-/**@struct log_buffer_t
- * @brief log buffer holds log message to send to uart
- * log buffer */
-typedef struct
-{
-    uint8_t     buffer[LOG_BUFFER_SIZE]; /** buffer for log message */
-    int         size; /** size of buffer */
-}log_buffer_t;
-
-
-/** @struct log_message_t
- * @brief log message holds log message to send to uart more detailed
- * log message */
-typedef struct
-{
-    log_buffer_t    log_buffer; /** buffer for log message */ 
-    uint8_t         buffer[LOG_BUFFER_SIZE]; /** buffer for log message */
-    uint16_t        msg_type; /** type of message */
-    int             length; /** length of message */
-}log_message_t;
-
-
-/** @enum  uart_debug_status_t
- * @brief uart debug status for error checking
- * Debug status */
-typedef enum 
-{
-    DBG_SUCCESS,
-    DBG_ERROR
-}uart_debug_status_t; 
-
-
-/*--FUNCTION--PROTOTYPE-------------------------------------------------------*/
-
-/**
-* @brief Formatted string function for debug log and segger logs
-* @note  Define if segger or debug uart in debug_logger.h 
-* @param  const char *fmt, ...
-* @retval void 
-*/
-extern void log_print(const char *fmt, ...);
-
-
-/**
-  * @brief Sets the buffers for uart and sets fifo pointers to tx buffers
-  *        Will disable the Interrupts for DMA
-  * @note !Make sure correct uart handles are set for uart and dma 
-  * @param void
-  * @retval void
-  */
-void BVR_uart_debug_init(void);
-
-
-/**
-* @brief Gets characters from DMA rx moving to buffer
-*        looking for escape characters terminates on null terminator  
-* @note
-* @param  UART_HandleTypeDef *huart
-* @param char data[]
-* @param int data_len 
-* @retval void
-*/
-void BVR_uart_debug_get(  UART_HandleTypeDef *huart, 
-                        char data[],
-                        int data_len);
-
-
-/**
-* @brief Resets head and tail pointers with huart NDTR reg 
-*        resets uart handle rx counter 
-* @note
-* @param UART_HandleTypeDef *huart
-* @retval void
-*/
-void BVR_uart_debug_flush(UART_HandleTypeDef *huart);
-
-
-/**
-* @brief Pushes fifo buffer then will pop from temp buffer to send to the DMA
-* @note ! waits for ready state if uart is busy will miss the sent buffer
-* @param uint8_t *p_data 
-* @param int size
-* @retval uart_debug_status_t
-*/
-BVR_status_t BVR_uart_debug_send(uint8_t *p_data, int size);
-
-
-#ifdef __cplusplus
-}
-#endif
-
- 
-#endif /*debug_logger.h*/
-/******************************************************************************/
-/*                              END OF FILE                                   */
-/******************************************************************************/
+/**
+*******************************************************************************
+*
+* @author       Byron Palavikas 
+* @date         10/09/2023
+* @file         debug_logger.h
+* @brief        embedded debug logging
+* @version      V0.1.0
+* @copyright    (C) COPYRIGHT
+* @target       STM32 MCU
+* @IDE          NVIM
+* @repo         git@github.com:bpalavikas/STM32-helper.git
+*
+*
+*******************************************************************************
+*@attention
+*   This is the debug logger 
+    Warning levels are set 
+    TRACE to trace the flow of the firmware show function entry and exit
+
+    DBG use for debug prints that are only to make sure something is working 
+    getting the values of sensors
+
+    INFO use to log info that is not an error and above debug values like
+    start stop services connection to pipes and ports
+
+    WARN use for error checking on potential issues that should have correction 
+    in the code  
+
+    ERR errors that are fatal to an operation that can not be specifically 
+    corrected in the code, but system operation will continue
+
+    FATAL when the system has crashed and something can not be recovered 
+    hardfault errors watchdog forced restarts error handlers
+
+    STARTUP is only used for start up information like firmware version
+    and any other information always needed at start up this will always print
+    no matter what the log level is set to so do not put sensitive information here
+    Use DBG for sensetive start up information 
+
+    To set an ID for each print in the c file add const char* ID = <"Sensor">
+    different ID can be set and passed. 
+
+    This uses the BVR_fifo_buffer.h so make sure you have this included in your project
+    Make sure to change the defines for the uart and dma handles to match settings and
+    the MCU
+    If using segger system view make sure to include everything and set the define 
+*    
+*   EXAMPLE
+*   static const char* ID = "CO2";
+*   BVR_LOG_ID(INFO, ID, "This is the INFO message");
+*   
+*   OUTPUT
+*   INFO <-> CO2 : This is the INFO message
+*
+*   EXAMPLE WITH NO ID
+*   BVR_LOG(TRACE, "This is the TRACE message");
+*
+*   OUTPUT
+*   TRACE   : This is the TRACE message 
+*
+*   In main.c
+*   Make sure to create fifo_t dbg_uart_tx_fifo; in private variables
+*   EAXAMPLE CODE FOR MAIN.C
+
+// Private typedef 
+fifo_t dbg_uart_tx_fifo;
+
+
+// USER CODE BEGIN 0
+// set up the call back for the uart and fifo
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{ 
+    if(huart == &DBG_HUART)
+    {
+        // free what was just sent and send the next span,
+        // warnings and worse go before queued traces
+        BVR_uart_debug_tx_cplt();
+    }
+}
+
+// USER CODE BEGIN 2
+#if !SEGGER_DBG
+    // init the uart debug
+    BVR_uart_debug_init();
+#endif
+
+If not using Segger you only need the init function not the segger guards
+// Init the debug uart
+BVR_uart_debug_init();
+
+// OTHER CODE HERE
+
+! Only needed using segger system view
+// SEGGER SYSTEM VIEW
+// THIS MUST BE CALLED AFTER EVERYTHING ELSE
+// ONLY MX_FREERTOS_Init() then osKernelStart() should be called after this
+#if SEGGER_DBG
+    SystemInit();
+    SEGGER_SYSVIEW_Conf();
+    SEGGER_SYSVIEW_Start();
+#endif
+
+DEFERRED LOGGING
+ With LOG_DEFERRED set BVR_LOG and BVR_LOG_ID do not format on the target.
+ They store the address of the format string, the tick and each argument
+ as a 32 bit word, the format strings live in the .bvr_log_fmt section that
+ is never loaded so they cost no flash. Add it to the linker script
+    .bvr_log_fmt 0 (INFO) : { KEEP(*(.bvr_log_fmt)) }
+ and rebuild the text on the PC from the ELF and a capture of the uart
+    python3 tools/bvr_log_decode.py firmware.elf capture.bin
+ Up to LOG_DEFERRED_MAX_ARGS integer, char or pointer arguments, %s must
+ point at a constant string (flash) so the decoder can read it from the ELF,
+ a string built in RAM only decodes as its address. Log those with
+ BVR_LOG_TEXT, it formats on the target in every mode
+    BVR_LOG_TEXT(STARTUP, "FIRMWARE COMPILE DATE: %s", firmware_date);
+ Float arguments are not supported. log_print still sends text and the
+ decoder passes it through. Not used with SEGGER_DBG.
+
+ Record, little endian
+    0xB5 | nargs | format address (4) | tick (4) | nargs * arg (4)
+
+LOGGER TASK
+ With LOG_TASK set (FreeRTOS only) BVR_LOG, log_print and BVR_uart_debug_send
+ only push into the uart lanes and notify a logger task, they never touch the
+ HAL. BVR_uart_debug_init creates the task at LOG_TASK_PRIORITY with
+ LOG_TASK_STACK words, it sends every contiguous span that is waiting as one
+ DMA transfer, urgent lane first, and sleeps until BVR_uart_debug_tx_cplt
+ says it is out. Give it another sink (RTT, SD card) with BVR_log_set_sink.
+ SEGGER_DBG still prints straight to system view from the caller.
+
+RUNTIME MODULE LEVELS
+ Each id used with BVR_LOG_ID gets a slot in a level table the first time it
+ logs, after that a filtered message costs a load and a compare and is
+ never formatted. LOG_LEVEL still compiles levels out, the table can only
+ quieten what is left. Turn everything down and one module up from a
+ debug shell without reflashing
+    BVR_log_set_level(NULL, WARN);
+    BVR_log_set_level("IMU", TRACE);
+ Up to LOG_MAX_MODULES - 1 ids get their own slot, any more share the last.
+ BVR_LOG without an id is not filtered at runtime.
+
+TROUBLE SHOOTING
+ Make sure to set the uart DMA 
+ Set the rx DMA as circular ! rx is your FIFO
+ Make sure to set the the Global Interrupt NVIC settings
+ Dont forget to initialise with the initialise function.
+
+*
+*******************************************************************************
+*/
+#ifndef BVR_DEBUG_LOGGER_H_
+#define BVR_DEBUG_LOGGER_H_
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <ctype.h>
+#include <stdarg.h>
+#include "BVR_error.h"
+#include "BVR_common_defs.h"
+// Change for MCU in BVR_common_defs.h
+#include BVR_MCU_HAL
+
+/*--DEFINES-------------------------------------------------------------------*/
+#define LOG_BUFFER_SIZE 200
+#define LOG_DEFERRED_SYNC       0xB5    /**< first byte of a deferred record */
+#define LOG_DEFERRED_MAX_ARGS   16      /**< most arguments in a deferred record */
+
+// debug levels
+#define TRACE   6   /**< print out everything all */
+#define DBG     5   /**< for debug */
+#define INFO    4   /**< information like functions where code is*/
+#define WARN    3   /**< warnings */
+#define ERR     2   /**< error this is bad */
+#define FATAL   1   /**< System issue */
+#define STARTUP 1   /**< start up information on firmware version */
+
+
+/*--PLATFORM-CONF-------------------------------------------------------------*/
+// Set log level
+#define LOG_LEVEL TRACE
+// Levels at or above this go out first on their own uart lane
+#define LOG_URGENT_LEVEL WARN
+// Urgent lines sent for every bulk line when both are waiting
+#define LOG_URGENT_WEIGHT 4
+// Set segger Logging = 1 UART = 0
+#define SEGGER 1
+// Deferred binary logging on the uart = 1 text = 0, see LOG_DEFERRED below
+#ifndef LOG_DEFERRED
+#define LOG_DEFERRED 0
+#endif
+// Tick stored with each deferred record, change for MCU
+#ifndef LOG_TICK
+#define LOG_TICK() HAL_GetTick()
+#endif
+// Logger task drains the uart lanes = 1 producers start the DMA = 0, needs FreeRTOS
+#ifndef LOG_TASK
+#define LOG_TASK 0
+#endif
+// Logger task priority, keep it low so logging never preempts real work
+#ifndef LOG_TASK_PRIORITY
+#define LOG_TASK_PRIORITY (tskIDLE_PRIORITY + 1)
+#endif
+// Logger task stack in words, it only claims spans and calls the sink
+#ifndef LOG_TASK_STACK
+#define LOG_TASK_STACK 256
+#endif
+// Logger task retries a span the sink refused after this long, in ms
+#ifndef LOG_TASK_RETRY_MS
+#define LOG_TASK_RETRY_MS 10
+#endif
+// Scratch RAM is (LOG_TASK_SCRATCH + LOG_ISR_SCRATCH) * LOG_BUFFER_SIZE bytes,
+// 1400 B as set here. 1 and 1 is 400 B, about the old log_message_t, but a
+// line logged while every buffer for its context is in use counts as dropped
+// Lines formatted at once from tasks, one scratch buffer each, at most 32
+#ifndef LOG_TASK_SCRATCH
+#define LOG_TASK_SCRATCH 4
+#endif
+// Interrupt nesting levels that can log, one scratch buffer each
+#ifndef LOG_ISR_SCRATCH
+#define LOG_ISR_SCRATCH 3
+#endif
+// BVR_LOG_ID ids with their own runtime level, the rest share one slot
+#ifndef LOG_MAX_MODULES
+#define LOG_MAX_MODULES 16
+#endif
+/*--PLATFORM-CONF-------------------------------------------------------------*/
+
+#define ARRAY_SIZE(A) (sizeof(A)/sizeof(A[0]))
+#define UART_BUFFER_LENGTH 256
+#define STRING_LENGTH 128
+
+/** This is to be set dependent on your MCU and uart*/
+#define DBG_HUART   huart2
+#define DBG_HDMA_RX hdma_usart2_rx
+#define DBG_HDMA_TX hdma_usart2_tx
+
+
+/*--MACROS--------------------------------------------------------------------*/
+
+#define BVR_LOG(level, format, ...) _LOG_##level(NULL, format, ##__VA_ARGS__)
+
+#define BVR_LOG_ID(level, id, format, ...) _LOG_##level(id, format, ##__VA_ARGS__)
+
+// Formatted on the target even with LOG_DEFERRED, for %s strings in RAM
+#define BVR_LOG_TEXT(level, format, ...) \
+    do { \
+        if (LOG_LEVEL >= level) { \
+            log_print_level(level, #level "\t: " format "\r\n", ##__VA_ARGS__); \
+        } \
+    } while (0)
+
+// Define your level-specific macros as before
+#if LOG_LEVEL >= TRACE 
+#define _LOG_TRACE(id, format, ...) __LOG(TRACE, id, format, ##__VA_ARGS__)
+#else
+#define _LOG_TRACE(...)
+#endif
+
+#if LOG_LEVEL >= DBG
+#define _LOG_DBG(id, format, ...) __LOG(DBG, id, format, ##__VA_ARGS__)
+#else
+#define _LOG_DBG(...)
+#endif
+
+#if LOG_LEVEL >= INFO
+#define _LOG_INFO(id, format, ...) __LOG(INFO, id, format, ##__VA_ARGS__)
+#else
+#define _LOG_INFO(...)
+#endif
+
+#if LOG_LEVEL >= WARN
+#define _LOG_WARN(id, format, ...) __LOG(WARN, id, format, ##__VA_ARGS__)
+#else
+#define _LOG_WARN(...)
+#endif
+
+#if LOG_LEVEL >= ERR 
+#define _LOG_ERR(id, format, ...) __LOG(ERR, id, format, ##__VA_ARGS__)
+#else
+#define _LOG_ERR(...)
+#endif
+
+#if LOG_LEVEL >= FATAL 
+#define _LOG_FATAL(id, format, ...) __LOG(FATAL, id, format, ##__VA_ARGS__)
+#else
+#define _LOG_FATAL(...)
+#endif
+
+#if LOG_LEVEL >= STARTUP
+#define _LOG_STARTUP(id, format, ...) __LOG(STARTUP, id, format, ##__VA_ARGS__)
+#else
+#define _LOG_STARTUP(...)
+#endif
+
+// Log functions
+#if LOG_DEFERRED && !SEGGER_DBG
+#define _LOG_OUT(level, format, ...) _LOG_DEFER(level, format, ##__VA_ARGS__)
+#else
+#define _LOG_OUT(level, format, ...) log_print_level(level, format, ##__VA_ARGS__)
+#endif
+
+// each call site keeps its module slot, slot 0 lets the first call through to intern
+#define __LOG(level, id, format, ...) \
+    do { \
+        static uint8_t _log_module = 0; \
+        if (!(id)) { \
+            _LOG_OUT(level, #level "\t: " format "\r\n", ##__VA_ARGS__); \
+        } else if (log_module_quiet[_log_module] <= LOG_LEVEL - level) { \
+            if (_log_module == 0) { _log_module = log_module_intern(id); } \
+            if (log_module_quiet[_log_module] <= LOG_LEVEL - level) { \
+                _LOG_OUT(level, #level " <-> %s : " format "\r\n", id, ##__VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+// Deferred record, the format string only exists in the ELF and every
+// argument is sent as a word, a %s in RAM reaches the decoder as an address
+#define _LOG_DEFER(level, format, ...) \
+    do { \
+        static const char _log_fmt[] __attribute__((section(".bvr_log_fmt"), used)) = format; \
+        const uint32_t _log_args[] = {0, _LOG_WORDS(__VA_ARGS__)}; \
+        log_defer(level, _log_fmt, &_log_args[1], _LOG_NARGS(__VA_ARGS__)); \
+    } while (0)
+
+// Count and cast up to LOG_DEFERRED_MAX_ARGS arguments to 32 bit words
+#define _LOG_NARGS(...) _LOG_NARGS_(_, ##__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, \
+                                   8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define _LOG_NARGS_(_, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, N, ...) N
+#define _LOG_CAT(a, b) _LOG_CAT_(a, b)
+#define _LOG_CAT_(a, b) a##b
+#define _LOG_WORDS(...) _LOG_CAT(_LOG_W, _LOG_NARGS(__VA_ARGS__))(__VA_ARGS__)
+#define _LOG_WORD(a) (uint32_t)(uintptr_t)(a)
+#define _LOG_W0()
+#define _LOG_W1(a) _LOG_WORD(a)
+#define _LOG_W2(a, ...) _LOG_WORD(a), _LOG_W1(__VA_ARGS__)
+#define _LOG_W3(a, ...) _LOG_WORD(a), _LOG_W2(__VA_ARGS__)
+#define _LOG_W4(a, ...) _LOG_WORD(a), _LOG_W3(__VA_ARGS__)
+#define _LOG_W5(a, ...) _LOG_WORD(a), _LOG_W4(__VA_ARGS__)
+#define _LOG_W6(a, ...) _LOG_WORD(a), _LOG_W5(__VA_ARGS__)
+#define _LOG_W7(a, ...) _LOG_WORD(a), _LOG_W6(__VA_ARGS__)
+#define _LOG_W8(a, ...) _LOG_WORD(a), _LOG_W7(__VA_ARGS__)
+#define _LOG_W9(a, ...) _LOG_WORD(a), _LOG_W8(__VA_ARGS__)
+#define _LOG_W10(a, ...) _LOG_WORD(a), _LOG_W9(__VA_ARGS__)
+#define _LOG_W11(a, ...) _LOG_WORD(a), _LOG_W10(__VA_ARGS__)
+#define _LOG_W12(a, ...) _LOG_WORD(a), _LOG_W11(__VA_ARGS__)
+#define _LOG_W13(a, ...) _LOG_WORD(a), _LOG_W12(__VA_ARGS__)
+#define _LOG_W14(a, ...) _LOG_WORD(a), _LOG_W13(__VA_ARGS__)
+#define _LOG_W15(a, ...) _LOG_WORD(a), _LOG_W14(__VA_ARGS__)
+#define _LOG_W16(a, ...) _LOG_WORD(a), _LOG_W15(__VA_ARGS__)
+
+
+    
+
+/*--DATA--TYPE--------------------------------------------------------------*/
+// external uart dma handles types
+extern UART_HandleTypeDef huart2; 
+extern DMA_HandleTypeDef  hdma_usart2_rx;
+extern DMA_HandleTypeDef  hdma_usart2_tx;
+
+
+// levels each BVR_LOG_ID module is turned down from LOG_LEVEL, 0 is LOG_LEVEL,
+// see BVR_log_set_level
+extern uint8_t log_module_quiet[LOG_MAX_MODULES + 1];
+
+
+/**@brief log sink type definition
+ * @details called from the logger task with one contiguous span of queued
+ *          lines, return once the data is sent or copied, it may block.
+ *          Anything but BVR_OK keeps the span queued, it is offered again
+ *          when more is logged or after LOG_TASK_RETRY_MS */
+typedef BVR_status_t (*log_sink_t)(const uint8_t *p_data, int size);
+
+
+/** @enum  uart_debug_status_t
+ * @brief uart debug status for error checking
+ * Debug status */
+typedef enum 
+{
+    DBG_SUCCESS,
+    DBG_ERROR
+}uart_debug_status_t; 
+
+
+/*--FUNCTION--PROTOTYPE-------------------------------------------------------*/
+
+/**
+* @brief Formatted string function for debug log and segger logs
+* @note  Define if segger or debug uart in debug_logger.h 
+*        Reentrant and ISR safe, each context formats into its own scratch
+*        buffer and the uart path pushes the whole line in one go, so lines
+*        never interleave. With no scratch free the line counts as dropped.
+*        Formats with BVR_vsnprintf, lines longer than LOG_BUFFER_SIZE are cut
+* @param  const char *fmt, ...
+* @retval void 
+*/
+extern void log_print(const char *fmt, ...);
+
+/**
+* @brief log_print for a level, used by the BVR_LOG macros
+* @note  on the uart path LOG_URGENT_LEVEL and above go to the urgent lane
+*        and are sent before queued lower level lines, log_print is INFO
+* @param  int level
+* @param  const char *fmt, ...
+* @retval void 
+*/
+extern void log_print_level(int level, const char *fmt, ...);
+
+/**
+* @brief Queue a deferred binary record, used by the BVR_LOG macros
+* @note  only built with LOG_DEFERRED, the record goes in the lane for level
+* @param  int level
+* @param  const char *fmt in .bvr_log_fmt
+* @param  const uint32_t *args
+* @param  int nargs up to LOG_DEFERRED_MAX_ARGS
+* @retval void 
+*/
+extern void log_defer(int level, const char *fmt, const uint32_t *args, int nargs);
+
+/**
+  * @brief Slot of a BVR_LOG_ID id in the module level table, used by the macros
+  * @note  ISR safe, ids are matched by string so the same name in two
+  *        files shares a slot, the id must stay valid (string literal)
+  * @param  const char *id
+  * @retval uint8_t slot 1 to LOG_MAX_MODULES, the last is shared once full
+  */
+extern uint8_t log_module_intern(const char *id);
+
+/**
+  * @brief Set the runtime level of one BVR_LOG_ID module
+  * @note  only narrows what LOG_LEVEL compiles in, FATAL and STARTUP always
+  *        print. NULL sets every module and the level new modules start at
+  * @param  const char *id or NULL for all
+  * @param  int level TRACE to FATAL
+  * @retval void
+  */
+extern void BVR_log_set_level(const char *id, int level);
+
+/**
+  * @brief Runtime level of one BVR_LOG_ID module
+  * @param  const char *id or NULL for the level new modules start at
+  * @retval int
+  */
+extern int BVR_log_get_level(const char *id);
+
+/**
+  * @brief Call from HAL_UART_TxCpltCallback for the debug uart
+  * @note  releases what was sent and starts the next span, with LOG_TASK
+  *        it wakes the logger task to do that
+  * @param void
+  * @retval void
+  */
+void BVR_uart_debug_tx_cplt(void);
+
+#if LOG_TASK
+/**
+  * @brief Send the queued lines somewhere other than the debug uart
+  * @note  only built with LOG_TASK, call before BVR_uart_debug_init or
+  *        before the scheduler starts, NULL puts the uart sink back
+  * @param log_sink_t sink
+  * @retval void
+  */
+void BVR_log_set_sink(log_sink_t sink);
+#endif
+
+
+/**
+  * @brief Sets the buffers for uart and sets fifo pointers to tx buffers
+  *        Will disable the Interrupts for DMA
+  * @note !Make sure correct uart handles are set for uart and dma 
+  * @param void
+  * @retval void
+  */
+void BVR_uart_debug_init(void);
+
+
+/**
+* @brief Gets characters from DMA rx moving to buffer
+*        looking for escape characters terminates on null terminator  
+* @note
+* @param  UART_HandleTypeDef *huart
+* @param char data[]
+* @param int data_len 
+* @retval void
+*/
+void BVR_uart_debug_get(  UART_HandleTypeDef *huart, 
+                        char data[],
+                        int data_len);
+
+
+/**
+* @brief Resets head and tail pointers with huart NDTR reg 
+*        resets uart handle rx counter 
+* @note
+* @param UART_HandleTypeDef *huart
+* @retval void
+*/
+void BVR_uart_debug_flush(UART_HandleTypeDef *huart);
+
+
+/**
+* @brief Pushes fifo buffer then will pop from temp buffer to send to the DMA
+* @note  queued behind lines already waiting, BVR_ERROR when it does not fit
+*        or the DMA would not start, in which case it stays queued and goes
+*        with the next line
+* @param uint8_t *p_data 
+* @param int size
+* @retval uart_debug_status_t
+*/
+BVR_status_t BVR_uart_debug_send(uint8_t *p_data, int size);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+ 
+#endif /*debug_logger.h*/
+/******************************************************************************/
+/*                              END OF FILE                                   */
+/******************************************************************************/
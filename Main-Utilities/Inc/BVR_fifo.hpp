@@ -0,0 +1,216 @@
+/**
+********************************************************************************
+* @author       Byron Palavikas
+* @date
+* @file         BVR_fifo.hpp
+* @brief        typed compile time capacity fifo for C++17 projects
+* @version      V0.1.0
+* @copyright    (C) COPYRIGHT
+* @target       ARM STM32
+* @IDE
+* @repo         git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*           Header only, same rules as fifo_t in BVR_fifo_buffer.h
+*           single producer single consumer safe without masking interrupts,
+*           pushes and pops are all or nothing and return BVR_status_t.
+*           N must be a power of two so every wrap is a mask the compiler
+*           can fold, the full N elements are usable.
+*
+*           EXAMPLE
+*           static BVR::Fifo<sensor_sample_t, 64> sample_fifo;
+*
+*           // ISR
+*           sample_fifo.push(sample);
+*
+*           // task
+*           sensor_sample_t samples[16];
+*           if(sample_fifo.pop(samples) == BVR_OK) { ... }
+*
+********************************************************************************
+*/
+#ifndef BVR_FIFO_HPP_
+#define BVR_FIFO_HPP_
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include "BVR_error.h"
+
+
+namespace BVR
+{
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+/**@class Fifo
+ * @brief typed single producer single consumer fifo
+ * @details head and tail are free running counters, the index is the
+ *          counter masked with N - 1 and the level is head - tail
+ */
+template <typename T, std::size_t N>
+class Fifo
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "BVR::Fifo capacity must be a power of two");
+    static_assert(std::is_trivially_copyable<T>::value, "BVR::Fifo elements are copied with memcpy");
+
+public:
+    /**
+      * @brief Number of elements the fifo holds
+      * @retval std::size_t
+      */
+    static constexpr std::size_t capacity() { return N; }
+
+    /**
+      * @brief Number of elements waiting
+      * @note  safe to call from producer or consumer side
+      * @retval std::size_t
+      */
+    std::size_t level() const
+    {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+    /**
+      * @brief Number of free elements
+      * @retval std::size_t
+      */
+    std::size_t space() const { return N - level(); }
+
+    bool empty() const { return level() == 0; }
+    bool full() const { return level() == N; }
+
+    /**
+      * @brief Push one element
+      * @note  producer side
+      * @param const T &item
+      * @retval BVR_status_t
+      */
+    BVR_status_t push(const T &item)
+    {
+        return push(&item, 1);
+    }
+
+    /**
+      * @brief Push count elements, all or nothing
+      * @note  producer side, at most two memcpy either side of the wrap
+      * @param const T *data
+      * @param std::size_t count
+      * @retval BVR_status_t
+      */
+    BVR_status_t push(const T *data, std::size_t count)
+    {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        const std::size_t tail = tail_.load(std::memory_order_acquire);
+
+        if((N - (head - tail)) < count)
+        {
+            return BVR_ERROR;
+        }
+
+        copy_in(head & MASK, data, count);
+
+        // data must be written before the consumer sees the new head
+        head_.store(head + count, std::memory_order_release);
+        return BVR_OK;
+    }
+
+    /**
+      * @brief Push a whole array, all or nothing
+      * @param const T (&data)[COUNT]
+      * @retval BVR_status_t
+      */
+    template <std::size_t COUNT>
+    BVR_status_t push(const T (&data)[COUNT])
+    {
+        return push(data, COUNT);
+    }
+
+    /**
+      * @brief Pop one element
+      * @note  consumer side
+      * @param T &item
+      * @retval BVR_status_t
+      */
+    BVR_status_t pop(T &item)
+    {
+        return pop(&item, 1);
+    }
+
+    /**
+      * @brief Pop count elements, all or nothing
+      * @note  consumer side, at most two memcpy either side of the wrap
+      * @param T *data
+      * @param std::size_t count
+      * @retval BVR_status_t
+      */
+    BVR_status_t pop(T *data, std::size_t count)
+    {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        const std::size_t head = head_.load(std::memory_order_acquire);
+
+        if((head - tail) < count)
+        {
+            return BVR_ERROR;
+        }
+
+        copy_out(tail & MASK, data, count);
+
+        // data must be read before the producer can reuse the space
+        tail_.store(tail + count, std::memory_order_release);
+        return BVR_OK;
+    }
+
+    /**
+      * @brief Fill a whole array, all or nothing
+      * @param T (&data)[COUNT]
+      * @retval BVR_status_t
+      */
+    template <std::size_t COUNT>
+    BVR_status_t pop(T (&data)[COUNT])
+    {
+        return pop(data, COUNT);
+    }
+
+private:
+    static constexpr std::size_t MASK = N - 1;
+
+    void copy_in(std::size_t index, const T *data, std::size_t count)
+    {
+        const std::size_t first = (count < (N - index)) ? count : (N - index);
+
+        std::memcpy(&buffer_[index], data, first * sizeof(T));
+        if(count > first)
+        {
+            std::memcpy(&buffer_[0], data + first, (count - first) * sizeof(T));
+        }
+    }
+
+    void copy_out(std::size_t index, T *data, std::size_t count) const
+    {
+        const std::size_t first = (count < (N - index)) ? count : (N - index);
+
+        std::memcpy(data, &buffer_[index], first * sizeof(T));
+        if(count > first)
+        {
+            std::memcpy(data + first, &buffer_[0], (count - first) * sizeof(T));
+        }
+    }
+
+    T buffer_[N];                           /**< element storage */
+    std::atomic<std::size_t> head_{0};      /**< written by producer only */
+    std::atomic<std::size_t> tail_{0};      /**< written by consumer only */
+};
+
+} /* namespace BVR */
+
+#endif /* BVR_FIFO_HPP_ */
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
@@ -1,136 +1,1046 @@
-/**
-********************************************************************************
-* @author       Aidin Bervan 
-* @date 
-* @file         cti_fifo_buffer.h
-* @brief        CTI fifo buffer for the library 
-* @version      V0.1.0
-* @copyright    (C) COPYRIGHT
-* @target       ARM STM32
-* @IDE          NEOVIM
-* @repo
-*
-*
-********************************************************************************
-* @attention
-*           In main make sure to add the callback for the uart 
-*           void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
-*           {
-*               volatile temp_buffer_t temp_dma;
-*               if(huart == &DBG_HUART)
-*               {
-*                   temp_dma = BVR_fifo_pop_from_temp(&dbg_uart_tx_fifo);
-*                   HAL_UART_Transmit_DMA(&DBG_HUART, temp_dma.p_temp_buff, temp_dma.buff_size);
-*               }
-*           }
-*
-*           void HAL_UART_TxHalfCpltCallback(UART_HandleTypeDef *huart)
-*           {
-*               UNUSED(huart);
-*           }
-*
-*           You will also need to add the fifo_t dbg_uart_tx_fifo; to the private variables
-*           When you are using the uart debug logger 
-*
-********************************************************************************
-*/
-#ifndef BVR_FIFO_BUFFER_H_
-#define BVR_FIFO_BUFFER_H_
-/******************************************************************************/
-/*                                                                            */
-/******************************************************************************/
-#ifdef __cplusplus
-    extern "C" {
-#endif
-
-/*--INCLUDES------------------------------------------------------------------*/
-#include <stdio.h>
-#include <string.h>
-#include <stdint.h>
-#include "BVR_error.h"
-
-
-/*--DATA--TYPE----------------------------------------------------------------*/
-
-/**@struct fifo_control_t
- * @brief fifo control type definition
- * @details fifo control type definition
- */        
-typedef struct
-{
-    int depth;  /**< fifo depth */
-    int level;  /**< fifo level */
-    int head;   /**< fifo head */
-    int tail;   /**< fifo tail */
-}fifo_control_t;
-
-/**@struct fifo_t
- * @brief fifo type definition
- * @details fifo type definition
- */
-typedef struct
-{
-    fifo_control_t ctrl;    /**< fifo control */
-    uint8_t *p_buffer;      /**< fifo buffer pointer */
-}fifo_t;
-
-/**@struct temp_buffer_t
- * @brief temp buffer type definition
- * @details temp buffer type definition
- */
-typedef struct
-{
-    uint8_t *p_temp_buff;  /**< temp buffer pointer */
-    int     buff_size;     /**< temp buffer size */
-}temp_buffer_t;
-
-
-
-/*--FUNCTION--PROTOTYPE-------------------------------------------------------*/
-
-/**
-  * @brief Initialise fifo struct 
-  * @note
-  * @param fifo_t *fifo
-  * @param uint8_t buffer[] 
-  * @param int depth
-  * @retval fifo_status_t
-  */
-extern BVR_status_t BVR_fifo_init(fifo_t *fifo, uint8_t buffer[], int depth);
-
-/**
-  * @brief Push data to the fifo buffer 
-  * @note
-  * @param fifo_t *fifo
-  * @param uint8_t *data
-  * @param int buffer_size
-  * @retval fifo_status_t
-  */
-extern BVR_status_t BVR_fifo_push(fifo_t *fifo, uint8_t *data, int buffer_size);
-
-/**
-  * @brief Pop data from fifo buffer
-  * @note
-  * @param 
-  * @retval fifo_status_t
-  */
-extern BVR_status_t BVR_fifo_pop(fifo_t *fifo, uint8_t *data, int buffer_size);
-
-/**
-  * @brief Pop data from fifo to temp buffer 
-  * @note  used for dma transfers
-  * @param fifo_t *fifo
-  * @retval temp_buffer_t
-  */
-extern temp_buffer_t BVR_fifo_pop_from_temp(fifo_t *fifo);
-
-
-
-#ifdef __cplusplus
-}
-#endif   
-
-#endif /* */
-/******************************************************************************/
-/*                             END OF FILE                                    */
-/******************************************************************************/
+/**
+********************************************************************************
+* @author       Aidin Bervan 
+* @date 
+* @file         cti_fifo_buffer.h
+* @brief        CTI fifo buffer for the library 
+* @version      V0.1.0
+* @copyright    (C) COPYRIGHT
+* @target       ARM STM32
+* @IDE          NEOVIM
+* @repo
+*
+*
+********************************************************************************
+* @attention
+*           In main make sure to add the callback for the uart 
+*           void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+*           {
+*               if(huart == &DBG_HUART)
+*               {
+*                   // the logger releases the span and sends the next one
+*                   BVR_uart_debug_tx_cplt();
+*               }
+*           }
+*
+*           void HAL_UART_TxHalfCpltCallback(UART_HandleTypeDef *huart)
+*           {
+*               UNUSED(huart);
+*           }
+*
+*           You will also need to add the fifo_t dbg_uart_tx_fifo; to the private variables
+*           When you are using the uart debug logger 
+*
+*           The fifo is single producer single consumer (SPSC) safe.
+*           Only the producer writes the head and only the consumer writes
+*           the tail, the level is worked out from the two so one task can
+*           push while an ISR pops without masking interrupts.
+*           More than one consumer still needs a lock. For more than one
+*           producer (tasks and ISRs) init with BVR_fifo_init_mp and only push
+*           with BVR_fifo_push_mp (the other push calls return BVR_ERROR
+*           on it), space is reserved with a compare and swap
+*           and each write is published, in order, as soon as every write
+*           reserved before it is done. A writer that is interrupted only holds
+*           back the writes reserved after it, at most FIFO_MP_SLOTS writes can
+*           be in flight and a push past that is dropped like a full fifo.
+*
+*           When a push does not fit the fifo policy decides what happens,
+*           FIFO_REJECT drops the message, FIFO_OVERWRITE drops the oldest
+*           bytes, FIFO_TRUNCATE keeps what fits and FIFO_BLOCK waits up to
+*           the timeout when FreeRTOS is running (set BVR_FIFO_RTOS).
+*           Lost data is counted, read it with BVR_fifo_get_drops.
+*
+*           Watermarks call back once when the level rises to the high mark
+*           and once when it then falls to the low mark, so a consumer can
+*           sleep until there is a burst worth draining instead of polling
+*           BVR_fifo_notify_task(&adc_fifo, 512, 0, adc_task_handle);
+*           // adc task
+*           ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+*           while(BVR_fifo_pop(&adc_fifo, block, 512) == BVR_OK) { ... }
+*
+*           With FreeRTOS BVR_fifo_push_wait and BVR_fifo_pop_wait sleep the
+*           calling task until there is room or data, or the timeout runs out.
+*           Every push and pop wakes the task waiting on the other side, from
+*           an ISR too, so no osDelay retry loops are needed
+*           if(BVR_fifo_pop_wait(&rx_fifo, frame, FRAME_SIZE, 100) == BVR_TIMEOUT) { ... }
+*           FIFO_BLOCK waits the same way. One task can wait on each side.
+*           FIFO_OVERWRITE moves the tail from the producer side so it can
+*           not be used on a multi producer fifo, and claim/release, the
+*           record pops and BVR_fifo_pop_dma refuse a fifo set to it.
+*
+*           Set BVR_FIFO_STATS to 1 to count high water mark, bytes in and
+*           out, push failures, longest time full and pop calls per second
+*           for each fifo. Name a fifo with BVR_fifo_register and print all
+*           of them with BVR_fifo_dump_stats. With it set to 0 the stats and
+*           both calls compile out.
+*
+*           BVR_fifo_push_dma and BVR_fifo_pop_dma hand copies of at least
+*           the threshold to a memory to memory dma stream and finish in the
+*           dma complete callback, smaller copies stay on the CPU
+*           void dma_m2m_cplt(DMA_HandleTypeDef *hdma)
+*           {
+*               BVR_fifo_dma_complete(&sensor_dma);
+*           }
+*           BVR_fifo_dma_init(&sensor_dma, BVR_fifo_dma_hal_start, &hdma_memtomem_dma2_stream0,
+*                             256, sensor_block_done);
+*           hdma_memtomem_dma2_stream0.XferCpltCallback = dma_m2m_cplt;
+*
+*           prio_fifo_t drains several fifo_t lanes through one DMA, lane 0
+*           first. Each lane sends its weight in spans per round so urgent
+*           data jumps the queue without starving the rest, and each lane
+*           has its own space so urgent data is not dropped behind bulk data.
+*           Claim and release through the prio_fifo_t, one span at a time.
+*
+*           ptr_queue_t passes whole buffers between contexts as pointers,
+*           e.g. a DMA ISR pushes a filled block from BVR_buffer_pool.h and a
+*           task pops it, nothing is copied. BVR_ptrq_init is single producer
+*           single consumer, BVR_ptrq_init_mpmc takes a sequence per slot and
+*           is safe for any mix of tasks and ISRs. The batch calls move a run
+*           of pointers with one position update.
+*
+*           BVR_fifo_claim hands out data without freeing it, the space is
+*           only given back to the producer by BVR_fifo_release once the DMA
+*           has finished with it. Claims are released in the order they were
+*           made and a new claim can be taken while one is in flight.
+*           BVR_fifo_pop_from_temp frees the space straight away, do not mix
+*           the two on one fifo.
+*
+*           bip_fifo_t is a two region (bip) buffer, every committed block is
+*           contiguous so a DMA transfer never has to split at the wrap point.
+*           Read the span, transmit it and release it when the DMA is done
+*           void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+*           {
+*               temp_buffer_t span;
+*               if(huart == &DBG_HUART)
+*               {
+*                   BVR_bip_release(&dbg_uart_tx_bip, huart->TxXferSize);
+*                   span = BVR_bip_read(&dbg_uart_tx_bip);
+*                   if(span.buff_size > 0)
+*                   {
+*                       HAL_UART_Transmit_DMA(&DBG_HUART, span.p_temp_buff, span.buff_size);
+*                   }
+*               }
+*           }
+*
+********************************************************************************
+*/
+#ifndef BVR_FIFO_BUFFER_H_
+#define BVR_FIFO_BUFFER_H_
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "BVR_error.h"
+#include "BVR_common_defs.h"
+
+
+/*--DEFINES-------------------------------------------------------------------*/
+#define RECORD_HEADER_SIZE  2       /**< record length prefix in bytes */
+#define RECORD_MAX_SIZE     0xFFFF  /**< largest record the prefix can hold */
+#define FIFO_MP_MAX_DEPTH   0x7FFF  /**< largest multi producer fifo depth */
+#define FIFO_PRIO_MAX_LANES 4       /**< most lanes in a prio_fifo_t */
+#define FIFO_NOTIFY_HIGH    0x01    /**< task notify bit for the high mark */
+#define FIFO_NOTIFY_LOW     0x02    /**< task notify bit for the low mark */
+#define FIFO_NOTIFY_DATA    0x04    /**< task notify bit for push_wait / pop_wait */
+#define FIFO_NOTIFY_SPACE   0x08    /**< task notify bit for push_wait / pop_wait */
+
+/*--PLATFORM-CONF-------------------------------------------------------------*/
+// Set FreeRTOS = 1 bare metal = 0
+#ifndef BVR_FIFO_RTOS
+#define BVR_FIFO_RTOS 0
+#endif
+// Set fifo statistics on = 1 off = 0
+#ifndef BVR_FIFO_STATS
+#define BVR_FIFO_STATS 0
+#endif
+// Millisecond tick for the statistics, change for MCU
+#ifndef BVR_FIFO_TICK
+#define BVR_FIFO_TICK() HAL_GetTick()
+#endif
+// Set HAL memory to memory dma copies on = 1 off = 0
+#ifndef BVR_FIFO_DMA
+#define BVR_FIFO_DMA 0
+#endif
+// Multi producer pushes in flight at once, power of two, one per task and ISR that pushes
+#ifndef FIFO_MP_SLOTS
+#define FIFO_MP_SLOTS 8
+#endif
+/*--PLATFORM-CONF-------------------------------------------------------------*/
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+/**@enum fifo_policy_t
+ * @brief what a push does when the fifo is full
+ * @details fifo overflow policy
+ */
+typedef enum
+{
+    FIFO_REJECT     = 0x00, /**< drop the new message */
+    FIFO_OVERWRITE  = 0x01, /**< drop the oldest bytes to make room */
+    FIFO_TRUNCATE   = 0x02, /**< push what fits and drop the rest */
+    FIFO_BLOCK      = 0x03, /**< wait for room up to the timeout, rtos only */
+}fifo_policy_t;
+
+/**@enum fifo_mark_t
+ * @brief which watermark was crossed
+ * @details watermark callback reason
+ */
+typedef enum
+{
+    FIFO_MARK_HIGH  = 0x00, /**< level rose to the high mark */
+    FIFO_MARK_LOW   = 0x01, /**< level fell to the low mark */
+}fifo_mark_t;
+
+struct fifo_s;
+
+/** watermark callback, runs in the context of the push or pop that crossed */
+typedef void (*fifo_mark_cb_t)(struct fifo_s *fifo, fifo_mark_t mark, void *ctx);
+
+#if BVR_FIFO_STATS
+/**@struct fifo_stats_t
+ * @brief fifo statistics type definition
+ * @details only built when BVR_FIFO_STATS is set
+ */
+typedef struct
+{
+    const char *name;       /**< name used by BVR_fifo_dump_stats */
+    struct fifo_s *next;    /**< next registered fifo */
+    int high_water;         /**< highest level seen */
+    uint32_t bytes_in;      /**< total bytes pushed */
+    uint32_t bytes_out;     /**< total bytes freed by the consumer */
+    uint32_t push_fails;    /**< pushes rejected or truncated */
+    uint32_t pop_calls;     /**< consumer calls */
+    uint32_t start_tick;    /**< tick at init */
+    uint32_t full_tick;     /**< tick the fifo last became full */
+    uint32_t longest_full;  /**< longest time full in ms */
+    uint8_t  full;          /**< fifo is full */
+}fifo_stats_t;
+#endif
+
+/**@struct fifo_control_t
+ * @brief fifo control type definition
+ * @details fifo control type definition
+ */        
+typedef struct
+{
+    int depth;  /**< fifo depth */
+    int head;   /**< fifo head 0 to 2*depth, written by producer only */
+    int tail;   /**< fifo tail 0 to 2*depth, written by consumer only */
+    int claim;  /**< end of claimed data 0 to 2*depth, consumer only */
+    int mask;   /**< depth - 1 when depth is a power of two else 0 */
+    int mp;     /**< multi producer fifo when set */
+    uint32_t cursor;    /**< multi producer next ticket (high 16) and reserved position (low 16) */
+    uint32_t published; /**< multi producer next ticket to publish (high 16) and head (low 16) */
+    uint32_t commit[FIFO_MP_SLOTS]; /**< multi producer ticket (high 16) and end (low 16) of each write done */
+    fifo_policy_t policy;   /**< overflow policy */
+    uint32_t timeout_ms;    /**< FIFO_BLOCK timeout */
+    uint32_t dropped_bytes; /**< total bytes lost to overflow */
+    uint32_t dropped_msgs;  /**< total messages lost to overflow */
+    int high_mark;          /**< high watermark level, 0 is off */
+    int low_mark;           /**< low watermark level */
+    uint8_t above;          /**< high mark fired and low mark not yet */
+    fifo_mark_cb_t on_mark; /**< watermark callback */
+    void *mark_ctx;         /**< passed to on_mark */
+#if BVR_FIFO_RTOS
+    void *push_waiter;      /**< task blocked waiting for space */
+    void *pop_waiter;       /**< task blocked waiting for data */
+#endif
+#if BVR_FIFO_STATS
+    fifo_stats_t stats;     /**< runtime statistics */
+#endif
+}fifo_control_t;
+
+/**@struct fifo_t
+ * @brief fifo type definition
+ * @details fifo type definition
+ */
+typedef struct fifo_s
+{
+    fifo_control_t ctrl;    /**< fifo control */
+    uint8_t *p_buffer;      /**< fifo buffer pointer */
+}fifo_t;
+
+/**@struct temp_buffer_t
+ * @brief temp buffer type definition
+ * @details temp buffer type definition
+ */
+typedef struct
+{
+    uint8_t *p_temp_buff;  /**< temp buffer pointer */
+    int     buff_size;     /**< temp buffer size */
+}temp_buffer_t;
+
+/**@struct bvr_iov
+ * @brief one piece of a scatter gather push
+ * @details pointer and length like a posix iovec
+ */
+typedef struct bvr_iov
+{
+    const void *base;   /**< start of the piece */
+    int         len;    /**< length in bytes */
+}bvr_iov_t;
+
+/**@struct bip_control_t
+ * @brief bip buffer control type definition
+ * @details write and last are written by the producer only,
+ *          read is written by the consumer only
+ */
+typedef struct
+{
+    int depth;      /**< buffer depth */
+    int write;      /**< end of committed data */
+    int read;       /**< start of unread data */
+    int last;       /**< end of data before the producer wrapped */
+    int reserve;    /**< start of the current reservation */
+}bip_control_t;
+
+/**@struct bip_fifo_t
+ * @brief bip buffer type definition
+ * @details bip buffer type definition
+ */
+typedef struct
+{
+    bip_control_t ctrl;     /**< bip control */
+    uint8_t *p_buffer;      /**< bip buffer pointer */
+}bip_fifo_t;
+
+
+/**@struct record_fifo_t
+ * @brief length prefixed record fifo type definition
+ * @details each record is a 2 byte little endian length then the data,
+ *          records are pushed and popped whole
+ */
+typedef struct
+{
+    fifo_t fifo;    /**< byte fifo holding the records */
+}record_fifo_t;
+
+
+/**@struct elem_queue_t
+ * @brief fixed size element queue type definition
+ * @details slots.ctrl counts elements not bytes, same SPSC rules as fifo_t.
+ *          Pushes and pops run the same stats, marks and wakeups as the
+ *          byte fifo, the stats count bytes and the levels count elements
+ */
+typedef struct
+{
+    fifo_t slots;   /**< slot positions and storage */
+    int elem_size;  /**< bytes per element */
+}elem_queue_t;
+
+
+/** start an asynchronous copy of size bytes, return BVR_OK once started */
+typedef BVR_status_t (*fifo_dma_start_t)(void *dst, const void *src, int size, void *engine);
+
+/** called when a dma push or pop has finished */
+typedef void (*fifo_dma_done_t)(fifo_t *fifo, int size);
+
+/**@struct fifo_dma_t
+ * @brief memory to memory dma copy backend type definition
+ * @details one copy in flight at a time, a wrapped copy is two transfers
+ */
+typedef struct
+{
+    fifo_dma_start_t start;     /**< copy engine start function */
+    void *engine;               /**< passed to start, e.g. DMA_HandleTypeDef */
+    int threshold;              /**< smaller copies use the CPU */
+    fifo_dma_done_t done;       /**< completion callback, can be NULL */
+    fifo_t *fifo;               /**< fifo of the copy in flight */
+    volatile uint8_t busy;      /**< copy in flight */
+    uint8_t is_push;            /**< copy in flight is a push */
+    int size;                   /**< bytes in the copy in flight */
+    int next_pos;               /**< head or tail to publish when done */
+    uint8_t *next_dst;          /**< second transfer after the wrap */
+    const uint8_t *next_src;    /**< second transfer after the wrap */
+    int next_len;               /**< second transfer after the wrap */
+}fifo_dma_t;
+
+
+/**@struct prio_fifo_t
+ * @brief priority fifo made of fifo_t lanes type definition
+ * @details lane 0 drains first, each lane sends weight spans per round
+ *          so lower lanes are slowed down but never starved
+ */
+typedef struct
+{
+    fifo_t *lanes[FIFO_PRIO_MAX_LANES];     /**< lanes, highest priority first */
+    uint8_t weight[FIFO_PRIO_MAX_LANES];    /**< spans per round, at least 1 */
+    uint8_t credit[FIFO_PRIO_MAX_LANES];    /**< spans left this round */
+    int count;                              /**< lanes in use */
+    int active;                             /**< lane of the claim in flight, -1 none */
+    int wrapped;                            /**< lane whose last span ended at the wrap, -1 none */
+}prio_fifo_t;
+
+
+/**@struct ptr_queue_t
+ * @brief lock free pointer queue type definition
+ * @details head and tail are free running, the slot is the position masked
+ *          with depth - 1. The mpmc queue keeps a sequence per slot, a slot
+ *          is free for position pos when seq == pos and full when
+ *          seq == pos + 1 (bounded mpmc queue by D. Vyukov)
+ */
+typedef struct
+{
+    void **p_slots;     /**< depth pointers */
+    uint32_t *p_seq;    /**< depth sequences, NULL for spsc */
+    uint32_t mask;      /**< depth - 1, depth is a power of two */
+    uint32_t head;      /**< next position to push */
+    uint32_t tail;      /**< next position to pop */
+}ptr_queue_t;
+
+
+
+/*--FUNCTION--PROTOTYPE-------------------------------------------------------*/
+
+/**
+  * @brief Initialise fifo struct 
+  * @note  a power of two depth uses masking instead of compares to wrap
+  * @param fifo_t *fifo
+  * @param uint8_t buffer[] 
+  * @param int depth
+  * @retval fifo_status_t
+  */
+extern BVR_status_t BVR_fifo_init(fifo_t *fifo, uint8_t buffer[], int depth);
+
+/**
+  * @brief Initialise fifo struct for more than one producer
+  * @note  depth up to FIFO_MP_MAX_DEPTH, push with BVR_fifo_push_mp only
+  * @param fifo_t *fifo
+  * @param uint8_t buffer[] 
+  * @param int depth
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_fifo_init_mp(fifo_t *fifo, uint8_t buffer[], int depth);
+
+/**
+  * @brief Push data to the fifo buffer 
+  * @note  BVR_ERROR on a multi producer fifo, use BVR_fifo_push_mp
+  * @param fifo_t *fifo
+  * @param uint8_t *data
+  * @param int buffer_size
+  * @retval fifo_status_t
+  */
+extern BVR_status_t BVR_fifo_push(fifo_t *fifo, uint8_t *data, int buffer_size);
+
+/**
+  * @brief Push data to a multi producer fifo
+  * @note  lock free, safe from any task or ISR. All or nothing
+  * @param fifo_t *fifo
+  * @param uint8_t *data
+  * @param int buffer_size
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_fifo_push_mp(fifo_t *fifo, uint8_t *data, int buffer_size);
+
+/**
+  * @brief Push several pieces as one write
+  * @note  all or nothing, the consumer sees every piece or none.
+  *        BVR_ERROR on a multi producer fifo
+  * @param fifo_t *fifo
+  * @param const struct bvr_iov *iov
+  * @param int count number of pieces
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_fifo_pushv(fifo_t *fifo, const struct bvr_iov *iov, int count);
+
+/**
+  * @brief Pop data from fifo buffer
+  * @note
+  * @param 
+  * @retval fifo_status_t
+  */
+extern BVR_status_t BVR_fifo_pop(fifo_t *fifo, uint8_t *data, int buffer_size);
+
+#if BVR_FIFO_RTOS
+/**
+  * @brief Push, sleeping until there is room for all of it
+  * @note  task only, from an ISR or before the scheduler runs it is a plain
+  *        push. Not for multi producer fifos. BVR_TIMEOUT counts as a drop,
+  *        BVR_BUSY when another task is already waiting to push
+  * @param fifo_t *fifo
+  * @param uint8_t *data
+  * @param int buffer_size
+  * @param uint32_t timeout_ms
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_fifo_push_wait(fifo_t *fifo, uint8_t *data, int buffer_size, uint32_t timeout_ms);
+
+/**
+  * @brief Pop, sleeping until buffer_size bytes are waiting
+  * @note  task only, from an ISR or before the scheduler runs it is a plain
+  *        pop. BVR_BUSY when another task is already waiting to pop
+  * @param fifo_t *fifo
+  * @param uint8_t *data
+  * @param int buffer_size
+  * @param uint32_t timeout_ms
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_fifo_pop_wait(fifo_t *fifo, uint8_t *data, int buffer_size, uint32_t timeout_ms);
+#endif
+
+/**
+  * @brief Pop data from fifo to temp buffer 
+  * @note  used for dma transfers, the space is freed before the dma has
+  *        read it so use BVR_fifo_claim when the producer can be fast
+  * @param fifo_t *fifo
+  * @retval temp_buffer_t
+  */
+extern temp_buffer_t BVR_fifo_pop_from_temp(fifo_t *fifo);
+
+/**
+  * @brief Copy data from the fifo without removing it
+  * @note  consumer side
+  * @param fifo_t *fifo
+  * @param int offset from the oldest byte
+  * @param uint8_t *data
+  * @param int len
+  * @retval BVR_status_t error when offset + len is more than the level
+  */
+extern BVR_status_t BVR_fifo_peek(fifo_t *fifo, int offset, uint8_t *data, int len);
+
+/**
+  * @brief Remove bytes without copying them
+  * @note  consumer side
+  * @param fifo_t *fifo
+  * @param int count
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_fifo_skip(fifo_t *fifo, int count);
+
+/**
+  * @brief Find the first byte equal to value
+  * @note  consumer side, searches both sides of the wrap with memchr
+  * @param fifo_t *fifo
+  * @param int offset to start searching from
+  * @param uint8_t value
+  * @retval int offset from the oldest byte, -1 when not found
+  */
+extern int BVR_fifo_find(fifo_t *fifo, int offset, uint8_t value);
+
+/**
+  * @brief Claim the next contiguous span of data for a dma transfer
+  * @note  consumer side, the data stays in the fifo until released.
+  *        Continues after any claim still in flight, p_temp_buff is NULL
+  *        when there is no unclaimed data or the fifo is FIFO_OVERWRITE
+  * @param fifo_t *fifo
+  * @retval temp_buffer_t
+  */
+extern temp_buffer_t BVR_fifo_claim(fifo_t *fifo);
+
+/**
+  * @brief Free the oldest claimed span once the dma is done with it
+  * @note  consumer side, call from the dma complete callback. BVR_ERROR on a
+  *        FIFO_OVERWRITE fifo
+  * @param fifo_t *fifo
+  * @param int size of the claimed span
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_fifo_release(fifo_t *fifo, int size);
+
+/**
+  * @brief Hand back every claimed span that has not been released
+  * @note  consumer side, for when the dma could not be started. The next
+  *        claim returns the same data again
+  * @param fifo_t *fifo
+  * @retval void
+  */
+extern void BVR_fifo_unclaim(fifo_t *fifo);
+
+/**
+  * @brief Get a contiguous writable span at the head of the fifo
+  * @note  producer side, the span is not visible to the consumer until
+  *        BVR_fifo_commit is called. buff_size is the contiguous free space
+  *        up to max_len and can be less when the free space wraps.
+  *        p_temp_buff is NULL when the fifo is full or multi producer
+  * @param fifo_t *fifo
+  * @param int max_len
+  * @retval temp_buffer_t
+  */
+extern temp_buffer_t BVR_fifo_reserve(fifo_t *fifo, int max_len);
+
+/**
+  * @brief Publish bytes written into a span from BVR_fifo_reserve
+  * @note  producer side, BVR_ERROR on a multi producer fifo
+  * @param fifo_t *fifo
+  * @param int used_len must not be more than the reserved buff_size
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_fifo_commit(fifo_t *fifo, int used_len);
+
+/**
+  * @brief Set what a push does when the fifo is full
+  * @note  default is FIFO_REJECT
+  * @param fifo_t *fifo
+  * @param fifo_policy_t policy
+  * @param uint32_t timeout_ms only used by FIFO_BLOCK
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_fifo_set_policy(fifo_t *fifo, fifo_policy_t policy, uint32_t timeout_ms);
+
+/**
+  * @brief Set the high and low watermarks
+  * @note  callback runs once when a push takes the level to high or above,
+  *        then once when a pop takes it to low or below. It can run in an
+  *        ISR if that side pushes or pops from one. high 0 turns marks off
+  * @param fifo_t *fifo
+  * @param int high 1 to depth
+  * @param int low 0 to high - 1
+  * @param fifo_mark_cb_t callback
+  * @param void *ctx
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_fifo_set_marks(fifo_t *fifo, int high, int low,
+                                       fifo_mark_cb_t callback, void *ctx);
+
+#if BVR_FIFO_RTOS
+/**
+  * @brief Watermarks as direct to task notifications
+  * @note  sets FIFO_NOTIFY_HIGH or FIFO_NOTIFY_LOW in the notification value
+  *        and wakes the task, take it with ulTaskNotifyTake or xTaskNotifyWait
+  * @param fifo_t *fifo
+  * @param int high
+  * @param int low
+  * @param void *task TaskHandle_t to notify
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_fifo_notify_task(fifo_t *fifo, int high, int low, void *task);
+#endif
+
+/**
+  * @brief Get the total data lost to overflow since init
+  * @note  truncated pushes only count bytes, an overwrite counts as one message
+  * @param fifo_t *fifo
+  * @param uint32_t *msgs can be NULL
+  * @param uint32_t *bytes can be NULL
+  * @retval void
+  */
+extern void BVR_fifo_get_drops(fifo_t *fifo, uint32_t *msgs, uint32_t *bytes);
+
+#if BVR_FIFO_STATS
+/**
+  * @brief Add a fifo to the statistics list
+  * @note  call once after init
+  * @param fifo_t *fifo
+  * @param const char *name
+  * @retval void
+  */
+extern void BVR_fifo_register(fifo_t *fifo, const char *name);
+
+/**
+  * @brief Print the statistics of every registered fifo with BVR_LOG
+  * @note
+  * @param void
+  * @retval void
+  */
+extern void BVR_fifo_dump_stats(void);
+#else
+#define BVR_fifo_register(fifo, name)
+#define BVR_fifo_dump_stats()
+#endif
+
+/**
+  * @brief Number of bytes waiting in the fifo
+  * @note  safe to call from producer or consumer side
+  * @param fifo_t *fifo
+  * @retval int
+  */
+extern int BVR_fifo_level(fifo_t *fifo);
+
+/**
+  * @brief Number of free bytes in the fifo
+  * @note  safe to call from producer or consumer side
+  * @param fifo_t *fifo
+  * @retval int
+  */
+extern int BVR_fifo_space(fifo_t *fifo);
+
+/**
+  * @brief Initialise bip buffer struct
+  * @note
+  * @param bip_fifo_t *bip
+  * @param uint8_t buffer[]
+  * @param int depth
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_bip_init(bip_fifo_t *bip, uint8_t buffer[], int depth);
+
+/**
+  * @brief Reserve a contiguous block of exactly size bytes
+  * @note  producer side, wraps to the start of the buffer when the end
+  *        is too short. p_temp_buff is NULL when there is no room
+  * @param bip_fifo_t *bip
+  * @param int size
+  * @retval temp_buffer_t
+  */
+extern temp_buffer_t BVR_bip_reserve(bip_fifo_t *bip, int size);
+
+/**
+  * @brief Publish bytes written into the last reservation
+  * @note  producer side
+  * @param bip_fifo_t *bip
+  * @param int used_len must not be more than the reserved size
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_bip_commit(bip_fifo_t *bip, int used_len);
+
+/**
+  * @brief Push data as one contiguous block
+  * @note  all or nothing
+  * @param bip_fifo_t *bip
+  * @param uint8_t *data
+  * @param int buffer_size
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_bip_push(bip_fifo_t *bip, uint8_t *data, int buffer_size);
+
+/**
+  * @brief Get the largest contiguous span of committed data
+  * @note  consumer side, the data stays in the buffer until released
+  *        p_temp_buff is NULL when empty
+  * @param bip_fifo_t *bip
+  * @retval temp_buffer_t
+  */
+extern temp_buffer_t BVR_bip_read(bip_fifo_t *bip);
+
+/**
+  * @brief Free bytes from the span returned by BVR_bip_read
+  * @note  consumer side, call from the DMA complete callback
+  * @param bip_fifo_t *bip
+  * @param int size
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_bip_release(bip_fifo_t *bip, int size);
+
+
+/**
+  * @brief Initialise record fifo struct
+  * @note
+  * @param record_fifo_t *rec
+  * @param uint8_t buffer[]
+  * @param int depth
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_record_init(record_fifo_t *rec, uint8_t buffer[], int depth);
+
+/**
+  * @brief Push one whole record
+  * @note  all or nothing, nothing is written if the record does not fit
+  * @param record_fifo_t *rec
+  * @param uint8_t *data
+  * @param int size up to RECORD_MAX_SIZE
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_record_push(record_fifo_t *rec, uint8_t *data, int size);
+
+/**
+  * @brief Pop one whole record
+  * @note  the record is left in the fifo when buffer_size is too small.
+  *        BVR_ERROR on a FIFO_OVERWRITE fifo, it can cut records anywhere
+  * @param record_fifo_t *rec
+  * @param uint8_t *data
+  * @param int buffer_size
+  * @param int *size set to the record size
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_record_pop(record_fifo_t *rec, uint8_t *data, int buffer_size, int *size);
+
+/**
+  * @brief Pop as many whole records as fit in one dma buffer
+  * @note  records keep their length prefix so the receiver can split them,
+  *        0 on a FIFO_OVERWRITE fifo
+  * @param record_fifo_t *rec
+  * @param uint8_t *data dma buffer
+  * @param int buffer_size
+  * @retval int number of bytes copied, 0 when empty
+  */
+extern int BVR_record_pop_batch(record_fifo_t *rec, uint8_t *data, int buffer_size);
+
+
+
+/**
+  * @brief Initialise element queue struct
+  * @note  buffer must hold depth * elem_size bytes
+  * @param elem_queue_t *queue
+  * @param void *buffer
+  * @param int elem_size
+  * @param int depth number of elements
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_queue_init(elem_queue_t *queue, void *buffer, int elem_size, int depth);
+
+/**
+  * @brief Push count elements, all or nothing
+  * @note  producer side
+  * @param elem_queue_t *queue
+  * @param const void *elems
+  * @param int count
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_queue_push(elem_queue_t *queue, const void *elems, int count);
+
+/**
+  * @brief Pop count elements, all or nothing
+  * @note  consumer side
+  * @param elem_queue_t *queue
+  * @param void *elems
+  * @param int count
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_queue_pop(elem_queue_t *queue, void *elems, int count);
+
+/**
+  * @brief Pointer to the next free slot to fill in place
+  * @note  producer side, publish with BVR_queue_commit. NULL when full
+  * @param elem_queue_t *queue
+  * @retval void *
+  */
+extern void *BVR_queue_reserve(elem_queue_t *queue);
+
+/**
+  * @brief Publish the slot from BVR_queue_reserve
+  * @note  producer side
+  * @param elem_queue_t *queue
+  * @retval void
+  */
+extern void BVR_queue_commit(elem_queue_t *queue);
+
+/**
+  * @brief Pointer to the oldest element to read in place
+  * @note  consumer side, free with BVR_queue_release. NULL when empty
+  * @param elem_queue_t *queue
+  * @retval void *
+  */
+extern void *BVR_queue_front(elem_queue_t *queue);
+
+/**
+  * @brief Free the slot from BVR_queue_front
+  * @note  consumer side
+  * @param elem_queue_t *queue
+  * @retval void
+  */
+extern void BVR_queue_release(elem_queue_t *queue);
+
+/**
+  * @brief Number of elements waiting
+  * @note  safe to call from producer or consumer side
+  * @param elem_queue_t *queue
+  * @retval int
+  */
+extern int BVR_queue_level(elem_queue_t *queue);
+
+
+
+/**
+  * @brief Initialise a dma copy backend
+  * @note  use BVR_fifo_dma_hal_start with a DMA2 memory to memory stream
+  *        set to byte width, or any other engine with the same signature
+  * @param fifo_dma_t *dma
+  * @param fifo_dma_start_t start
+  * @param void *engine
+  * @param int threshold copies of at least this many bytes use the dma
+  * @param fifo_dma_done_t done
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_fifo_dma_init(fifo_dma_t *dma, fifo_dma_start_t start, void *engine,
+                                      int threshold, fifo_dma_done_t done);
+
+/**
+  * @brief Push using the dma for large copies
+  * @note  data must stay valid until done is called, done is called straight
+  *        away for CPU copies. Do not push any other way while a dma push is
+  *        in flight. BVR_BUSY when the dma is already in use, BVR_ERROR on
+  *        a multi producer fifo
+  * @param fifo_dma_t *dma
+  * @param fifo_t *fifo
+  * @param const uint8_t *data
+  * @param int size
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_fifo_push_dma(fifo_dma_t *dma, fifo_t *fifo, const uint8_t *data, int size);
+
+/**
+  * @brief Pop using the dma for large copies
+  * @note  data is only valid once done is called. Do not pop any other way
+  *        while a dma pop is in flight. BVR_BUSY when the dma is already in use,
+  *        BVR_ERROR on a FIFO_OVERWRITE fifo
+  * @param fifo_dma_t *dma
+  * @param fifo_t *fifo
+  * @param uint8_t *data
+  * @param int size
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_fifo_pop_dma(fifo_dma_t *dma, fifo_t *fifo, uint8_t *data, int size);
+
+/**
+  * @brief Finish the copy in flight
+  * @note  call from the dma transfer complete callback
+  * @param fifo_dma_t *dma
+  * @retval void
+  */
+extern void BVR_fifo_dma_complete(fifo_dma_t *dma);
+
+#if BVR_FIFO_DMA
+/**
+  * @brief HAL memory to memory dma engine for fifo_dma_t
+  * @note  engine is the DMA_HandleTypeDef, its XferCpltCallback must call
+  *        BVR_fifo_dma_complete
+  * @param void *dst
+  * @param const void *src
+  * @param int size
+  * @param void *engine
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_fifo_dma_hal_start(void *dst, const void *src, int size, void *engine);
+#endif
+
+
+
+/**
+  * @brief Initialise a priority fifo over fifo_t lanes
+  * @note  the lanes must already be initialised, lane 0 is the highest
+  * @param prio_fifo_t *prio
+  * @param fifo_t *lanes[] count lanes
+  * @param const uint8_t weights[] spans each lane sends per round
+  * @param int count 1 to FIFO_PRIO_MAX_LANES
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_prio_init(prio_fifo_t *prio, fifo_t *lanes[], const uint8_t weights[], int count);
+
+/**
+  * @brief Push to one lane
+  * @note  each lane has its own space so a full low lane never drops a
+  *        high priority message. Multi producer lanes are pushed with
+  *        BVR_fifo_push_mp
+  * @param prio_fifo_t *prio
+  * @param int lane
+  * @param uint8_t *data
+  * @param int size
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_prio_push(prio_fifo_t *prio, int lane, uint8_t *data, int size);
+
+/**
+  * @brief Claim the next span by weighted round robin
+  * @note  one claim at a time, release it before claiming again, a lane
+  *        whose span stopped at the end of its buffer goes again so data
+  *        pushed across the wrap is sent back to back
+  * @param prio_fifo_t *prio
+  * @retval temp_buffer_t
+  */
+extern temp_buffer_t BVR_prio_claim(prio_fifo_t *prio);
+
+/**
+  * @brief Release the span from the last claim
+  * @param prio_fifo_t *prio
+  * @param int size
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_prio_release(prio_fifo_t *prio, int size);
+
+/**
+  * @brief Hand back the span from the last claim without sending it
+  * @note  the next claim returns it again before any other lane
+  * @param prio_fifo_t *prio
+  * @retval void
+  */
+extern void BVR_prio_unclaim(prio_fifo_t *prio);
+
+/**
+  * @brief Bytes waiting across all lanes
+  * @param prio_fifo_t *prio
+  * @retval int
+  */
+extern int BVR_prio_level(prio_fifo_t *prio);
+
+/**
+  * @brief Total data lost to overflow across all lanes
+  * @param prio_fifo_t *prio
+  * @param uint32_t *msgs can be NULL
+  * @param uint32_t *bytes can be NULL
+  * @retval void
+  */
+extern void BVR_prio_get_drops(prio_fifo_t *prio, uint32_t *msgs, uint32_t *bytes);
+
+
+
+/**
+  * @brief Initialise a single producer single consumer pointer queue
+  * @param ptr_queue_t *queue
+  * @param void *slots[] depth pointers
+  * @param int depth power of two
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_ptrq_init(ptr_queue_t *queue, void *slots[], int depth);
+
+/**
+  * @brief Initialise a multi producer multi consumer pointer queue
+  * @note  any mix of tasks and ISRs can push and pop
+  * @param ptr_queue_t *queue
+  * @param void *slots[] depth pointers
+  * @param uint32_t seq[] depth sequences
+  * @param int depth power of two
+  * @retval BVR_status_t
+  */
+extern BVR_status_t BVR_ptrq_init_mpmc(ptr_queue_t *queue, void *slots[], uint32_t seq[], int depth);
+
+/**
+  * @brief Push one pointer
+  * @param ptr_queue_t *queue
+  * @param void *item
+  * @retval BVR_status_t BVR_ERROR when full
+  */
+extern BVR_status_t BVR_ptrq_push(ptr_queue_t *queue, void *item);
+
+/**
+  * @brief Pop one pointer
+  * @param ptr_queue_t *queue
+  * @param void **item
+  * @retval BVR_status_t BVR_ERROR when empty
+  */
+extern BVR_status_t BVR_ptrq_pop(ptr_queue_t *queue, void **item);
+
+/**
+  * @brief Push up to count pointers with one position update
+  * @note  pushes what fits in order
+  * @param ptr_queue_t *queue
+  * @param void *const items[]
+  * @param int count
+  * @retval int number pushed
+  */
+extern int BVR_ptrq_push_batch(ptr_queue_t *queue, void *const items[], int count);
+
+/**
+  * @brief Pop up to max pointers with one position update
+  * @param ptr_queue_t *queue
+  * @param void *items[]
+  * @param int max
+  * @retval int number popped
+  */
+extern int BVR_ptrq_pop_batch(ptr_queue_t *queue, void *items[], int max);
+
+/**
+  * @brief Pointers waiting
+  * @note  a snapshot on an mpmc queue
+  * @param ptr_queue_t *queue
+  * @retval int
+  */
+extern int BVR_ptrq_level(ptr_queue_t *queue);
+
+
+
+
+#ifdef __cplusplus
+}
+#endif   
+
+#endif /* */
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
@@ -0,0 +1,89 @@
+/**
+********************************************************************************
+* @author       Byron Palavikas
+* @date
+* @file         BVR_format.h
+* @brief        bounded printf style formatter
+* @version      V0.1.0
+* @copyright    (C) COPYRIGHT
+* @target       ARM STM32
+* @IDE
+* @repo         git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*           Drop in for vsnprintf and snprintf without newlib's printf, no
+*           heap, no locale and never writes past size. The output is always
+*           null terminated when size > 0 and the return is the length the
+*           whole string would have had, same as vsnprintf.
+*
+*           Supports flags - + space # 0, width and precision (also *),
+*           length hh h l ll z j t and d i u o x X c s p %.
+*           Integers up to 32 bits never use 64 bit division.
+*           Set BVR_FORMAT_FLOAT to 1 for f F e E g G, all printed as fixed
+*           point (%f style), off it prints the conversion as ?.
+*
+*           EXAMPLE
+*           char line[64];
+*           BVR_snprintf(line, sizeof(line), "ADC %u = %d mV", channel, millivolts);
+*
+********************************************************************************
+*/
+#ifndef BVR_FORMAT_H_
+#define BVR_FORMAT_H_
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <stdarg.h>
+#include <stdint.h>
+#include <stddef.h>
+
+
+/*--DEFINES-------------------------------------------------------------------*/
+
+/*--PLATFORM-CONF-------------------------------------------------------------*/
+// Set float conversions on = 1 off = 0, pulls in the soft or hard float code
+#ifndef BVR_FORMAT_FLOAT
+#define BVR_FORMAT_FLOAT 0
+#endif
+/*--PLATFORM-CONF-------------------------------------------------------------*/
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+/*--FUNCTION--PROTOTYPE-------------------------------------------------------*/
+
+/**
+  * @brief Format into buf, at most size - 1 characters and a null
+  * @note  same return as vsnprintf, >= size means the output was cut short
+  * @param char *buf can be NULL when size is 0
+  * @param size_t size
+  * @param const char *fmt
+  * @param va_list args
+  * @retval int length of the full output
+  */
+extern int BVR_vsnprintf(char *buf, size_t size, const char *fmt, va_list args);
+
+/**
+  * @brief Format into buf, at most size - 1 characters and a null
+  * @param char *buf
+  * @param size_t size
+  * @param const char *fmt, ...
+  * @retval int length of the full output
+  */
+extern int BVR_snprintf(char *buf, size_t size, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BVR_FORMAT_H_ */
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
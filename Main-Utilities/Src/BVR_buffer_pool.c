@@ -0,0 +1,163 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     BVR_buffer_pool.c
+* @brief    reference counted fixed block buffer pool
+* @version  V0.1
+* @target   STM32
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Refer to header file for more information
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+
+#include "BVR_buffer_pool.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+/* free list top, tag high and block index + 1 low */
+#define POOL_TOP_INDEX(t)       ((int)((t) & 0xFFFF))
+#define POOL_TOP(tag, index)    ((((uint32_t)(tag) + 0x10000) & 0xFFFF0000) | (uint32_t)(index))
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+/* block pointer to index, -1 when it is not the start of a block */
+static int pool_index(const buffer_pool_t *pool, const uint8_t *block)
+{
+    ptrdiff_t offset = block - pool->p_blocks;
+
+    if((block == NULL) || (offset < 0) || (offset % pool->block_size) ||
+       ((offset / pool->block_size) >= pool->count))
+    {
+        return -1;
+    }
+
+    return (int)(offset / pool->block_size);
+}
+
+
+/* put a block on the free list */
+static void pool_push(buffer_pool_t *pool, int index)
+{
+    uint32_t top = BVR_LOAD_ACQUIRE(&pool->free_top);
+
+    do
+    {
+        BVR_STORE_RELEASE(&pool->p_meta[index].next, (uint16_t)POOL_TOP_INDEX(top));
+    } while(!BVR_COMPARE_EXCHANGE(&pool->free_top, &top, POOL_TOP(top, index + 1)));
+
+    BVR_ATOMIC_ADD(&pool->free_count, 1);
+}
+
+
+BVR_status_t BVR_pool_init(buffer_pool_t *pool, uint8_t blocks[], pool_meta_t meta[],
+                           int block_size, int count)
+{
+    int index;
+
+    if((blocks == NULL) || (meta == NULL) || (count < 1) || (count > POOL_MAX_BLOCKS) ||
+       (block_size < BVR_POOL_ALIGN) || (block_size % BVR_POOL_ALIGN) ||
+       ((uintptr_t)blocks % BVR_POOL_ALIGN))
+    {
+        return BVR_ERROR;
+    }
+
+    pool->p_blocks   = blocks;
+    pool->p_meta     = meta;
+    pool->block_size = block_size;
+    pool->count      = count;
+    pool->free_count = count;
+
+    // chain every block, block 0 first
+    for(index = 0; index < count; index++)
+    {
+        meta[index].next = (index + 1 < count) ? (uint16_t)(index + 2) : 0x00;
+        meta[index].refs = 0x00;
+    }
+    pool->free_top = 0x01;
+
+    return BVR_OK;
+}
+
+
+uint8_t *BVR_pool_alloc(buffer_pool_t *pool)
+{
+    uint32_t top = BVR_LOAD_ACQUIRE(&pool->free_top);
+    int index;
+
+    do
+    {
+        if(POOL_TOP_INDEX(top) == 0){return NULL;}
+        index = POOL_TOP_INDEX(top) - 1;
+        // the tag fails the swap if this block was taken and freed meanwhile
+    } while(!BVR_COMPARE_EXCHANGE(&pool->free_top, &top,
+                                  POOL_TOP(top, BVR_LOAD_ACQUIRE(&pool->p_meta[index].next))));
+
+    BVR_ATOMIC_SUB(&pool->free_count, 1);
+    BVR_STORE_RELEASE(&pool->p_meta[index].refs, 1);
+    return pool->p_blocks + (index * pool->block_size);
+}
+
+
+BVR_status_t BVR_pool_ref(buffer_pool_t *pool, uint8_t *block)
+{
+    int index = pool_index(pool, block);
+
+    if((index < 0) || (BVR_LOAD_ACQUIRE(&pool->p_meta[index].refs) == 0))
+    {
+        return BVR_ERROR;
+    }
+
+    BVR_ATOMIC_ADD(&pool->p_meta[index].refs, 1);
+    return BVR_OK;
+}
+
+
+BVR_status_t BVR_pool_release(buffer_pool_t *pool, uint8_t *block)
+{
+    int index = pool_index(pool, block);
+    uint16_t refs;
+
+    if(index < 0)
+    {
+        return BVR_ERROR;
+    }
+
+    refs = BVR_LOAD_ACQUIRE(&pool->p_meta[index].refs);
+    do
+    {
+        // released more often than referenced
+        if(refs == 0){return BVR_ERROR;}
+    } while(!BVR_COMPARE_EXCHANGE(&pool->p_meta[index].refs, &refs, refs - 1));
+
+    if(refs == 1)
+    {
+        pool_push(pool, index);
+    }
+
+    return BVR_OK;
+}
+
+
+int BVR_pool_free_count(buffer_pool_t *pool)
+{
+    return BVR_LOAD_ACQUIRE(&pool->free_count);
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
@@ -1,202 +1,634 @@
-/** 
-*******************************************************************************
-*
-*@author    Byron Palavikas 
-*@date      10/09/2023
-*@file      debug_logger.c
-*@brief     embedded debug logging
-*@version   V0.1
-*@target    STM32 Devices
-*@IDE
-*@repo      git@github.com:bpalavikas/STM32-helper.git
-*
-*
-*******************************************************************************
-*@attention
-*           Refer to header file for more information
-*
-*******************************************************************************
-*/
-
-/******************************************************************************/
-/*                                                                            */
-/******************************************************************************/
-
-/*--INCLUDES------------------------------------------------------------------*/
-#include "BVR_debug_logger.h"
-#include "BVR_fifo_buffer.h"
-
-#if SEGGER_DBG
-    #include "SEGGER_SYSVIEW.h"
-#endif
-
-
-/*--DATA--TYPE----------------------------------------------------------------*/
-
-log_message_t log_tx_message;
-extern fifo_t dbg_uart_tx_fifo;
-
-
-/*--FUNCTION------------------------------------------------------------------*/
-
-void log_print(const char *fmt, ...)
-{
-    va_list argp;
-
-    va_start(argp, fmt);
-    if(vsprintf((char *)log_tx_message.buffer, fmt, argp) <= 0) return;
-    va_end(argp);
-
-    log_tx_message.length = strlen((char *)log_tx_message.buffer);
-
-    #if SEGGER_DBG
-    // check for log level
-    if(log_tx_message.buffer[0] == 'E')
-    {
-        SEGGER_SYSVIEW_Error((char *)log_tx_message.buffer);
-    }
-    else if(log_tx_message.buffer[0] == 'W')
-    {
-        SEGGER_SYSVIEW_Warn((char *)log_tx_message.buffer);
-    }
-    else
-    {
-        SEGGER_SYSVIEW_Print((char *)log_tx_message.buffer);
-    }
-    #else
-    BVR_uart_debug_send((uint8_t*) log_tx_message.buffer, log_tx_message.length);
-    #endif
-}
-
-
-void BVR_uart_debug_init(void)
-{
-    // set buffers for dma
-    static uint8_t dbg_uart_rx_buff[UART_BUFFER_LENGTH]; 
-    static uint8_t dbg_uart_tx_buff[UART_BUFFER_LENGTH*8];
-
-    // set dma receive buffers
-    HAL_UART_Receive_DMA(   &DBG_HUART, 
-                            dbg_uart_rx_buff, 
-                            ARRAY_SIZE(dbg_uart_rx_buff));
-
-    //disable the interrupts for dma
-    __HAL_DMA_DISABLE_IT(&DBG_HDMA_RX, DMA_IT_TC | DMA_IT_HT | DMA_IT_TE);
-
-
-    //set the tx buffers
-    BVR_fifo_init(  &dbg_uart_tx_fifo, 
-                    (uint8_t*) dbg_uart_tx_buff,
-                    sizeof(dbg_uart_tx_buff));
-
-}
-
-/* To be changed and configured for each project */
-void BVR_uart_debug_get(  UART_HandleTypeDef *huart, 
-                    char data[],
-                    int data_len)
-{
-
-    // set 
-    volatile size_t head;
-    volatile size_t tail;
-
-    char temp_byte; 
-    char *p_output_buffer;
-
-    // set the positions for read and write 
-    head = huart->RxXferCount;
-    tail = (UART_BUFFER_LENGTH) - (huart->hdmarx->Instance->NDTR);
-
-    for(p_output_buffer = data, data_len--; data_len > 0; data_len--)
-    {
-        if(head != tail)
-        { 
-            // get byte from uart
-            temp_byte = huart->pRxBuffPtr[head++];        
-
-            // head check 
-            if(head >= UART_BUFFER_LENGTH){head = 0;}
-
-            // check for end of line 
-            if((temp_byte == '\n') | (temp_byte == '\r'))
-            {
-                // store head position of uart
-                huart->RxXferCount = head;
-                // null terminate the string 
-                p_output_buffer =  '\0'; 
-                // get out of here
-                return;
-            }
-            else if(temp_byte == '\b')
-            {
-                // decrement if backspace 
-                p_output_buffer--; 
-            }
-            else if(temp_byte == '\x1B')
-            {
-                // erase previous character if special key found 
-                p_output_buffer = data;
-            }
-            else if(isprint(temp_byte))
-            {
-                *p_output_buffer++ = temp_byte;
-            }
-        } 
-        else 
-        { 
-            // no data in the buffer
-            break;
-        }
-    }
-
-    // if we are here then data exceeded the max length or is 0
-    *p_output_buffer = '\0';
-}
-
-
-void BVR_uart_debug_flush(UART_HandleTypeDef *huart)
-{
-    // set head and tail for function    
-    volatile size_t head = 0; 
-    volatile size_t tail = 0;
-
-    // update positions for buffers
-    tail = (UART_BUFFER_LENGTH) - (huart->hdmarx->Instance->NDTR);
-    head = tail;
-
-    // head check 
-    if(head >= UART_BUFFER_LENGTH){head = 0;}
-
-    // store new head postion 
-    huart->RxXferCount = head; 
-}
-
-
-
-BVR_status_t BVR_uart_debug_send(uint8_t *p_data, int size)
-{ 
-    if(BVR_fifo_push(&dbg_uart_tx_fifo, (uint8_t*) p_data, size) == BVR_OK)
-    {
-        if(DBG_HUART.gState == HAL_UART_STATE_READY)
-        {
-            volatile temp_buffer_t dma_temp;
-            dma_temp = BVR_fifo_pop_from_temp(&dbg_uart_tx_fifo); 
-            HAL_UART_Transmit_DMA(  &DBG_HUART, 
-                                    dma_temp.p_temp_buff, 
-                                    dma_temp.buff_size);
-            // CTI_uart_debug_flush(
-            return BVR_OK; 
-
-        }
-
-        return BVR_ERROR; 
-    } 
-
-    return BVR_ERROR;
-}
-
-
-/******************************************************************************/
-/*                              END OF FILE                                   */
-/******************************************************************************/
+/** 
+*******************************************************************************
+*
+*@author    Byron Palavikas 
+*@date      10/09/2023
+*@file      debug_logger.c
+*@brief     embedded debug logging
+*@version   V0.1
+*@target    STM32 Devices
+*@IDE
+*@repo      git@github.com:bpalavikas/STM32-helper.git
+*
+*
+*******************************************************************************
+*@attention
+*           Refer to header file for more information
+*
+*******************************************************************************
+*/
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include "BVR_debug_logger.h"
+#include "BVR_fifo_buffer.h"
+#include "BVR_format.h"
+
+#if SEGGER_DBG
+    #include "SEGGER_SYSVIEW.h"
+#endif
+
+#if LOG_TASK
+    #include "FreeRTOS.h"
+    #include "task.h"
+#endif
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+/* prio_fifo_t lanes, urgent drains first */
+#define LOG_LANE_URGENT 0
+#define LOG_LANE_BULK   1
+#define LOG_MARKER_SIZE 48
+
+extern fifo_t dbg_uart_tx_fifo;
+static fifo_t dbg_uart_urgent_fifo;
+static prio_fifo_t dbg_uart_tx_prio;
+#if LOG_TASK
+/* logger task notification bits */
+#define LOG_NOTIFY_DATA 0x01
+#define LOG_NOTIFY_SENT 0x02
+
+static TaskHandle_t log_task_handle = NULL;
+static log_sink_t log_sink;
+#else
+static uint8_t dbg_uart_tx_busy = 0;
+#endif
+
+/* per context scratch, tasks take a free buffer and interrupts use one per
+ * nesting level, ISRs always finish in the reverse order they started */
+#if LOG_TASK_SCRATCH > 32
+    #error "LOG_TASK_SCRATCH is one bit each in log_task_busy"
+#endif
+static char log_task_scratch[LOG_TASK_SCRATCH][LOG_BUFFER_SIZE];
+static uint32_t log_task_busy = 0;
+static char log_isr_scratch[LOG_ISR_SCRATCH][LOG_BUFFER_SIZE];
+static uint32_t log_isr_depth = 0;
+static uint32_t log_scratch_drops = 0;
+
+/* module table, how many levels each slot is below LOG_LEVEL so zero (the
+ * startup state) passes every compiled level. Slot 0 is never turned down
+ * so a call site interns on first use, free slots already hold the amount
+ * to start at */
+uint8_t log_module_quiet[LOG_MAX_MODULES + 1];
+static const char *log_module_id[LOG_MAX_MODULES + 1];
+static uint8_t log_module_default = 0;
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+#if LOG_TASK
+/* default sink, send one span by DMA and sleep until it is out */
+static BVR_status_t log_uart_sink(const uint8_t *p_data, int size)
+{
+    uint32_t bits = 0;
+
+    // no complete callback follows a transfer that did not start
+    if(HAL_UART_Transmit_DMA(&DBG_HUART, (uint8_t *)p_data, size) != HAL_OK)
+    {
+        return BVR_ERROR;
+    }
+
+    while(!(bits & LOG_NOTIFY_SENT))
+    {
+        xTaskNotifyWait(0, LOG_NOTIFY_SENT, &bits, portMAX_DELAY);
+    }
+
+    return BVR_OK;
+}
+
+
+/* owns the sink, everything queued since the last wake goes out
+ * one contiguous span at a time, urgent lane first */
+static void log_task(void *argument)
+{
+    temp_buffer_t span;
+    TickType_t wait;
+    uint32_t bits;
+
+    UNUSED(argument);
+
+    for(;;)
+    {
+        wait = portMAX_DELAY;
+
+        // drain first, lines logged before the scheduler started are waiting
+        span = BVR_prio_claim(&dbg_uart_tx_prio);
+        while(span.buff_size > 0)
+        {
+            if(log_sink(span.p_temp_buff, span.buff_size) != BVR_OK)
+            {
+                // keep it queued, more logging or the timeout tries it again
+                BVR_prio_unclaim(&dbg_uart_tx_prio);
+                wait = pdMS_TO_TICKS(LOG_TASK_RETRY_MS);
+                break;
+            }
+            BVR_prio_release(&dbg_uart_tx_prio, span.buff_size);
+            span = BVR_prio_claim(&dbg_uart_tx_prio);
+        }
+
+        xTaskNotifyWait(0, LOG_NOTIFY_DATA, &bits, wait);
+    }
+}
+
+
+/* set bits in the logger task notification from a task or an ISR */
+static void log_task_notify(uint32_t bits)
+{
+    BaseType_t woken = pdFALSE;
+
+    if(log_task_handle == NULL) return;
+
+    if(__get_IPSR() != 0)
+    {
+        xTaskNotifyFromISR(log_task_handle, bits, eSetBits, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+    else
+    {
+        xTaskNotify(log_task_handle, bits, eSetBits);
+    }
+}
+
+
+/* producers only wake the logger task, it makes the HAL calls */
+static BVR_status_t uart_debug_start_tx(void)
+{
+    log_task_notify(LOG_NOTIFY_DATA);
+    return BVR_OK;
+}
+#else
+/* start a DMA transfer of whatever is waiting if the uart is idle,
+ * only the context that sets busy claims so a task and an ISR never both do */
+static BVR_status_t uart_debug_start_tx(void)
+{
+    temp_buffer_t dma_temp;
+    uint8_t idle;
+
+    for(;;)
+    {
+        idle = 0;
+        while(!BVR_COMPARE_EXCHANGE(&dbg_uart_tx_busy, &idle, 1))
+        {
+            if(idle){return BVR_BUSY;}
+        }
+
+        // released in BVR_uart_debug_tx_cplt once sent
+        dma_temp = BVR_prio_claim(&dbg_uart_tx_prio); 
+        if(dma_temp.buff_size > 0)
+        {
+            if(HAL_UART_Transmit_DMA(   &DBG_HUART, 
+                                        dma_temp.p_temp_buff, 
+                                        dma_temp.buff_size) == HAL_OK)
+            {
+                return BVR_OK;
+            }
+
+            // no complete callback is coming, keep the data for the next try
+            BVR_prio_unclaim(&dbg_uart_tx_prio);
+            BVR_STORE_RELEASE(&dbg_uart_tx_busy, 0);
+            return BVR_ERROR;
+        }
+
+        // a push that saw busy left its data to us, look again
+        BVR_STORE_RELEASE(&dbg_uart_tx_busy, 0);
+        if(BVR_prio_level(&dbg_uart_tx_prio) == 0){return BVR_OK;}
+    }
+}
+#endif
+
+
+/* scratch buffer for the calling context, NULL when none is free */
+static char *log_scratch_take(void)
+{
+    uint32_t busy;
+    uint32_t depth;
+    int slot;
+
+    if(__get_IPSR() != 0)
+    {
+        depth = BVR_ATOMIC_ADD(&log_isr_depth, 1) - 1;
+        if(depth < LOG_ISR_SCRATCH){return log_isr_scratch[depth];}
+        BVR_ATOMIC_SUB(&log_isr_depth, 1);
+    }
+    else
+    {
+        busy = BVR_LOAD_ACQUIRE(&log_task_busy);
+        do
+        {
+            for(slot = 0; (slot < LOG_TASK_SCRATCH) && (busy & (1UL << slot)); slot++){}
+            if(slot == LOG_TASK_SCRATCH){break;}
+        } while(!BVR_COMPARE_EXCHANGE(&log_task_busy, &busy, busy | (1UL << slot)));
+
+        if(slot < LOG_TASK_SCRATCH){return log_task_scratch[slot];}
+    }
+
+    BVR_ATOMIC_ADD(&log_scratch_drops, 1);
+    return NULL;
+}
+
+
+static void log_scratch_give(char *scratch)
+{
+    if(__get_IPSR() != 0)
+    {
+        BVR_ATOMIC_SUB(&log_isr_depth, 1);
+    }
+    else
+    {
+        BVR_ATOMIC_AND(&log_task_busy, ~(1UL << ((scratch - log_task_scratch[0]) / LOG_BUFFER_SIZE)));
+    }
+}
+
+
+#if LOG_DEFERRED && !SEGGER_DBG
+/* build one deferred record and push it whole */
+static BVR_status_t log_defer_push(fifo_t *lane, const char *fmt, const uint32_t *args, int nargs)
+{
+    uint8_t record[10 + (4 * LOG_DEFERRED_MAX_ARGS)];
+    uint32_t word;
+
+    if(nargs > LOG_DEFERRED_MAX_ARGS){nargs = LOG_DEFERRED_MAX_ARGS;}
+
+    record[0] = LOG_DEFERRED_SYNC;
+    record[1] = (uint8_t)nargs;
+    word = (uint32_t)(uintptr_t)fmt;
+    memcpy(&record[2], &word, 4);
+    word = LOG_TICK();
+    memcpy(&record[6], &word, 4);
+    memcpy(&record[10], args, 4 * nargs);
+
+    return BVR_fifo_push_mp(lane, record, 10 + (4 * nargs));
+}
+#endif
+
+
+#if !SEGGER_DBG
+/* push one marker line for messages lost since the last report into the
+ * bulk lane as soon as it has room for one, so the count gets out under
+ * sustained load too and the urgent lane is kept for real warnings. While
+ * the lane is full every line is dropped, one marker covers them all once
+ * space opens up. The context that moves reported_msgs on sends the marker
+ * and hands the count back if the push loses a race for the space */
+static void uart_debug_report_drops(void)
+{
+    static uint32_t reported_msgs = 0;
+    uint32_t reported = BVR_LOAD_ACQUIRE(&reported_msgs);
+    uint32_t dropped_msgs;
+    BVR_status_t status;
+#if LOG_DEFERRED
+    static const char drop_fmt[] __attribute__((section(".bvr_log_fmt"), used)) =
+        "WARN\t: %lu log messages dropped\r\n";
+    uint32_t lost;
+#else
+    char marker[LOG_MARKER_SIZE];
+    int length;
+#endif
+
+    BVR_prio_get_drops(&dbg_uart_tx_prio, &dropped_msgs, NULL);
+    dropped_msgs += BVR_LOAD_ACQUIRE(&log_scratch_drops);
+    if(dropped_msgs == reported) return;
+
+    // no room for it yet, the lines pushed in its place would only be dropped
+    if(BVR_fifo_space(&dbg_uart_tx_fifo) < LOG_MARKER_SIZE) return;
+    if(!BVR_COMPARE_EXCHANGE(&reported_msgs, &reported, dropped_msgs)) return;
+
+#if LOG_DEFERRED
+    lost = dropped_msgs - reported;
+    status = log_defer_push(&dbg_uart_tx_fifo, drop_fmt, &lost, 1);
+#else
+    status = BVR_ERROR;
+    length = BVR_snprintf(marker, sizeof(marker), "WARN\t: %lu log messages dropped\r\n",
+                      (unsigned long)(dropped_msgs - reported));
+    if(length > 0)
+    {
+        status = BVR_fifo_push_mp(&dbg_uart_tx_fifo, (uint8_t *)marker, length);
+    }
+#endif
+
+    if(status == BVR_OK)
+    {
+        uart_debug_start_tx();
+    }
+    else
+    {
+        // another context filled the space first, report these with the next
+        BVR_ATOMIC_SUB(&reported_msgs, dropped_msgs - reported);
+    }
+}
+#endif
+
+
+/* format one line into this context's scratch, on the uart path it is
+ * then pushed whole into the lane for its level.
+ * Not formatted in place like the single producer path was: a multi producer
+ * reservation has to be its exact final size because writers behind it have
+ * already reserved past its end, a line can not be cut short once it crosses
+ * the wrap, and measuring first would format every line twice. One copy of
+ * at most LOG_BUFFER_SIZE bytes costs less than any of those */
+static void log_vprint(int level, const char *fmt, va_list argp)
+{
+    char *scratch = log_scratch_take();
+    int length;
+
+    if(scratch == NULL) return;
+
+    length = BVR_vsnprintf(scratch, LOG_BUFFER_SIZE, fmt, argp);
+    if(length >= LOG_BUFFER_SIZE){length = LOG_BUFFER_SIZE - 1;}
+
+    #if SEGGER_DBG
+    UNUSED(level);
+
+    // check for log level
+    if(length <= 0)
+    {
+        // nothing to print
+    }
+    else if(scratch[0] == 'E')
+    {
+        SEGGER_SYSVIEW_Error(scratch);
+    }
+    else if(scratch[0] == 'W')
+    {
+        SEGGER_SYSVIEW_Warn(scratch);
+    }
+    else
+    {
+        SEGGER_SYSVIEW_Print(scratch);
+    }
+    log_scratch_give(scratch);
+    #else
+    fifo_t *lane = (level <= LOG_URGENT_LEVEL) ? &dbg_uart_urgent_fifo : &dbg_uart_tx_fifo;
+    BVR_status_t status = BVR_ERROR;
+
+    // report earlier losses ahead of this line
+    uart_debug_report_drops();
+
+    // one push per line so lines from other contexts never interleave
+    if(length > 0)
+    {
+        status = BVR_fifo_push_mp(lane, (uint8_t *)scratch, length);
+    }
+    log_scratch_give(scratch);
+
+    if(status == BVR_OK)
+    {
+        uart_debug_start_tx();
+    }
+    #endif
+}
+
+
+void log_print(const char *fmt, ...)
+{
+    va_list argp;
+
+    va_start(argp, fmt);
+    log_vprint(INFO, fmt, argp);
+    va_end(argp);
+}
+
+
+void log_print_level(int level, const char *fmt, ...)
+{
+    va_list argp;
+
+    va_start(argp, fmt);
+    log_vprint(level, fmt, argp);
+    va_end(argp);
+}
+
+
+#if LOG_DEFERRED && !SEGGER_DBG
+void log_defer(int level, const char *fmt, const uint32_t *args, int nargs)
+{
+    fifo_t *lane = (level <= LOG_URGENT_LEVEL) ? &dbg_uart_urgent_fifo : &dbg_uart_tx_fifo;
+
+    uart_debug_report_drops();
+
+    if(log_defer_push(lane, fmt, args, nargs) == BVR_OK)
+    {
+        uart_debug_start_tx();
+    }
+}
+#endif
+
+
+uint8_t log_module_intern(const char *id)
+{
+    const char *name;
+    int slot;
+
+    // slots only ever fill, so a match found stays valid
+    for(slot = 1; slot < LOG_MAX_MODULES; slot++)
+    {
+        name = BVR_LOAD_ACQUIRE(&log_module_id[slot]);
+        while(name == NULL)
+        {
+            if(BVR_COMPARE_EXCHANGE(&log_module_id[slot], &name, id)){return slot;}
+        }
+
+        if((name == id) || (strcmp(name, id) == 0)){return slot;}
+    }
+
+    // table full, the rest share the last slot
+    return LOG_MAX_MODULES;
+}
+
+
+void BVR_log_set_level(const char *id, int level)
+{
+    int slot;
+
+    uint8_t quiet;
+
+    // FATAL and STARTUP always print, nothing above LOG_LEVEL is compiled in
+    if(level < FATAL){level = FATAL;}
+    if(level > LOG_LEVEL){level = LOG_LEVEL;}
+    quiet = (uint8_t)(LOG_LEVEL - level);
+
+    if(id != NULL)
+    {
+        log_module_quiet[log_module_intern(id)] = quiet;
+        return;
+    }
+
+    log_module_default = quiet;
+    for(slot = 1; slot <= LOG_MAX_MODULES; slot++)
+    {
+        log_module_quiet[slot] = quiet;
+    }
+}
+
+
+int BVR_log_get_level(const char *id)
+{
+    if(id == NULL)
+    {
+        return LOG_LEVEL - log_module_default;
+    }
+
+    return LOG_LEVEL - log_module_quiet[log_module_intern(id)];
+}
+
+
+void BVR_uart_debug_tx_cplt(void)
+{
+#if LOG_TASK
+    // the logger task releases the span and sends the next
+    log_task_notify(LOG_NOTIFY_SENT);
+#else
+    // free what was just sent then send the next span
+    BVR_prio_release(&dbg_uart_tx_prio, DBG_HUART.TxXferSize);
+    BVR_STORE_RELEASE(&dbg_uart_tx_busy, 0);
+    uart_debug_start_tx();
+#endif
+}
+
+
+#if LOG_TASK
+void BVR_log_set_sink(log_sink_t sink)
+{
+    log_sink = (sink != NULL) ? sink : log_uart_sink;
+}
+#endif
+
+
+void BVR_uart_debug_init(void)
+{
+    // set buffers for dma
+    static uint8_t dbg_uart_rx_buff[UART_BUFFER_LENGTH]; 
+    static uint8_t dbg_uart_tx_buff[UART_BUFFER_LENGTH*8];
+
+    // set dma receive buffers
+    HAL_UART_Receive_DMA(   &DBG_HUART, 
+                            dbg_uart_rx_buff, 
+                            ARRAY_SIZE(dbg_uart_rx_buff));
+
+    //disable the interrupts for dma
+    __HAL_DMA_DISABLE_IT(&DBG_HDMA_RX, DMA_IT_TC | DMA_IT_HT | DMA_IT_TE);
+
+
+    //set the tx buffers
+    BVR_fifo_init_mp(   &dbg_uart_tx_fifo, 
+                    (uint8_t*) dbg_uart_tx_buff,
+                    sizeof(dbg_uart_tx_buff));
+    BVR_fifo_register(&dbg_uart_tx_fifo, "dbg_uart_tx");
+
+    // warnings and worse get their own lane so they skip queued traces
+    static uint8_t dbg_uart_urgent_buff[UART_BUFFER_LENGTH*2];
+    fifo_t *lanes[] = {&dbg_uart_urgent_fifo, &dbg_uart_tx_fifo};
+    const uint8_t weights[] = {LOG_URGENT_WEIGHT, 1};
+
+    BVR_fifo_init_mp(   &dbg_uart_urgent_fifo,
+                    dbg_uart_urgent_buff,
+                    sizeof(dbg_uart_urgent_buff));
+    BVR_fifo_register(&dbg_uart_urgent_fifo, "dbg_uart_urgent");
+    BVR_prio_init(&dbg_uart_tx_prio, lanes, weights, ARRAY_SIZE(lanes));
+
+#if LOG_TASK
+    if(log_sink == NULL){log_sink = log_uart_sink;}
+    xTaskCreate(log_task, "logger", LOG_TASK_STACK, NULL, LOG_TASK_PRIORITY, &log_task_handle);
+#endif
+}
+
+/* To be changed and configured for each project */
+void BVR_uart_debug_get(  UART_HandleTypeDef *huart, 
+                    char data[],
+                    int data_len)
+{
+
+    // set 
+    volatile size_t head;
+    volatile size_t tail;
+
+    char temp_byte; 
+    char *p_output_buffer;
+
+    // set the positions for read and write 
+    head = huart->RxXferCount;
+    tail = (UART_BUFFER_LENGTH) - (huart->hdmarx->Instance->NDTR);
+
+    for(p_output_buffer = data, data_len--; data_len > 0; data_len--)
+    {
+        if(head != tail)
+        { 
+            // get byte from uart
+            temp_byte = huart->pRxBuffPtr[head++];        
+
+            // head check 
+            if(head >= UART_BUFFER_LENGTH){head = 0;}
+
+            // check for end of line 
+            if((temp_byte == '\n') | (temp_byte == '\r'))
+            {
+                // store head position of uart
+                huart->RxXferCount = head;
+                // null terminate the string 
+                p_output_buffer =  '\0'; 
+                // get out of here
+                return;
+            }
+            else if(temp_byte == '\b')
+            {
+                // decrement if backspace 
+                p_output_buffer--; 
+            }
+            else if(temp_byte == '\x1B')
+            {
+                // erase previous character if special key found 
+                p_output_buffer = data;
+            }
+            else if(isprint(temp_byte))
+            {
+                *p_output_buffer++ = temp_byte;
+            }
+        } 
+        else 
+        { 
+            // no data in the buffer
+            break;
+        }
+    }
+
+    // if we are here then data exceeded the max length or is 0
+    *p_output_buffer = '\0';
+}
+
+
+void BVR_uart_debug_flush(UART_HandleTypeDef *huart)
+{
+    // set head and tail for function    
+    volatile size_t head = 0; 
+    volatile size_t tail = 0;
+
+    // update positions for buffers
+    tail = (UART_BUFFER_LENGTH) - (huart->hdmarx->Instance->NDTR);
+    head = tail;
+
+    // head check 
+    if(head >= UART_BUFFER_LENGTH){head = 0;}
+
+    // store new head postion 
+    huart->RxXferCount = head; 
+}
+
+
+
+BVR_status_t BVR_uart_debug_send(uint8_t *p_data, int size)
+{ 
+    if(BVR_fifo_push_mp(&dbg_uart_tx_fifo, (uint8_t*) p_data, size) == BVR_OK)
+    {
+        return uart_debug_start_tx();
+    } 
+
+    return BVR_ERROR;
+}
+
+
+/******************************************************************************/
+/*                              END OF FILE                                   */
+/******************************************************************************/
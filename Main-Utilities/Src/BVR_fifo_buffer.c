@@ -1,307 +1,2144 @@
-/**
-********************************************************************************
-* @author   Aidin Bervan 
-* @date     
-* @file    cti_fifo_buffer.c
-* @brief   FIFO buffer implementation
-* @version V0.1
-* @target  STM32
-* @IDE
-* @repo    git@github.com:bpalavikas/STM32-helper.git
-*
-********************************************************************************
-* @attention
-*       Refer to header file for more information
-********************************************************************************
-*/
-
-
-/******************************************************************************/
-/*                                                                            */
-/******************************************************************************/
-
-
-/*--INCLUDES------------------------------------------------------------------*/
-
-#include "BVR_fifo_buffer.h" 
-
-
-/*--DATA--TYPE----------------------------------------------------------------*/
-
-/*--GLOBAL--CONSTANTS---------------------------------------------------------*/
-
-/*--STATIC--DATA--------------------------------------------------------------*/
-
-/*--FUNCTION------------------------------------------------------------------*/
-
-
-BVR_status_t BVR_fifo_init(fifo_t *fifo, uint8_t buffer[], int depth)
-{
-    if(buffer != NULL)
-    {
-        fifo->p_buffer = buffer;
-        fifo->ctrl.depth = depth;
-        fifo->ctrl.level = 0x00;
-        fifo->ctrl.head  = 0x00;
-        fifo->ctrl.tail  = 0x00;
-        return BVR_OK;
-    }
-    else
-    {
-        // TODO repalce with non dma 
-        // HAL_UART_Transmit(&DBG_HUART, 
-        return BVR_ERROR; 
-    }
-}
-
-
-BVR_status_t BVR_fifo_push(fifo_t *fifo, uint8_t *data, int buffer_size)
-{
-    // Set function variables 
-    int end_of_buffer   = 0;
-    int count           = 0;
-    int head            = fifo->ctrl.head;
-    // set empty buffer level
-    end_of_buffer = fifo->ctrl.depth - fifo->ctrl.level;
-
-    // loop through buffer
-    if(end_of_buffer >= buffer_size)
-    {
-        for(count = 0; count < buffer_size; count++)
-        {
-            fifo->p_buffer[head++] = data[count];
-
-            // reset head
-            if(head >= fifo->ctrl.depth){head = 0;}
-        }
-
-        fifo->ctrl.head = head;
-        fifo->ctrl.level += buffer_size;
-        return BVR_OK;
-    }
-    else
-    {
-        // TODO repalce with non dma 
-        // HAL_UART_Transmit(&DBG_HUART, 
-        return BVR_ERROR;
-    }
-
-}
-
-
-BVR_status_t BVR_fifo_pop(fifo_t *fifo, uint8_t *data, int buffer_size)
-{ 
-    // set variables 
-    int count   = 0;
-    int tail    = fifo->ctrl.tail;
-    int level   = fifo->ctrl.level;
-    int depth   = fifo->ctrl.depth;
-
-
-    if(level >= buffer_size)
-    {
-        for(count = 0; count < buffer_size; count++)
-        {
-            data[count] = fifo->p_buffer[tail++];
-
-            if(tail>= depth){ tail = 0;}
-        }
-
-        fifo->ctrl.tail = tail;
-        fifo->ctrl.level -= buffer_size; 
-        return BVR_OK;
-    } 
-    else
-    {
-        // TODO repalce with non dma 
-        // HAL_UART_Transmit(&DBG_HUART, 
-        return BVR_ERROR; 
-    }
-}
-
-
-temp_buffer_t BVR_fifo_pop_from_temp(fifo_t *fifo)
-{
-    // set temp variables to volatile
-    volatile int depth = fifo->ctrl.depth;
-    volatile int level = fifo->ctrl.level;
-    volatile int tail  = fifo->ctrl.tail;
-    volatile int buffer_size;
-    volatile temp_buffer_t ret_buffer;
-
-    if(level > 0)
-    {
-        if((tail + level) < depth)
-        {
-            buffer_size = level; 
-        }
-        else
-        {
-            buffer_size = depth - tail; 
-        }
-
-        ret_buffer.p_temp_buff = fifo->p_buffer + tail;
-        ret_buffer.buff_size   = buffer_size; 
-        level -= buffer_size; 
-        tail  += buffer_size;
-
-        if(tail >= depth){ tail = 0;}
-
-        fifo->ctrl.level = level; 
-        fifo->ctrl.tail  = tail;
-    }
-    else
-    {
-        ret_buffer.p_temp_buff = NULL; 
-        ret_buffer.buff_size = 0; 
-    }
-
-    return ret_buffer; 
-}
-
-
-
-/******************************************************************************/
-/*                                UART                                        */
-/******************************************************************************/
-/* 
- * EXAMPLES For setting up UART 
- *
- *
-
-
-void BVR_fifo_uart_init(UART_HandleTypeDef huart, 
-                        DMA_HandelTypeDef dma_rx, 
-                        fifo_t fifo_tx)
-{
-    // set buffers for dma
-    static uint8_t uart_rx_buff[UART_BUFFER_LENGTH]; 
-    static uint8_t uart_tx_buff[UART_BUFFER_LENGTH*8];
-
-    // set dma receive buffers
-    HAL_UART_Receive_DMA(   &huart, 
-                            uart_rx_buff, 
-                            ARRAY_SIZE(uart_rx_buff));
-
-    //disable the interrupts for dma
-    __HAL_DMA_DISABLE_IT(&dam_rx, DMA_IT_TC | DMA_IT_HT | DMA_IT_TE);
-
-
-    //set the tx buffers
-    BVR_fifo_init(  &fifo_tx, 
-                    (uint8_t*) uart_tx_buff,
-                    sizeof(uart_tx_buff));
-
-}
-
-
-void BVR_fifo_uart_get(  UART_HandleTypeDef *huart, 
-                    char data[],
-                    int data_len)
-{
-
-    // set 
-    volatile size_t head;
-    volatile size_t tail;
-
-    char temp_byte; 
-    char *p_output_buffer;
-
-    // set the positions for read and write 
-    head = huart->RxXferCount;
-    tail = (UART_BUFFER_LENGTH) - (huart->hdmarx->Instance->NDTR);
-
-    for(p_output_buffer = data, data_len--; data_len > 0; data_len--)
-    {
-        if(head != tail)
-        { 
-            // get byte from uart
-            temp_byte = huart->pRxBuffPtr[head++];        
-
-            // head check 
-            if(head >= UART_BUFFER_LENGTH){head = 0;}
-
-            // check for end of line 
-            if((temp_byte == '\n') | (temp_byte == '\r'))
-            {
-                // store head position of uart
-                huart->RxXferCount = head;
-                // null terminate the string 
-                p_output_buffer =  '\0'; 
-                // get out of here
-                return;
-            }
-            else if(temp_byte == '\b')
-            {
-                // decrement if backspace 
-                p_output_buffer--; 
-            }
-            else if(temp_byte == '\x1B')
-            {
-                // erase previous character if special key found 
-                p_output_buffer = data;
-            }
-            else if(isprint(temp_byte))
-            {
-                *p_output_buffer++ = temp_byte;
-            }
-        } 
-        else 
-        { 
-            // no data in the buffer
-            break;
-        }
-    }
-
-    // if we are here then data exceeded the max length or is 0
-    *p_output_buffer = '\0';
-}
-
-
-void BVR_fifo_uart_flush(UART_HandleTypeDef *huart)
-{
-    // set head and tail for function    
-    volatile size_t head = 0; 
-    volatile size_t tail = 0;
-
-    // update positions for buffers
-    tail = (UART_BUFFER_LENGTH) - (huart->hdmarx->Instance->NDTR);
-    head = tail;
-
-    // head check 
-    if(head >= UART_BUFFER_LENGTH){head = 0;}
-
-    // store new head postion 
-    huart->RxXferCount = head; 
-}
-
-
-
-BVR_status_t BVR_fifo_uart_send(fifo_t fifo_tx, 
-                                UART_HandleTypeDef huart, 
-                                uint8_t *p_data, 
-                                int size)
-{ 
-    if(BVR_fifo_push(&fifo_tx, (uint8_t*) p_data, size) == FIFO_SUCCESS)
-    {
-        if(huart.gState == HAL_UART_STATE_READY)
-        {
-            volatile temp_buffer_t dma_temp;
-            dma_temp = BVR_fifo_pop_from_temp(&uart_tx_fifo); 
-            HAL_UART_Transmit_DMA(  &huart, 
-                                    dma_temp.p_temp_buff, 
-                                    dma_temp.buff_size);
-            return BVR_OK; 
-        }
-
-        return BVR_ERROR; 
-    } 
-
-    return BVR_ERROR;
-}
-
-*/
-
-/******************************************************************************/
-/*                             END OF FILE                                    */
-/******************************************************************************/
+/**
+********************************************************************************
+* @author   Aidin Bervan 
+* @date     
+* @file    cti_fifo_buffer.c
+* @brief   FIFO buffer implementation
+* @version V0.1
+* @target  STM32
+* @IDE
+* @repo    git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Refer to header file for more information
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+
+#include "BVR_fifo_buffer.h" 
+
+#if BVR_FIFO_RTOS
+    #include "FreeRTOS.h"
+    #include "task.h"
+#endif
+
+#if BVR_FIFO_STATS || BVR_FIFO_DMA
+    // Change for MCU in BVR_common_defs.h
+    #include BVR_MCU_HAL
+#endif
+
+#if BVR_FIFO_STATS
+    #include "BVR_debug_logger.h"
+#endif
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+/* multi producer words, write ticket high and ring position low */
+#define FIFO_MP_POS(w)          ((int)((w) & 0xFFFF))
+#define FIFO_MP_TICKET(w)       ((uint32_t)((w) >> 16))
+#define FIFO_MP_WORD(t, p)      ((((uint32_t)(t) & 0xFFFF) << 16) | (uint32_t)(p))
+
+#if BVR_FIFO_STATS
+    #define FIFO_STATS_IN(f, n)     fifo_stats_in((f), (n))
+    #define FIFO_STATS_OUT(f, n)    fifo_stats_out((f), (n))
+    #define FIFO_STATS_POP(f)       ((f)->ctrl.stats.pop_calls++)
+    #define FIFO_STATS_FAIL(f)      BVR_ATOMIC_ADD(&(f)->ctrl.stats.push_fails, 1)
+#else
+    #define FIFO_STATS_IN(f, n)     ((void)(n))
+    #define FIFO_STATS_OUT(f, n)    ((void)(n))
+    #define FIFO_STATS_POP(f)
+    #define FIFO_STATS_FAIL(f)
+#endif
+
+/*--GLOBAL--CONSTANTS---------------------------------------------------------*/
+
+/*--STATIC--DATA--------------------------------------------------------------*/
+
+#if BVR_FIFO_STATS
+static fifo_t *fifo_registry = NULL;
+#endif
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+/* head and tail run from 0 to 2*depth so a full fifo does not look empty,
+ * this lets the level come from head and tail without a shared counter */
+static inline int fifo_used(const fifo_t *fifo, int head, int tail)
+{
+    int used = head - tail;
+
+    if(fifo->ctrl.mask)
+    {
+        return used & ((fifo->ctrl.mask << 1) | 1);
+    }
+
+    if(used < 0){used += 2 * fifo->ctrl.depth;}
+    return used;
+}
+
+
+/* position in 0 to 2*depth to buffer index */
+static inline int fifo_index(const fifo_t *fifo, int pos)
+{
+    if(fifo->ctrl.mask)
+    {
+        return pos & fifo->ctrl.mask;
+    }
+
+    return (pos >= fifo->ctrl.depth) ? (pos - fifo->ctrl.depth) : pos;
+}
+
+
+/* move a head or tail position on by count */
+static inline int fifo_advance(const fifo_t *fifo, int pos, int count)
+{
+    pos += count;
+
+    if(fifo->ctrl.mask)
+    {
+        return pos & ((fifo->ctrl.mask << 1) | 1);
+    }
+
+    if(pos >= 2 * fifo->ctrl.depth){pos -= 2 * fifo->ctrl.depth;}
+    return pos;
+}
+
+
+/* head as seen by the consumer */
+static inline int fifo_load_head(fifo_t *fifo)
+{
+    if(fifo->ctrl.mp)
+    {
+        return FIFO_MP_POS(BVR_LOAD_ACQUIRE(&fifo->ctrl.published));
+    }
+
+    return BVR_LOAD_ACQUIRE(&fifo->ctrl.head);
+}
+
+
+/* consumer tail update, the producer can move the tail on an overwrite fifo
+ * so the update fails if the data was overwritten while it was read */
+static inline BVR_status_t fifo_store_tail(fifo_t *fifo, int old_tail, int new_tail)
+{
+    if(fifo->ctrl.policy == FIFO_OVERWRITE)
+    {
+        return BVR_COMPARE_EXCHANGE(&fifo->ctrl.tail, &old_tail, new_tail) ? BVR_OK : BVR_ERROR;
+    }
+
+    BVR_STORE_RELEASE(&fifo->ctrl.tail, new_tail);
+    return BVR_OK;
+}
+
+
+#if BVR_FIFO_STATS
+/* producer side, runs after the head is published */
+static void fifo_stats_in(fifo_t *fifo, int bytes)
+{
+    fifo_stats_t *stats = &fifo->ctrl.stats;
+    int level = BVR_fifo_level(fifo);
+
+    BVR_ATOMIC_ADD(&stats->bytes_in, (uint32_t)bytes);
+    if(level > stats->high_water){stats->high_water = level;}
+
+    if((level >= fifo->ctrl.depth) && !stats->full)
+    {
+        stats->full_tick = BVR_FIFO_TICK();
+        stats->full = 1;
+    }
+}
+
+
+/* consumer side, runs after the tail is moved */
+static void fifo_stats_out(fifo_t *fifo, int bytes)
+{
+    fifo_stats_t *stats = &fifo->ctrl.stats;
+    uint32_t full_time;
+
+    stats->bytes_out += bytes;
+
+    if(stats->full && (bytes > 0))
+    {
+        full_time = BVR_FIFO_TICK() - stats->full_tick;
+        if(full_time > stats->longest_full){stats->longest_full = full_time;}
+        stats->full = 0;
+    }
+}
+#endif
+
+
+#if BVR_FIFO_RTOS
+/* set bits in a task notification from a task or an ISR */
+static void fifo_task_notify(void *task, uint32_t bits)
+{
+    BaseType_t woken = pdFALSE;
+
+    if(xPortIsInsideInterrupt())
+    {
+        xTaskNotifyFromISR((TaskHandle_t)task, bits, eSetBits, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+    else
+    {
+        xTaskNotify((TaskHandle_t)task, bits, eSetBits);
+    }
+}
+
+
+/* only a running task can sleep */
+static inline int fifo_can_block(void)
+{
+    return (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) && !xPortIsInsideInterrupt();
+}
+
+
+/* sleep until size bytes of data (FIFO_NOTIFY_DATA) or space (FIFO_NOTIFY_SPACE)
+ * are there, the other side wakes the task registered in waiter */
+static BVR_status_t fifo_wait(fifo_t *fifo, void **waiter, uint32_t bit, int size, uint32_t timeout_ms)
+{
+    TickType_t start = xTaskGetTickCount();
+    TickType_t ticks = pdMS_TO_TICKS(timeout_ms);
+    TickType_t elapsed;
+    BVR_status_t status = BVR_TIMEOUT;
+    void *expected = NULL;
+
+    if(size > fifo->ctrl.depth)
+    {
+        return BVR_ERROR;
+    }
+
+    // one waiting task per side
+    while(!BVR_COMPARE_EXCHANGE(waiter, &expected, (void *)xTaskGetCurrentTaskHandle()))
+    {
+        if(expected != NULL){return BVR_BUSY;}
+    }
+
+    for(;;)
+    {
+        // checked after registering so a wakeup before the wait is not lost
+        if(((bit == FIFO_NOTIFY_DATA) ? BVR_fifo_level(fifo) : BVR_fifo_space(fifo)) >= size)
+        {
+            status = BVR_OK;
+            break;
+        }
+
+        elapsed = xTaskGetTickCount() - start;
+        if(elapsed >= ticks){break;}
+
+        xTaskNotifyWait(0x00, bit, NULL, ticks - elapsed);
+    }
+
+    BVR_STORE_RELEASE(waiter, NULL);
+    return status;
+}
+
+
+/* wake a task waiting on the other side */
+static inline void fifo_wake(void **waiter, uint32_t bit)
+{
+    void *task = BVR_LOAD_ACQUIRE(waiter);
+
+    if(task != NULL){fifo_task_notify(task, bit);}
+}
+#endif
+
+
+/* producer side, high mark once per crossing. Both sides flip above with a
+ * compare and swap so only one of them calls back for each crossing */
+static inline void fifo_marks_in(fifo_t *fifo)
+{
+    uint8_t state = 0x00;
+
+    if((fifo->ctrl.on_mark == NULL) || (BVR_fifo_level(fifo) < fifo->ctrl.high_mark))
+    {
+        return;
+    }
+
+    while(!BVR_COMPARE_EXCHANGE(&fifo->ctrl.above, &state, 0x01))
+    {
+        if(state){return;}
+    }
+
+    fifo->ctrl.on_mark(fifo, FIFO_MARK_HIGH, fifo->ctrl.mark_ctx);
+}
+
+
+/* consumer side, low mark once the high mark has fired */
+static inline void fifo_marks_out(fifo_t *fifo)
+{
+    uint8_t state = 0x01;
+
+    if((fifo->ctrl.on_mark == NULL) || (BVR_fifo_level(fifo) > fifo->ctrl.low_mark))
+    {
+        return;
+    }
+
+    while(!BVR_COMPARE_EXCHANGE(&fifo->ctrl.above, &state, 0x00))
+    {
+        if(!state){return;}
+    }
+
+    fifo->ctrl.on_mark(fifo, FIFO_MARK_LOW, fifo->ctrl.mark_ctx);
+}
+
+
+/* runs after the head is published */
+static inline void fifo_pushed(fifo_t *fifo, int bytes)
+{
+    FIFO_STATS_IN(fifo, bytes);
+    fifo_marks_in(fifo);
+#if BVR_FIFO_RTOS
+    fifo_wake(&fifo->ctrl.pop_waiter, FIFO_NOTIFY_DATA);
+#endif
+}
+
+
+/* runs after the tail is moved */
+static inline void fifo_popped(fifo_t *fifo, int bytes)
+{
+    FIFO_STATS_OUT(fifo, bytes);
+    fifo_marks_out(fifo);
+#if BVR_FIFO_RTOS
+    fifo_wake(&fifo->ctrl.push_waiter, FIFO_NOTIFY_SPACE);
+#endif
+}
+
+
+/* count data lost to overflow */
+static inline void fifo_drop(fifo_t *fifo, int bytes, int msgs)
+{
+    FIFO_STATS_FAIL(fifo);
+    BVR_ATOMIC_ADD(&fifo->ctrl.dropped_bytes, (uint32_t)bytes);
+    BVR_ATOMIC_ADD(&fifo->ctrl.dropped_msgs, (uint32_t)msgs);
+}
+
+
+/* copy into the ring at index, at most two memcpy either side of the wrap.
+ * memcpy moves whole words when both pointers are aligned */
+static void fifo_write(fifo_t *fifo, int index, const uint8_t *data, int size)
+{
+    int first = fifo->ctrl.depth - index;
+
+    if(first >= size)
+    {
+        memcpy(fifo->p_buffer + index, data, size);
+    }
+    else
+    {
+        memcpy(fifo->p_buffer + index, data, first);
+        memcpy(fifo->p_buffer, data + first, size - first);
+    }
+}
+
+
+/* copy out of the ring from index, at most two memcpy either side of the wrap */
+static void fifo_read(const fifo_t *fifo, int index, uint8_t *data, int size)
+{
+    int first = fifo->ctrl.depth - index;
+
+    if(first >= size)
+    {
+        memcpy(data, fifo->p_buffer + index, size);
+    }
+    else
+    {
+        memcpy(data, fifo->p_buffer + index, first);
+        memcpy(data + first, fifo->p_buffer, size - first);
+    }
+}
+
+
+BVR_status_t BVR_fifo_init(fifo_t *fifo, uint8_t buffer[], int depth)
+{
+    if(buffer != NULL)
+    {
+        fifo->p_buffer = buffer;
+        fifo->ctrl.depth = depth;
+        fifo->ctrl.head  = 0x00;
+        fifo->ctrl.tail  = 0x00;
+        fifo->ctrl.claim = 0x00;
+        fifo->ctrl.mp    = 0x00;
+        fifo->ctrl.cursor    = 0x00;
+        fifo->ctrl.published = 0x00;
+        fifo->ctrl.policy  = FIFO_REJECT;
+        fifo->ctrl.timeout_ms    = 0x00;
+        fifo->ctrl.dropped_bytes = 0x00;
+        fifo->ctrl.dropped_msgs  = 0x00;
+        fifo->ctrl.high_mark = 0x00;
+        fifo->ctrl.low_mark  = 0x00;
+        fifo->ctrl.above     = 0x00;
+        fifo->ctrl.on_mark   = NULL;
+        fifo->ctrl.mark_ctx  = NULL;
+#if BVR_FIFO_RTOS
+        fifo->ctrl.push_waiter = NULL;
+        fifo->ctrl.pop_waiter  = NULL;
+#endif
+#if BVR_FIFO_STATS
+        fifo->ctrl.stats.high_water   = 0x00;
+        fifo->ctrl.stats.bytes_in     = 0x00;
+        fifo->ctrl.stats.bytes_out    = 0x00;
+        fifo->ctrl.stats.push_fails   = 0x00;
+        fifo->ctrl.stats.pop_calls    = 0x00;
+        fifo->ctrl.stats.start_tick   = BVR_FIFO_TICK();
+        fifo->ctrl.stats.longest_full = 0x00;
+        fifo->ctrl.stats.full         = 0x00;
+#endif
+        // power of two depth wraps with a mask
+        fifo->ctrl.mask  = ((depth > 0) && ((depth & (depth - 1)) == 0)) ? (depth - 1) : 0x00;
+        return BVR_OK;
+    }
+    else
+    {
+        // TODO repalce with non dma 
+        // HAL_UART_Transmit(&DBG_HUART, 
+        return BVR_ERROR; 
+    }
+}
+
+
+/* make room for size bytes following the overflow policy,
+ * returns how many bytes can be written */
+static int fifo_overflow(fifo_t *fifo, int head, int size)
+{
+    int tail = BVR_LOAD_ACQUIRE(&fifo->ctrl.tail);
+    int space = fifo->ctrl.depth - fifo_used(fifo, head, tail);
+
+    switch(fifo->ctrl.policy)
+    {
+        case FIFO_OVERWRITE:
+            if(size > fifo->ctrl.depth){break;}
+            // move the tail past the oldest data, fails if the consumer moved it first
+            while(!BVR_COMPARE_EXCHANGE(&fifo->ctrl.tail, &tail, fifo_advance(fifo, tail, size - space)))
+            {
+                space = fifo->ctrl.depth - fifo_used(fifo, head, tail);
+                if(space >= size){return size;}
+            }
+            fifo_drop(fifo, size - space, 1);
+            return size;
+
+        case FIFO_TRUNCATE:
+            return space;
+
+        case FIFO_BLOCK:
+        #if BVR_FIFO_RTOS
+            // never block in an ISR or before the scheduler is running
+            if(fifo_can_block() &&
+               (fifo_wait(fifo, &fifo->ctrl.push_waiter, FIFO_NOTIFY_SPACE, size, fifo->ctrl.timeout_ms) == BVR_OK))
+            {
+                return size;
+            }
+        #endif
+            break;
+
+        case FIFO_REJECT:
+        default:
+            break;
+    }
+
+    return (space >= size) ? size : 0;
+}
+
+
+BVR_status_t BVR_fifo_push(fifo_t *fifo, uint8_t *data, int buffer_size)
+{
+    // Set function variables 
+    int head    = fifo->ctrl.head;
+    int tail    = BVR_LOAD_ACQUIRE(&fifo->ctrl.tail);
+    int size    = buffer_size;
+
+    // the head of a multi producer fifo only moves through BVR_fifo_push_mp
+    if(fifo->ctrl.mp)
+    {
+        return BVR_ERROR;
+    }
+
+    // check for empty space
+    if((fifo->ctrl.depth - fifo_used(fifo, head, tail)) < buffer_size)
+    {
+        size = fifo_overflow(fifo, head, buffer_size);
+    }
+
+    if(size <= 0)
+    {
+        fifo_drop(fifo, buffer_size, 1);
+        return BVR_ERROR;
+    }
+
+    fifo_write(fifo, fifo_index(fifo, head), data, size);
+
+    // data must be written before the consumer sees the new head
+    BVR_STORE_RELEASE(&fifo->ctrl.head, fifo_advance(fifo, head, size));
+    fifo_pushed(fifo, size);
+
+    if(size < buffer_size)
+    {
+        // truncated
+        fifo_drop(fifo, buffer_size - size, 0);
+        return BVR_ERROR;
+    }
+
+    return BVR_OK;
+}
+
+
+BVR_status_t BVR_fifo_pushv(fifo_t *fifo, const struct bvr_iov *iov, int count)
+{
+    int head  = fifo->ctrl.head;
+    int tail  = BVR_LOAD_ACQUIRE(&fifo->ctrl.tail);
+    int total = 0;
+    int piece;
+
+    if(fifo->ctrl.mp)
+    {
+        return BVR_ERROR;
+    }
+
+    for(piece = 0; piece < count; piece++)
+    {
+        total += iov[piece].len;
+    }
+
+    if((fifo->ctrl.depth - fifo_used(fifo, head, tail)) < total)
+    {
+        fifo_drop(fifo, total, 1);
+        return BVR_ERROR;
+    }
+
+    // copy each piece after the last, the head is only published at the end
+    for(piece = 0; piece < count; piece++)
+    {
+        fifo_write(fifo, fifo_index(fifo, head), (const uint8_t *)iov[piece].base, iov[piece].len);
+        head = fifo_advance(fifo, head, iov[piece].len);
+    }
+
+    BVR_STORE_RELEASE(&fifo->ctrl.head, head);
+    fifo_pushed(fifo, total);
+    return BVR_OK;
+}
+
+
+BVR_status_t BVR_fifo_init_mp(fifo_t *fifo, uint8_t buffer[], int depth)
+{
+    int slot;
+
+    // positions run to 2*depth and have to fit in 16 bits of the cursor
+    if((depth > FIFO_MP_MAX_DEPTH) || (BVR_fifo_init(fifo, buffer, depth) != BVR_OK))
+    {
+        return BVR_ERROR;
+    }
+
+    // each slot looks done by the ticket one lap before, so not by its first
+    for(slot = 0; slot < FIFO_MP_SLOTS; slot++)
+    {
+        fifo->ctrl.commit[slot] = FIFO_MP_WORD(slot - FIFO_MP_SLOTS, 0);
+    }
+
+    fifo->ctrl.mp = 0x01;
+    return BVR_OK;
+}
+
+
+/* move the head over every finished write in ticket order, any writer can
+ * do it so an ISR never waits on the task it interrupted */
+static void fifo_mp_publish(fifo_t *fifo)
+{
+    uint32_t published;
+    uint32_t next;
+    uint32_t ticket;
+    uint32_t done;
+
+    // a commit store and a published load must not pass each other, else this
+    // writer and the one publishing ahead of it could both miss the commit
+    BVR_MEMORY_BARRIER();
+    published = BVR_LOAD_ACQUIRE(&fifo->ctrl.published);
+
+    for(;;)
+    {
+        ticket = FIFO_MP_TICKET(published);
+        done   = BVR_LOAD_ACQUIRE(&fifo->ctrl.commit[ticket & (FIFO_MP_SLOTS - 1)]);
+
+        // the oldest write is still in progress, its writer publishes
+        if(FIFO_MP_TICKET(done) != ticket){return;}
+
+        next = FIFO_MP_WORD(ticket + 1, FIFO_MP_POS(done));
+        if(BVR_COMPARE_EXCHANGE(&fifo->ctrl.published, &published, next))
+        {
+            published = next;
+            BVR_MEMORY_BARRIER();
+        }
+    }
+}
+
+
+BVR_status_t BVR_fifo_push_mp(fifo_t *fifo, uint8_t *data, int buffer_size)
+{
+    uint32_t cursor = BVR_LOAD_ACQUIRE(&fifo->ctrl.cursor);
+    uint32_t ticket;
+    int pos;
+    int end;
+
+    do
+    {
+        ticket = FIFO_MP_TICKET(cursor);
+        pos    = FIFO_MP_POS(cursor);
+
+        // no room, or every commit slot is waiting on an earlier write
+        if(((fifo->ctrl.depth - fifo_used(fifo, pos, BVR_LOAD_ACQUIRE(&fifo->ctrl.tail))) < buffer_size) ||
+           (((ticket - FIFO_MP_TICKET(BVR_LOAD_ACQUIRE(&fifo->ctrl.published))) & 0xFFFF) >= FIFO_MP_SLOTS))
+        {
+            fifo_drop(fifo, buffer_size, 1);
+            return BVR_ERROR;
+        }
+
+        end = fifo_advance(fifo, pos, buffer_size);
+    } while(!BVR_COMPARE_EXCHANGE(&fifo->ctrl.cursor, &cursor, FIFO_MP_WORD(ticket + 1, end)));
+
+    fifo_write(fifo, fifo_index(fifo, pos), data, buffer_size);
+
+    // mark this ticket done then publish it and whatever finished behind it
+    BVR_STORE_RELEASE(&fifo->ctrl.commit[ticket & (FIFO_MP_SLOTS - 1)], FIFO_MP_WORD(ticket, end));
+    fifo_mp_publish(fifo);
+    fifo_pushed(fifo, buffer_size);
+
+    return BVR_OK;
+}
+
+
+#if BVR_FIFO_RTOS
+BVR_status_t BVR_fifo_push_wait(fifo_t *fifo, uint8_t *data, int buffer_size, uint32_t timeout_ms)
+{
+    BVR_status_t status;
+
+    if(fifo->ctrl.mp)
+    {
+        return BVR_ERROR;
+    }
+
+    if(fifo_can_block())
+    {
+        status = fifo_wait(fifo, &fifo->ctrl.push_waiter, FIFO_NOTIFY_SPACE, buffer_size, timeout_ms);
+        if(status != BVR_OK)
+        {
+            fifo_drop(fifo, buffer_size, 1);
+            return status;
+        }
+    }
+
+    return BVR_fifo_push(fifo, data, buffer_size);
+}
+
+
+BVR_status_t BVR_fifo_pop_wait(fifo_t *fifo, uint8_t *data, int buffer_size, uint32_t timeout_ms)
+{
+    BVR_status_t status;
+
+    if(fifo_can_block())
+    {
+        status = fifo_wait(fifo, &fifo->ctrl.pop_waiter, FIFO_NOTIFY_DATA, buffer_size, timeout_ms);
+        if(status != BVR_OK){return status;}
+    }
+
+    return BVR_fifo_pop(fifo, data, buffer_size);
+}
+#endif
+
+
+BVR_status_t BVR_fifo_pop(fifo_t *fifo, uint8_t *data, int buffer_size)
+{ 
+    // set variables 
+    int tail    = fifo->ctrl.tail;
+    int head    = fifo_load_head(fifo);
+
+
+    FIFO_STATS_POP(fifo);
+
+    if(fifo_used(fifo, head, tail) >= buffer_size)
+    {
+        fifo_read(fifo, fifo_index(fifo, tail), data, buffer_size);
+
+        // data must be read before the producer can reuse the space
+        if(fifo_store_tail(fifo, tail, fifo_advance(fifo, tail, buffer_size)) != BVR_OK)
+        {
+            // overwritten while reading
+            return BVR_ERROR;
+        }
+        fifo->ctrl.claim = fifo_advance(fifo, tail, buffer_size);
+        fifo_popped(fifo, buffer_size);
+        return BVR_OK;
+    } 
+    else
+    {
+        // TODO repalce with non dma 
+        // HAL_UART_Transmit(&DBG_HUART, 
+        return BVR_ERROR; 
+    }
+}
+
+
+temp_buffer_t BVR_fifo_pop_from_temp(fifo_t *fifo)
+{
+    // set temp variables
+    int depth = fifo->ctrl.depth;
+    int tail  = fifo->ctrl.tail;
+    int head  = fifo_load_head(fifo);
+    int level = fifo_used(fifo, head, tail);
+    int index = fifo_index(fifo, tail);
+    int buffer_size;
+    temp_buffer_t ret_buffer;
+
+    FIFO_STATS_POP(fifo);
+
+    if(level > 0)
+    {
+        if((index + level) < depth)
+        {
+            buffer_size = level; 
+        }
+        else
+        {
+            buffer_size = depth - index; 
+        }
+
+        ret_buffer.p_temp_buff = fifo->p_buffer + index;
+        ret_buffer.buff_size   = buffer_size; 
+
+        if(fifo_store_tail(fifo, tail, fifo_advance(fifo, tail, buffer_size)) != BVR_OK)
+        {
+            // overwritten, try again next time
+            ret_buffer.p_temp_buff = NULL;
+            ret_buffer.buff_size   = 0;
+        }
+        fifo->ctrl.claim = fifo->ctrl.tail;
+        fifo_popped(fifo, ret_buffer.buff_size);
+    }
+    else
+    {
+        ret_buffer.p_temp_buff = NULL; 
+        ret_buffer.buff_size = 0; 
+    }
+
+    return ret_buffer; 
+}
+
+
+BVR_status_t BVR_fifo_peek(fifo_t *fifo, int offset, uint8_t *data, int len)
+{
+    int tail = fifo->ctrl.tail;
+    int head = fifo_load_head(fifo);
+
+    if((offset < 0) || (len < 0) || ((offset + len) > fifo_used(fifo, head, tail)))
+    {
+        return BVR_ERROR;
+    }
+
+    fifo_read(fifo, fifo_index(fifo, fifo_advance(fifo, tail, offset)), data, len);
+    return BVR_OK;
+}
+
+
+BVR_status_t BVR_fifo_skip(fifo_t *fifo, int count)
+{
+    int tail = fifo->ctrl.tail;
+    int head = fifo_load_head(fifo);
+
+    if((count < 0) || (count > fifo_used(fifo, head, tail)))
+    {
+        return BVR_ERROR;
+    }
+
+    if(fifo_store_tail(fifo, tail, fifo_advance(fifo, tail, count)) != BVR_OK)
+    {
+        return BVR_ERROR;
+    }
+
+    fifo->ctrl.claim = fifo->ctrl.tail;
+    fifo_popped(fifo, count);
+    return BVR_OK;
+}
+
+
+int BVR_fifo_find(fifo_t *fifo, int offset, uint8_t value)
+{
+    int tail  = fifo->ctrl.tail;
+    int head  = fifo_load_head(fifo);
+    int level = fifo_used(fifo, head, tail);
+    int index;
+    int first;
+    uint8_t *found;
+
+    if((offset < 0) || (offset >= level))
+    {
+        return -1;
+    }
+
+    // up to the end of the buffer first then from the start
+    index = fifo_index(fifo, fifo_advance(fifo, tail, offset));
+    first = fifo->ctrl.depth - index;
+    if(first > (level - offset)){first = level - offset;}
+
+    found = memchr(fifo->p_buffer + index, value, first);
+    if(found != NULL)
+    {
+        return offset + (int)(found - (fifo->p_buffer + index));
+    }
+
+    found = memchr(fifo->p_buffer, value, level - offset - first);
+    if(found != NULL)
+    {
+        return offset + first + (int)(found - fifo->p_buffer);
+    }
+
+    return -1;
+}
+
+
+temp_buffer_t BVR_fifo_claim(fifo_t *fifo)
+{
+    int claim = fifo->ctrl.claim;
+    int head  = fifo_load_head(fifo);
+    int level = fifo_used(fifo, head, claim);
+    int index = fifo_index(fifo, claim);
+    temp_buffer_t ret_buffer;
+
+    FIFO_STATS_POP(fifo);
+
+    // only up to the end of the buffer
+    if(level > (fifo->ctrl.depth - index)){level = fifo->ctrl.depth - index;}
+
+    // an overwrite can move the tail under a claimed span, nothing to hand out
+    if(fifo->ctrl.policy == FIFO_OVERWRITE){level = 0;}
+
+    if(level > 0)
+    {
+        ret_buffer.p_temp_buff = fifo->p_buffer + index;
+        ret_buffer.buff_size   = level;
+        // tail is not moved, the space still belongs to the dma
+        fifo->ctrl.claim = fifo_advance(fifo, claim, level);
+    }
+    else
+    {
+        ret_buffer.p_temp_buff = NULL;
+        ret_buffer.buff_size   = 0;
+    }
+
+    return ret_buffer;
+}
+
+
+BVR_status_t BVR_fifo_release(fifo_t *fifo, int size)
+{
+    int tail = fifo->ctrl.tail;
+
+    // can not release more than has been claimed
+    if((fifo->ctrl.policy == FIFO_OVERWRITE) || (size < 0) ||
+       (size > fifo_used(fifo, fifo->ctrl.claim, tail)))
+    {
+        return BVR_ERROR;
+    }
+
+    // dma has finished reading, give the space back to the producer
+    BVR_STORE_RELEASE(&fifo->ctrl.tail, fifo_advance(fifo, tail, size));
+    fifo_popped(fifo, size);
+    return BVR_OK;
+}
+
+
+void BVR_fifo_unclaim(fifo_t *fifo)
+{
+    // everything claimed and not released is handed out again
+    fifo->ctrl.claim = fifo->ctrl.tail;
+}
+
+
+temp_buffer_t BVR_fifo_reserve(fifo_t *fifo, int max_len)
+{
+    int head  = fifo->ctrl.head;
+    int tail  = BVR_LOAD_ACQUIRE(&fifo->ctrl.tail);
+    int space = fifo->ctrl.depth - fifo_used(fifo, head, tail);
+    int index = fifo_index(fifo, head);
+    temp_buffer_t ret_buffer;
+
+    // no span is handed out from a multi producer fifo
+    if(fifo->ctrl.mp){space = 0;}
+
+    // free space can only be used up to the end of the buffer
+    if(space > (fifo->ctrl.depth - index)){space = fifo->ctrl.depth - index;}
+    if(space > max_len){space = max_len;}
+
+    ret_buffer.p_temp_buff = (space > 0) ? (fifo->p_buffer + index) : NULL;
+    ret_buffer.buff_size   = space;
+
+    return ret_buffer;
+}
+
+
+BVR_status_t BVR_fifo_commit(fifo_t *fifo, int used_len)
+{
+    int head  = fifo->ctrl.head;
+    int tail  = BVR_LOAD_ACQUIRE(&fifo->ctrl.tail);
+    int space = fifo->ctrl.depth - fifo_used(fifo, head, tail);
+    int index = fifo_index(fifo, head);
+
+    if(fifo->ctrl.mp || (used_len < 0) || (used_len > space) || (used_len > (fifo->ctrl.depth - index)))
+    {
+        return BVR_ERROR;
+    }
+
+    // data must be written before the consumer sees the new head
+    BVR_STORE_RELEASE(&fifo->ctrl.head, fifo_advance(fifo, head, used_len));
+    fifo_pushed(fifo, used_len);
+    return BVR_OK;
+}
+
+
+BVR_status_t BVR_fifo_set_policy(fifo_t *fifo, fifo_policy_t policy, uint32_t timeout_ms)
+{
+    // overwrite moves the tail which a multi producer fifo can not allow
+    if((policy > FIFO_BLOCK) || ((policy == FIFO_OVERWRITE) && fifo->ctrl.mp))
+    {
+        return BVR_ERROR;
+    }
+
+    fifo->ctrl.policy     = policy;
+    fifo->ctrl.timeout_ms = timeout_ms;
+    return BVR_OK;
+}
+
+
+BVR_status_t BVR_fifo_set_marks(fifo_t *fifo, int high, int low,
+                                fifo_mark_cb_t callback, void *ctx)
+{
+    if((high < 0) || (high > fifo->ctrl.depth) || ((high > 0) && ((low < 0) || (low >= high))))
+    {
+        return BVR_ERROR;
+    }
+
+    // turn off first so a push or pop never sees half the new marks
+    fifo->ctrl.on_mark   = NULL;
+    fifo->ctrl.high_mark = high;
+    fifo->ctrl.low_mark  = low;
+    fifo->ctrl.mark_ctx  = ctx;
+    fifo->ctrl.above     = 0x00;
+    BVR_STORE_RELEASE(&fifo->ctrl.on_mark, (high > 0) ? callback : NULL);
+    return BVR_OK;
+}
+
+
+#if BVR_FIFO_RTOS
+static void fifo_mark_notify(fifo_t *fifo, fifo_mark_t mark, void *ctx)
+{
+    (void)fifo;
+    fifo_task_notify(ctx, (mark == FIFO_MARK_HIGH) ? FIFO_NOTIFY_HIGH : FIFO_NOTIFY_LOW);
+}
+
+
+BVR_status_t BVR_fifo_notify_task(fifo_t *fifo, int high, int low, void *task)
+{
+    if(task == NULL)
+    {
+        return BVR_ERROR;
+    }
+
+    return BVR_fifo_set_marks(fifo, high, low, fifo_mark_notify, task);
+}
+#endif
+
+
+void BVR_fifo_get_drops(fifo_t *fifo, uint32_t *msgs, uint32_t *bytes)
+{
+    if(msgs != NULL){*msgs = BVR_LOAD_ACQUIRE(&fifo->ctrl.dropped_msgs);}
+    if(bytes != NULL){*bytes = BVR_LOAD_ACQUIRE(&fifo->ctrl.dropped_bytes);}
+}
+
+
+#if BVR_FIFO_STATS
+void BVR_fifo_register(fifo_t *fifo, const char *name)
+{
+    fifo_t *entry;
+
+    fifo->ctrl.stats.name = name;
+
+    // only add once
+    for(entry = fifo_registry; entry != NULL; entry = entry->ctrl.stats.next)
+    {
+        if(entry == fifo){return;}
+    }
+
+    fifo->ctrl.stats.next = fifo_registry;
+    fifo_registry = fifo;
+}
+
+
+void BVR_fifo_dump_stats(void)
+{
+    fifo_t *entry;
+    fifo_stats_t *stats;
+    uint32_t elapsed;
+
+    for(entry = fifo_registry; entry != NULL; entry = entry->ctrl.stats.next)
+    {
+        stats   = &entry->ctrl.stats;
+        elapsed = BVR_FIFO_TICK() - stats->start_tick;
+
+        BVR_LOG(INFO, "FIFO %s depth %d level %d high %d", stats->name,
+                entry->ctrl.depth, BVR_fifo_level(entry), stats->high_water);
+        BVR_LOG(INFO, "\tin %lu out %lu fails %lu full max %lums pops/s %lu",
+                (unsigned long)stats->bytes_in, (unsigned long)stats->bytes_out,
+                (unsigned long)stats->push_fails, (unsigned long)stats->longest_full,
+                (unsigned long)((elapsed > 0) ? ((uint64_t)stats->pop_calls * 1000 / elapsed) : 0));
+    }
+}
+#endif
+
+
+int BVR_fifo_level(fifo_t *fifo)
+{
+    int head = fifo_load_head(fifo);
+    int tail = BVR_LOAD_ACQUIRE(&fifo->ctrl.tail);
+
+    return fifo_used(fifo, head, tail);
+}
+
+
+int BVR_fifo_space(fifo_t *fifo)
+{
+    return fifo->ctrl.depth - BVR_fifo_level(fifo);
+}
+
+
+
+/******************************************************************************/
+/*                              BIP BUFFER                                    */
+/******************************************************************************/
+/*
+ * Two regions, the producer writes after the second region until the end of
+ * the buffer is too short then wraps to the start and marks where the old
+ * data ended with last. The consumer reads up to last then jumps to 0.
+ * write == read is always empty so a wrapped write stops one byte short.
+ */
+
+BVR_status_t BVR_bip_init(bip_fifo_t *bip, uint8_t buffer[], int depth)
+{
+    if((buffer != NULL) && (depth > 0))
+    {
+        bip->p_buffer      = buffer;
+        bip->ctrl.depth    = depth;
+        bip->ctrl.write    = 0x00;
+        bip->ctrl.read     = 0x00;
+        bip->ctrl.last     = depth;
+        bip->ctrl.reserve  = 0x00;
+        return BVR_OK;
+    }
+
+    return BVR_ERROR;
+}
+
+
+temp_buffer_t BVR_bip_reserve(bip_fifo_t *bip, int size)
+{
+    int write = bip->ctrl.write;
+    int read  = BVR_LOAD_ACQUIRE(&bip->ctrl.read);
+    int start = -1;
+    temp_buffer_t ret_buffer;
+
+    if(write < read)
+    {
+        // already wrapped, must stay behind read
+        if((write + size) < read){start = write;}
+    }
+    else if((write + size) <= bip->ctrl.depth)
+    {
+        start = write;
+    }
+    else if(size < read)
+    {
+        // end is too short, wrap to the start
+        start = 0;
+    }
+
+    if((size <= 0) || (start < 0))
+    {
+        ret_buffer.p_temp_buff = NULL;
+        ret_buffer.buff_size   = 0;
+        return ret_buffer;
+    }
+
+    bip->ctrl.reserve      = start;
+    ret_buffer.p_temp_buff = bip->p_buffer + start;
+    ret_buffer.buff_size   = size;
+    return ret_buffer;
+}
+
+
+BVR_status_t BVR_bip_commit(bip_fifo_t *bip, int used_len)
+{
+    int write     = bip->ctrl.write;
+    int new_write = bip->ctrl.reserve + used_len;
+
+    if((used_len < 0) || (new_write > bip->ctrl.depth))
+    {
+        return BVR_ERROR;
+    }
+
+    if(used_len == 0){return BVR_OK;}
+
+    if((new_write < write) && (write != bip->ctrl.depth))
+    {
+        // wrapped, data ends at the old write
+        BVR_STORE_RELEASE(&bip->ctrl.last, write);
+    }
+    else if(new_write > bip->ctrl.last)
+    {
+        // passed the old end, open up the rest of the buffer
+        BVR_STORE_RELEASE(&bip->ctrl.last, bip->ctrl.depth);
+    }
+
+    BVR_STORE_RELEASE(&bip->ctrl.write, new_write);
+    return BVR_OK;
+}
+
+
+BVR_status_t BVR_bip_push(bip_fifo_t *bip, uint8_t *data, int buffer_size)
+{
+    temp_buffer_t span = BVR_bip_reserve(bip, buffer_size);
+
+    if(span.p_temp_buff == NULL)
+    {
+        return BVR_ERROR;
+    }
+
+    memcpy(span.p_temp_buff, data, buffer_size);
+    return BVR_bip_commit(bip, buffer_size);
+}
+
+
+temp_buffer_t BVR_bip_read(bip_fifo_t *bip)
+{
+    int read  = bip->ctrl.read;
+    int write = BVR_LOAD_ACQUIRE(&bip->ctrl.write);
+    int last  = BVR_LOAD_ACQUIRE(&bip->ctrl.last);
+    int end;
+    temp_buffer_t ret_buffer;
+
+    // reached the end of the first region, move to the second
+    if((read == last) && (write < read))
+    {
+        read = 0;
+        BVR_STORE_RELEASE(&bip->ctrl.read, read);
+    }
+
+    end = (write < read) ? last : write;
+
+    ret_buffer.p_temp_buff = (end > read) ? (bip->p_buffer + read) : NULL;
+    ret_buffer.buff_size   = end - read;
+    return ret_buffer;
+}
+
+
+BVR_status_t BVR_bip_release(bip_fifo_t *bip, int size)
+{
+    int read = bip->ctrl.read;
+
+    if((size < 0) || ((read + size) > bip->ctrl.depth))
+    {
+        return BVR_ERROR;
+    }
+
+    // data must be read before the producer can reuse the space
+    BVR_STORE_RELEASE(&bip->ctrl.read, read + size);
+    return BVR_OK;
+}
+
+
+
+/******************************************************************************/
+/*                              RECORD FIFO                                   */
+/******************************************************************************/
+
+/* size of the next record, -1 when there is no whole record */
+static int record_next_size(const fifo_t *fifo, int tail, int level)
+{
+    uint8_t header[RECORD_HEADER_SIZE];
+    int size;
+
+    if(level < RECORD_HEADER_SIZE){return -1;}
+
+    fifo_read(fifo, fifo_index(fifo, tail), header, RECORD_HEADER_SIZE);
+    size = header[0] | (header[1] << 8);
+
+    return ((RECORD_HEADER_SIZE + size) <= level) ? size : -1;
+}
+
+
+BVR_status_t BVR_record_init(record_fifo_t *rec, uint8_t buffer[], int depth)
+{
+    return BVR_fifo_init(&rec->fifo, buffer, depth);
+}
+
+
+BVR_status_t BVR_record_push(record_fifo_t *rec, uint8_t *data, int size)
+{
+    fifo_t *fifo = &rec->fifo;
+    int head = fifo->ctrl.head;
+    int tail = BVR_LOAD_ACQUIRE(&fifo->ctrl.tail);
+    uint8_t header[RECORD_HEADER_SIZE];
+
+    if(fifo->ctrl.mp)
+    {
+        return BVR_ERROR;
+    }
+
+    if((size < 0) || (size > RECORD_MAX_SIZE) ||
+       ((fifo->ctrl.depth - fifo_used(fifo, head, tail)) < (RECORD_HEADER_SIZE + size)))
+    {
+        fifo_drop(fifo, size, 1);
+        return BVR_ERROR;
+    }
+
+    header[0] = (uint8_t)(size & 0xFF);
+    header[1] = (uint8_t)(size >> 8);
+
+    fifo_write(fifo, fifo_index(fifo, head), header, RECORD_HEADER_SIZE);
+    head = fifo_advance(fifo, head, RECORD_HEADER_SIZE);
+    fifo_write(fifo, fifo_index(fifo, head), data, size);
+
+    // one head update publishes the whole record
+    BVR_STORE_RELEASE(&fifo->ctrl.head, fifo_advance(fifo, head, size));
+    fifo_pushed(fifo, RECORD_HEADER_SIZE + size);
+    return BVR_OK;
+}
+
+
+BVR_status_t BVR_record_pop(record_fifo_t *rec, uint8_t *data, int buffer_size, int *size)
+{
+    fifo_t *fifo = &rec->fifo;
+    int tail = fifo->ctrl.tail;
+    int head = fifo_load_head(fifo);
+    int record_size = record_next_size(fifo, tail, fifo_used(fifo, head, tail));
+
+    FIFO_STATS_POP(fifo);
+
+    // an overwrite cuts records anywhere and moves the tail under the read
+    if((fifo->ctrl.policy == FIFO_OVERWRITE) || (record_size < 0) || (record_size > buffer_size))
+    {
+        return BVR_ERROR;
+    }
+
+    tail = fifo_advance(fifo, tail, RECORD_HEADER_SIZE);
+    fifo_read(fifo, fifo_index(fifo, tail), data, record_size);
+    tail = fifo_advance(fifo, tail, record_size);
+
+    *size = record_size;
+    fifo->ctrl.claim = tail;
+    BVR_STORE_RELEASE(&fifo->ctrl.tail, tail);
+    fifo_popped(fifo, RECORD_HEADER_SIZE + record_size);
+    return BVR_OK;
+}
+
+
+int BVR_record_pop_batch(record_fifo_t *rec, uint8_t *data, int buffer_size)
+{
+    fifo_t *fifo = &rec->fifo;
+    int tail  = fifo->ctrl.tail;
+    int head  = fifo_load_head(fifo);
+    int level = fifo_used(fifo, head, tail);
+    int total = 0;
+    int record_size;
+
+    FIFO_STATS_POP(fifo);
+
+    if(fifo->ctrl.policy == FIFO_OVERWRITE)
+    {
+        return 0;
+    }
+
+    // find how many whole records fit
+    while((record_size = record_next_size(fifo, fifo_advance(fifo, tail, total), level - total)) >= 0)
+    {
+        if((total + RECORD_HEADER_SIZE + record_size) > buffer_size){break;}
+        total += RECORD_HEADER_SIZE + record_size;
+    }
+
+    if(total > 0)
+    {
+        // one wrap aware copy for the whole batch
+        fifo_read(fifo, fifo_index(fifo, tail), data, total);
+        tail = fifo_advance(fifo, tail, total);
+        fifo->ctrl.claim = tail;
+        BVR_STORE_RELEASE(&fifo->ctrl.tail, tail);
+        fifo_popped(fifo, total);
+    }
+
+    return total;
+}
+
+
+
+/******************************************************************************/
+/*                              ELEMENT QUEUE                                 */
+/******************************************************************************/
+
+/* slot index to slot address */
+static inline uint8_t *queue_slot(elem_queue_t *queue, int index)
+{
+    return queue->slots.p_buffer + (index * queue->elem_size);
+}
+
+
+/* copy count elements into the queue, at most two memcpy either side of the wrap */
+static void queue_write(elem_queue_t *queue, int index, const uint8_t *elems, int count)
+{
+    int first = queue->slots.ctrl.depth - index;
+
+    if(first > count){first = count;}
+
+    memcpy(queue_slot(queue, index), elems, first * queue->elem_size);
+    memcpy(queue->slots.p_buffer, elems + (first * queue->elem_size),
+           (count - first) * queue->elem_size);
+}
+
+
+/* copy count elements out of the queue, at most two memcpy either side of the wrap */
+static void queue_read(elem_queue_t *queue, int index, uint8_t *elems, int count)
+{
+    int first = queue->slots.ctrl.depth - index;
+
+    if(first > count){first = count;}
+
+    memcpy(elems, queue_slot(queue, index), first * queue->elem_size);
+    memcpy(elems + (first * queue->elem_size), queue->slots.p_buffer,
+           (count - first) * queue->elem_size);
+}
+
+
+BVR_status_t BVR_queue_init(elem_queue_t *queue, void *buffer, int elem_size, int depth)
+{
+    if(elem_size <= 0)
+    {
+        return BVR_ERROR;
+    }
+
+    queue->elem_size = elem_size;
+    return BVR_fifo_init(&queue->slots, (uint8_t *)buffer, depth);
+}
+
+
+BVR_status_t BVR_queue_push(elem_queue_t *queue, const void *elems, int count)
+{
+    fifo_t *fifo = &queue->slots;
+    int head = fifo->ctrl.head;
+    int tail = BVR_LOAD_ACQUIRE(&fifo->ctrl.tail);
+
+    if((count < 0) || ((fifo->ctrl.depth - fifo_used(fifo, head, tail)) < count))
+    {
+        fifo_drop(fifo, count * queue->elem_size, 1);
+        return BVR_ERROR;
+    }
+
+    queue_write(queue, fifo_index(fifo, head), (const uint8_t *)elems, count);
+
+    // data must be written before the consumer sees the new head
+    BVR_STORE_RELEASE(&fifo->ctrl.head, fifo_advance(fifo, head, count));
+    fifo_pushed(fifo, count * queue->elem_size);
+    return BVR_OK;
+}
+
+
+BVR_status_t BVR_queue_pop(elem_queue_t *queue, void *elems, int count)
+{
+    fifo_t *fifo = &queue->slots;
+    int tail = fifo->ctrl.tail;
+    int head = BVR_LOAD_ACQUIRE(&fifo->ctrl.head);
+
+    FIFO_STATS_POP(fifo);
+
+    if((count < 0) || (fifo_used(fifo, head, tail) < count))
+    {
+        return BVR_ERROR;
+    }
+
+    queue_read(queue, fifo_index(fifo, tail), (uint8_t *)elems, count);
+
+    // data must be read before the producer can reuse the slots
+    BVR_STORE_RELEASE(&fifo->ctrl.tail, fifo_advance(fifo, tail, count));
+    fifo_popped(fifo, count * queue->elem_size);
+    return BVR_OK;
+}
+
+
+void *BVR_queue_reserve(elem_queue_t *queue)
+{
+    fifo_t *fifo = &queue->slots;
+    int head = fifo->ctrl.head;
+    int tail = BVR_LOAD_ACQUIRE(&fifo->ctrl.tail);
+
+    if(fifo_used(fifo, head, tail) >= fifo->ctrl.depth)
+    {
+        return NULL;
+    }
+
+    return queue_slot(queue, fifo_index(fifo, head));
+}
+
+
+void BVR_queue_commit(elem_queue_t *queue)
+{
+    fifo_t *fifo = &queue->slots;
+
+    BVR_STORE_RELEASE(&fifo->ctrl.head, fifo_advance(fifo, fifo->ctrl.head, 1));
+    fifo_pushed(fifo, queue->elem_size);
+}
+
+
+void *BVR_queue_front(elem_queue_t *queue)
+{
+    fifo_t *fifo = &queue->slots;
+    int tail = fifo->ctrl.tail;
+    int head = BVR_LOAD_ACQUIRE(&fifo->ctrl.head);
+
+    if(fifo_used(fifo, head, tail) == 0)
+    {
+        return NULL;
+    }
+
+    return queue_slot(queue, fifo_index(fifo, tail));
+}
+
+
+void BVR_queue_release(elem_queue_t *queue)
+{
+    fifo_t *fifo = &queue->slots;
+
+    BVR_STORE_RELEASE(&fifo->ctrl.tail, fifo_advance(fifo, fifo->ctrl.tail, 1));
+    fifo_popped(fifo, queue->elem_size);
+}
+
+
+int BVR_queue_level(elem_queue_t *queue)
+{
+    return BVR_fifo_level(&queue->slots);
+}
+
+
+
+/******************************************************************************/
+/*                              DMA COPY                                      */
+/******************************************************************************/
+/*
+ * The head (push) or tail (pop) is held back until the last transfer is
+ * done so the other side never sees a half copied block.
+ */
+
+BVR_status_t BVR_fifo_dma_init(fifo_dma_t *dma, fifo_dma_start_t start, void *engine,
+                               int threshold, fifo_dma_done_t done)
+{
+    if(start == NULL)
+    {
+        return BVR_ERROR;
+    }
+
+    dma->start     = start;
+    dma->engine    = engine;
+    dma->threshold = threshold;
+    dma->done      = done;
+    dma->fifo      = NULL;
+    dma->busy      = 0x00;
+    dma->next_len  = 0x00;
+    return BVR_OK;
+}
+
+
+/* start the first transfer and keep the second for after the wrap, the ring
+   side of the second one starts again at p_buffer not at dst or src + first */
+static BVR_status_t fifo_dma_start(fifo_dma_t *dma, uint8_t *dst, const uint8_t *src,
+                                   int first, int size, uint8_t *next_dst,
+                                   const uint8_t *next_src)
+{
+    dma->next_dst = next_dst;
+    dma->next_src = next_src;
+    dma->next_len = size - first;
+
+    return dma->start(dst, src, first, dma->engine);
+}
+
+
+BVR_status_t BVR_fifo_push_dma(fifo_dma_t *dma, fifo_t *fifo, const uint8_t *data, int size)
+{
+    int head = fifo->ctrl.head;
+    int tail = BVR_LOAD_ACQUIRE(&fifo->ctrl.tail);
+    int index;
+    int first;
+
+    if(fifo->ctrl.mp)
+    {
+        return BVR_ERROR;
+    }
+
+    if(dma->busy)
+    {
+        return BVR_BUSY;
+    }
+
+    if(size < dma->threshold)
+    {
+        if(BVR_fifo_push(fifo, (uint8_t *)data, size) != BVR_OK){return BVR_ERROR;}
+        if(dma->done != NULL){dma->done(fifo, size);}
+        return BVR_OK;
+    }
+
+    if((fifo->ctrl.depth - fifo_used(fifo, head, tail)) < size)
+    {
+        fifo_drop(fifo, size, 1);
+        return BVR_ERROR;
+    }
+
+    index = fifo_index(fifo, head);
+    first = fifo->ctrl.depth - index;
+    if(first > size){first = size;}
+
+    dma->fifo     = fifo;
+    dma->is_push  = 0x01;
+    dma->size     = size;
+    dma->next_pos = fifo_advance(fifo, head, size);
+    dma->busy     = 0x01;
+
+    if(fifo_dma_start(dma, fifo->p_buffer + index, data, first, size,
+                      fifo->p_buffer, data + first) != BVR_OK)
+    {
+        // engine refused, copy with the CPU
+        dma->next_len = 0x00;
+        fifo_write(fifo, index, data, size);
+        BVR_fifo_dma_complete(dma);
+    }
+
+    return BVR_OK;
+}
+
+
+BVR_status_t BVR_fifo_pop_dma(fifo_dma_t *dma, fifo_t *fifo, uint8_t *data, int size)
+{
+    int tail = fifo->ctrl.tail;
+    int head = fifo_load_head(fifo);
+    int index;
+    int first;
+
+    // the tail is held until the copy is done, an overwrite would move it
+    if(fifo->ctrl.policy == FIFO_OVERWRITE)
+    {
+        return BVR_ERROR;
+    }
+
+    if(dma->busy)
+    {
+        return BVR_BUSY;
+    }
+
+    if(size < dma->threshold)
+    {
+        if(BVR_fifo_pop(fifo, data, size) != BVR_OK){return BVR_ERROR;}
+        if(dma->done != NULL){dma->done(fifo, size);}
+        return BVR_OK;
+    }
+
+    if(fifo_used(fifo, head, tail) < size)
+    {
+        return BVR_ERROR;
+    }
+
+    index = fifo_index(fifo, tail);
+    first = fifo->ctrl.depth - index;
+    if(first > size){first = size;}
+
+    dma->fifo     = fifo;
+    dma->is_push  = 0x00;
+    dma->size     = size;
+    dma->next_pos = fifo_advance(fifo, tail, size);
+    dma->busy     = 0x01;
+
+    if(fifo_dma_start(dma, data, fifo->p_buffer + index, first, size,
+                      data + first, fifo->p_buffer) != BVR_OK)
+    {
+        // engine refused, copy with the CPU
+        dma->next_len = 0x00;
+        fifo_read(fifo, index, data, size);
+        BVR_fifo_dma_complete(dma);
+    }
+
+    return BVR_OK;
+}
+
+
+void BVR_fifo_dma_complete(fifo_dma_t *dma)
+{
+    fifo_t *fifo = dma->fifo;
+    int len = dma->next_len;
+
+    if(!dma->busy)
+    {
+        return;
+    }
+
+    if(len > 0)
+    {
+        // second transfer from the start of the buffer
+        dma->next_len = 0x00;
+        if(dma->start(dma->next_dst, dma->next_src, len, dma->engine) == BVR_OK)
+        {
+            return;
+        }
+        memcpy(dma->next_dst, dma->next_src, len);
+    }
+
+    if(dma->is_push)
+    {
+        BVR_STORE_RELEASE(&fifo->ctrl.head, dma->next_pos);
+        fifo_pushed(fifo, dma->size);
+    }
+    else
+    {
+        fifo->ctrl.claim = dma->next_pos;
+        BVR_STORE_RELEASE(&fifo->ctrl.tail, dma->next_pos);
+        fifo_popped(fifo, dma->size);
+    }
+
+    dma->busy = 0x00;
+    if(dma->done != NULL){dma->done(fifo, dma->size);}
+}
+
+
+#if BVR_FIFO_DMA
+BVR_status_t BVR_fifo_dma_hal_start(void *dst, const void *src, int size, void *engine)
+{
+    DMA_HandleTypeDef *hdma = (DMA_HandleTypeDef *)engine;
+
+    if(HAL_DMA_Start_IT(hdma, (uint32_t)src, (uint32_t)dst, size) == HAL_OK)
+    {
+        return BVR_OK;
+    }
+
+    return BVR_ERROR;
+}
+#endif
+
+
+
+/******************************************************************************/
+/*                              PRIORITY FIFO                                 */
+/******************************************************************************/
+/*
+ * Weighted round robin over the lanes. A lane with data and credit left is
+ * claimed highest first, once no lane with data has credit left every lane
+ * is topped back up to its weight.
+ */
+
+BVR_status_t BVR_prio_init(prio_fifo_t *prio, fifo_t *lanes[], const uint8_t weights[], int count)
+{
+    int lane;
+
+    if((count < 1) || (count > FIFO_PRIO_MAX_LANES))
+    {
+        return BVR_ERROR;
+    }
+
+    for(lane = 0; lane < count; lane++)
+    {
+        if((lanes[lane] == NULL) || (weights[lane] == 0)){return BVR_ERROR;}
+
+        prio->lanes[lane]  = lanes[lane];
+        prio->weight[lane] = weights[lane];
+        prio->credit[lane] = weights[lane];
+    }
+
+    prio->count   = count;
+    prio->active  = -1;
+    prio->wrapped = -1;
+    return BVR_OK;
+}
+
+
+BVR_status_t BVR_prio_push(prio_fifo_t *prio, int lane, uint8_t *data, int size)
+{
+    if((lane < 0) || (lane >= prio->count))
+    {
+        return BVR_ERROR;
+    }
+
+    if(prio->lanes[lane]->ctrl.mp)
+    {
+        return BVR_fifo_push_mp(prio->lanes[lane], data, size);
+    }
+
+    return BVR_fifo_push(prio->lanes[lane], data, size);
+}
+
+
+temp_buffer_t BVR_prio_claim(prio_fifo_t *prio)
+{
+    temp_buffer_t span;
+    int pass;
+    int lane;
+
+    span.p_temp_buff = NULL;
+    span.buff_size   = 0;
+
+    if(prio->active >= 0)
+    {
+        return span;
+    }
+
+    // finish what was pushed across the wrap before any other lane,
+    // it stays marked until released in case the span is handed back
+    lane = prio->wrapped;
+    if(lane >= 0)
+    {
+        span = BVR_fifo_claim(prio->lanes[lane]);
+        if(span.buff_size > 0)
+        {
+            prio->active = lane;
+            return span;
+        }
+        prio->wrapped = -1;
+    }
+
+    for(pass = 0; pass < 2; pass++)
+    {
+        for(lane = 0; lane < prio->count; lane++)
+        {
+            if(prio->credit[lane] == 0){continue;}
+
+            span = BVR_fifo_claim(prio->lanes[lane]);
+            if(span.buff_size > 0)
+            {
+                prio->credit[lane]--;
+                prio->active = lane;
+                if((span.p_temp_buff + span.buff_size) ==
+                   (prio->lanes[lane]->p_buffer + prio->lanes[lane]->ctrl.depth))
+                {
+                    prio->wrapped = lane;
+                }
+                return span;
+            }
+        }
+
+        // every lane with data has had its share, start a new round
+        for(lane = 0; lane < prio->count; lane++)
+        {
+            prio->credit[lane] = prio->weight[lane];
+        }
+    }
+
+    return span;
+}
+
+
+BVR_status_t BVR_prio_release(prio_fifo_t *prio, int size)
+{
+    int lane = prio->active;
+
+    if(lane < 0)
+    {
+        return BVR_ERROR;
+    }
+
+    prio->active = -1;
+    if(BVR_fifo_release(prio->lanes[lane], size) != BVR_OK)
+    {
+        return BVR_ERROR;
+    }
+
+    // a tail back at the start means the lane was sent up to its wrap
+    if((prio->wrapped == lane) && (fifo_index(prio->lanes[lane], prio->lanes[lane]->ctrl.tail) != 0))
+    {
+        prio->wrapped = -1;
+    }
+    return BVR_OK;
+}
+
+
+void BVR_prio_unclaim(prio_fifo_t *prio)
+{
+    int lane = prio->active;
+
+    if(lane < 0)
+    {
+        return;
+    }
+
+    // a wrapped lane keeps its mark so the span goes out first next time
+    BVR_fifo_unclaim(prio->lanes[lane]);
+    prio->active = -1;
+}
+
+
+int BVR_prio_level(prio_fifo_t *prio)
+{
+    int level = 0;
+    int lane;
+
+    for(lane = 0; lane < prio->count; lane++)
+    {
+        level += BVR_fifo_level(prio->lanes[lane]);
+    }
+
+    return level;
+}
+
+
+void BVR_prio_get_drops(prio_fifo_t *prio, uint32_t *msgs, uint32_t *bytes)
+{
+    uint32_t total_msgs  = 0;
+    uint32_t total_bytes = 0;
+    uint32_t lane_msgs;
+    uint32_t lane_bytes;
+    int lane;
+
+    for(lane = 0; lane < prio->count; lane++)
+    {
+        BVR_fifo_get_drops(prio->lanes[lane], &lane_msgs, &lane_bytes);
+        total_msgs  += lane_msgs;
+        total_bytes += lane_bytes;
+    }
+
+    if(msgs != NULL){*msgs = total_msgs;}
+    if(bytes != NULL){*bytes = total_bytes;}
+}
+
+
+
+/******************************************************************************/
+/*                              POINTER QUEUE                                 */
+/******************************************************************************/
+/*
+ * Whole buffers move between contexts as one pointer. The spsc queue is the
+ * fifo_t scheme with free running positions. The mpmc queue reserves a run
+ * of positions with one compare and swap once every slot in the run is
+ * ready, then publishes each slot through its sequence.
+ */
+
+static BVR_status_t ptrq_setup(ptr_queue_t *queue, void *slots[], uint32_t seq[], int depth)
+{
+    uint32_t pos;
+
+    if((slots == NULL) || (depth < 1) || (depth & (depth - 1)))
+    {
+        return BVR_ERROR;
+    }
+
+    queue->p_slots = slots;
+    queue->p_seq   = seq;
+    queue->mask    = (uint32_t)depth - 1;
+    queue->head    = 0x00;
+    queue->tail    = 0x00;
+
+    for(pos = 0; (seq != NULL) && (pos < (uint32_t)depth); pos++)
+    {
+        seq[pos] = pos;
+    }
+
+    return BVR_OK;
+}
+
+
+BVR_status_t BVR_ptrq_init(ptr_queue_t *queue, void *slots[], int depth)
+{
+    return ptrq_setup(queue, slots, NULL, depth);
+}
+
+
+BVR_status_t BVR_ptrq_init_mpmc(ptr_queue_t *queue, void *slots[], uint32_t seq[], int depth)
+{
+    if(seq == NULL)
+    {
+        return BVR_ERROR;
+    }
+
+    return ptrq_setup(queue, slots, seq, depth);
+}
+
+
+/* mpmc, reserve up to count positions whose slots have sequence pos + ready */
+static int ptrq_reserve(ptr_queue_t *queue, uint32_t *cursor, uint32_t ready, int count, uint32_t *start)
+{
+    uint32_t pos = BVR_LOAD_ACQUIRE(cursor);
+    int32_t diff = 0;
+    int run;
+
+    for(;;)
+    {
+        for(run = 0; run < count; run++)
+        {
+            diff = (int32_t)(BVR_LOAD_ACQUIRE(&queue->p_seq[(pos + run) & queue->mask]) - (pos + run + ready));
+            if(diff != 0){break;}
+        }
+
+        if(run == 0)
+        {
+            // behind means full (push) or empty (pop), ahead means pos is stale
+            if(diff < 0){return 0;}
+            pos = BVR_LOAD_ACQUIRE(cursor);
+            continue;
+        }
+
+        if(BVR_COMPARE_EXCHANGE(cursor, &pos, pos + run))
+        {
+            *start = pos;
+            return run;
+        }
+    }
+}
+
+
+int BVR_ptrq_push_batch(ptr_queue_t *queue, void *const items[], int count)
+{
+    uint32_t head;
+    uint32_t tail;
+    int index;
+
+    if(count <= 0)
+    {
+        return 0;
+    }
+
+    if(queue->p_seq == NULL)
+    {
+        head = queue->head;
+        tail = BVR_LOAD_ACQUIRE(&queue->tail);
+        if(count > (int)(queue->mask + 1 - (head - tail))){count = queue->mask + 1 - (head - tail);}
+
+        for(index = 0; index < count; index++)
+        {
+            queue->p_slots[(head + index) & queue->mask] = items[index];
+        }
+
+        // pointers must be written before the consumer sees the new head
+        BVR_STORE_RELEASE(&queue->head, head + count);
+        return count;
+    }
+
+    count = ptrq_reserve(queue, &queue->head, 0, count, &head);
+    for(index = 0; index < count; index++)
+    {
+        queue->p_slots[(head + index) & queue->mask] = items[index];
+        BVR_STORE_RELEASE(&queue->p_seq[(head + index) & queue->mask], head + index + 1);
+    }
+
+    return count;
+}
+
+
+int BVR_ptrq_pop_batch(ptr_queue_t *queue, void *items[], int max)
+{
+    uint32_t tail;
+    uint32_t head;
+    int index;
+
+    if(max <= 0)
+    {
+        return 0;
+    }
+
+    if(queue->p_seq == NULL)
+    {
+        tail = queue->tail;
+        head = BVR_LOAD_ACQUIRE(&queue->head);
+        if(max > (int)(head - tail)){max = head - tail;}
+
+        for(index = 0; index < max; index++)
+        {
+            items[index] = queue->p_slots[(tail + index) & queue->mask];
+        }
+
+        // pointers must be read before the producer can reuse the slots
+        BVR_STORE_RELEASE(&queue->tail, tail + max);
+        return max;
+    }
+
+    max = ptrq_reserve(queue, &queue->tail, 1, max, &tail);
+    for(index = 0; index < max; index++)
+    {
+        items[index] = queue->p_slots[(tail + index) & queue->mask];
+        // free the slot for the push one lap later
+        BVR_STORE_RELEASE(&queue->p_seq[(tail + index) & queue->mask], tail + index + queue->mask + 1);
+    }
+
+    return max;
+}
+
+
+BVR_status_t BVR_ptrq_push(ptr_queue_t *queue, void *item)
+{
+    return (BVR_ptrq_push_batch(queue, &item, 1) == 1) ? BVR_OK : BVR_ERROR;
+}
+
+
+BVR_status_t BVR_ptrq_pop(ptr_queue_t *queue, void **item)
+{
+    return (BVR_ptrq_pop_batch(queue, item, 1) == 1) ? BVR_OK : BVR_ERROR;
+}
+
+
+int BVR_ptrq_level(ptr_queue_t *queue)
+{
+    uint32_t tail = BVR_LOAD_ACQUIRE(&queue->tail);
+    uint32_t head = BVR_LOAD_ACQUIRE(&queue->head);
+    int level = (int32_t)(head - tail);
+
+    // mpmc positions are read apart so clamp the snapshot
+    if(level < 0){level = 0;}
+    if(level > (int)(queue->mask + 1)){level = queue->mask + 1;}
+    return level;
+}
+
+
+
+/******************************************************************************/
+/*                                UART                                        */
+/******************************************************************************/
+/* 
+ * EXAMPLES For setting up UART 
+ *
+ *
+
+
+void BVR_fifo_uart_init(UART_HandleTypeDef huart, 
+                        DMA_HandelTypeDef dma_rx, 
+                        fifo_t fifo_tx)
+{
+    // set buffers for dma
+    static uint8_t uart_rx_buff[UART_BUFFER_LENGTH]; 
+    static uint8_t uart_tx_buff[UART_BUFFER_LENGTH*8];
+
+    // set dma receive buffers
+    HAL_UART_Receive_DMA(   &huart, 
+                            uart_rx_buff, 
+                            ARRAY_SIZE(uart_rx_buff));
+
+    //disable the interrupts for dma
+    __HAL_DMA_DISABLE_IT(&dam_rx, DMA_IT_TC | DMA_IT_HT | DMA_IT_TE);
+
+
+    //set the tx buffers
+    BVR_fifo_init(  &fifo_tx, 
+                    (uint8_t*) uart_tx_buff,
+                    sizeof(uart_tx_buff));
+
+}
+
+
+void BVR_fifo_uart_get(  UART_HandleTypeDef *huart, 
+                    char data[],
+                    int data_len)
+{
+
+    // set 
+    volatile size_t head;
+    volatile size_t tail;
+
+    char temp_byte; 
+    char *p_output_buffer;
+
+    // set the positions for read and write 
+    head = huart->RxXferCount;
+    tail = (UART_BUFFER_LENGTH) - (huart->hdmarx->Instance->NDTR);
+
+    for(p_output_buffer = data, data_len--; data_len > 0; data_len--)
+    {
+        if(head != tail)
+        { 
+            // get byte from uart
+            temp_byte = huart->pRxBuffPtr[head++];        
+
+            // head check 
+            if(head >= UART_BUFFER_LENGTH){head = 0;}
+
+            // check for end of line 
+            if((temp_byte == '\n') | (temp_byte == '\r'))
+            {
+                // store head position of uart
+                huart->RxXferCount = head;
+                // null terminate the string 
+                p_output_buffer =  '\0'; 
+                // get out of here
+                return;
+            }
+            else if(temp_byte == '\b')
+            {
+                // decrement if backspace 
+                p_output_buffer--; 
+            }
+            else if(temp_byte == '\x1B')
+            {
+                // erase previous character if special key found 
+                p_output_buffer = data;
+            }
+            else if(isprint(temp_byte))
+            {
+                *p_output_buffer++ = temp_byte;
+            }
+        } 
+        else 
+        { 
+            // no data in the buffer
+            break;
+        }
+    }
+
+    // if we are here then data exceeded the max length or is 0
+    *p_output_buffer = '\0';
+}
+
+
+void BVR_fifo_uart_flush(UART_HandleTypeDef *huart)
+{
+    // set head and tail for function    
+    volatile size_t head = 0; 
+    volatile size_t tail = 0;
+
+    // update positions for buffers
+    tail = (UART_BUFFER_LENGTH) - (huart->hdmarx->Instance->NDTR);
+    head = tail;
+
+    // head check 
+    if(head >= UART_BUFFER_LENGTH){head = 0;}
+
+    // store new head postion 
+    huart->RxXferCount = head; 
+}
+
+
+
+BVR_status_t BVR_fifo_uart_send(fifo_t fifo_tx, 
+                                UART_HandleTypeDef huart, 
+                                uint8_t *p_data, 
+                                int size)
+{ 
+    if(BVR_fifo_push(&fifo_tx, (uint8_t*) p_data, size) == FIFO_SUCCESS)
+    {
+        if(huart.gState == HAL_UART_STATE_READY)
+        {
+            volatile temp_buffer_t dma_temp;
+            dma_temp = BVR_fifo_pop_from_temp(&uart_tx_fifo); 
+            HAL_UART_Transmit_DMA(  &huart, 
+                                    dma_temp.p_temp_buff, 
+                                    dma_temp.buff_size);
+            return BVR_OK; 
+        }
+
+        return BVR_ERROR; 
+    } 
+
+    return BVR_ERROR;
+}
+
+*/
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
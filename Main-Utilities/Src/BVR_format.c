@@ -0,0 +1,412 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     BVR_format.c
+* @brief    bounded printf style formatter
+* @version  V0.1
+* @target   STM32
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Refer to header file for more information
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+
+#include "BVR_format.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+/* conversion flags */
+#define FMT_LEFT    0x01    /**< - left justify */
+#define FMT_PLUS    0x02    /**< + always print the sign */
+#define FMT_SPACE   0x04    /**< space in place of + */
+#define FMT_ALT     0x08    /**< # 0x for hex, leading 0 for octal */
+#define FMT_ZERO    0x10    /**< 0 pad with zeros */
+#define FMT_UPPER   0x20    /**< X */
+
+/* output so far, characters past size are counted but not written */
+typedef struct
+{
+    char *buf;
+    size_t size;
+    size_t len;
+}fmt_out_t;
+
+/*--GLOBAL--CONSTANTS---------------------------------------------------------*/
+
+static const char fmt_digits[] = "0123456789abcdef0123456789ABCDEF";
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+static inline void fmt_put(fmt_out_t *out, char c)
+{
+    if((out->len + 1) < out->size){out->buf[out->len] = c;}
+    out->len++;
+}
+
+
+static void fmt_fill(fmt_out_t *out, char c, int count)
+{
+    while(count-- > 0){fmt_put(out, c);}
+}
+
+
+static void fmt_string(fmt_out_t *out, const char *str, int width, int precision, int flags)
+{
+    int len = 0;
+    int index;
+
+    if(str == NULL){str = "(null)";}
+
+    // precision limits how much of the string is read
+    while(((precision < 0) || (len < precision)) && str[len]){len++;}
+
+    if(!(flags & FMT_LEFT)){fmt_fill(out, ' ', width - len);}
+    for(index = 0; index < len; index++){fmt_put(out, str[index]);}
+    if(flags & FMT_LEFT){fmt_fill(out, ' ', width - len);}
+}
+
+
+/* digits of value in base into the end of tmp, returns the count.
+ * 32 bit values stay on the 32 bit divide */
+static int fmt_digits_of(char *end, uint64_t value, unsigned base, int flags)
+{
+    const char *digits = fmt_digits + ((flags & FMT_UPPER) ? 16 : 0);
+    uint32_t small;
+    int count = 0;
+
+    while(value > UINT32_MAX)
+    {
+        *--end = digits[value % base];
+        value /= base;
+        count++;
+    }
+
+    for(small = (uint32_t)value; small != 0; small /= base)
+    {
+        *--end = digits[small % base];
+        count++;
+    }
+
+    return count;
+}
+
+
+static void fmt_integer(fmt_out_t *out, uint64_t value, int negative, unsigned base,
+                        int width, int precision, int flags)
+{
+    char tmp[24];
+    char prefix[2] = {0, 0};
+    int prefix_len = 0;
+    int digits;
+    int zeros;
+    int pad;
+
+    digits = fmt_digits_of(tmp + sizeof(tmp), value, base, flags);
+
+    if(negative)                {prefix[prefix_len++] = '-';}
+    else if(flags & FMT_PLUS)   {prefix[prefix_len++] = '+';}
+    else if(flags & FMT_SPACE)  {prefix[prefix_len++] = ' ';}
+
+    if((flags & FMT_ALT) && (base == 16) && (value != 0))
+    {
+        prefix[0] = '0';
+        prefix[1] = (flags & FMT_UPPER) ? 'X' : 'x';
+        prefix_len = 2;
+    }
+
+    // a precision turns off the 0 flag, 0 with precision 0 prints nothing
+    if(precision < 0)
+    {
+        precision = 1;
+    }
+    else
+    {
+        flags &= ~FMT_ZERO;
+    }
+
+    zeros = (precision > digits) ? (precision - digits) : 0;
+    if((flags & FMT_ALT) && (base == 8) && (zeros == 0) && ((digits == 0) || (value != 0)))
+    {
+        zeros = 1;
+    }
+
+    pad = width - prefix_len - zeros - digits;
+    if((flags & FMT_ZERO) && !(flags & FMT_LEFT))
+    {
+        zeros += (pad > 0) ? pad : 0;
+        pad = 0;
+    }
+
+    if(!(flags & FMT_LEFT)){fmt_fill(out, ' ', pad);}
+    if(prefix_len > 0){fmt_put(out, prefix[0]);}
+    if(prefix_len > 1){fmt_put(out, prefix[1]);}
+    fmt_fill(out, '0', zeros);
+    for(; digits > 0; digits--){fmt_put(out, tmp[sizeof(tmp) - digits]);}
+    if(flags & FMT_LEFT){fmt_fill(out, ' ', pad);}
+}
+
+
+#if BVR_FORMAT_FLOAT
+/* fixed point only, precision is capped at 9 digits */
+static void fmt_float(fmt_out_t *out, double value, int width, int precision, int flags)
+{
+    char tmp[48];
+    uint64_t whole;
+    uint32_t frac;
+    uint32_t scale = 1;
+    int negative = (value < 0) || ((value == 0) && (1 / value < 0));
+    int len = 0;
+    int digits;
+    int index;
+
+    if(value != value)
+    {
+        fmt_string(out, (flags & FMT_UPPER) ? "NAN" : "nan", width, -1, flags & FMT_LEFT);
+        return;
+    }
+
+    if(negative){value = -value;}
+    if(precision < 0){precision = 6;}
+    if(precision > 9){precision = 9;}
+    for(index = 0; index < precision; index++){scale *= 10;}
+
+    // round at the last digit, anything past 64 bits prints as inf
+    value += 0.5 / scale;
+    if(value >= 18446744073709551616.0)
+    {
+        fmt_string(out, negative ? ((flags & FMT_UPPER) ? "-INF" : "-inf")
+                                 : ((flags & FMT_UPPER) ? "INF" : "inf"),
+                   width, -1, flags & FMT_LEFT);
+        return;
+    }
+
+    whole = (uint64_t)value;
+    frac  = (uint32_t)((value - (double)whole) * scale);
+    if(frac >= scale){frac = scale - 1;}
+
+    if(negative)                {tmp[len++] = '-';}
+    else if(flags & FMT_PLUS)   {tmp[len++] = '+';}
+    else if(flags & FMT_SPACE)  {tmp[len++] = ' ';}
+
+    digits = fmt_digits_of(tmp + 24, whole, 10, 0);
+    if(digits == 0){tmp[23] = '0'; digits = 1;}
+    for(index = 24 - digits; index < 24; index++){tmp[len++] = tmp[index];}
+
+    if((precision > 0) || (flags & FMT_ALT)){tmp[len++] = '.';}
+    for(index = precision; index > 0; index--)
+    {
+        tmp[len + index - 1] = (char)('0' + (frac % 10));
+        frac /= 10;
+    }
+    len += precision;
+
+    if((flags & FMT_ZERO) && !(flags & FMT_LEFT) && (width > len))
+    {
+        // zeros go after the sign
+        index = (tmp[0] == '-') || (tmp[0] == '+') || (tmp[0] == ' ');
+        if(index){fmt_put(out, tmp[0]);}
+        fmt_fill(out, '0', width - len);
+        for(; index < len; index++){fmt_put(out, tmp[index]);}
+        return;
+    }
+
+    tmp[len] = '\0';
+    fmt_string(out, tmp, width, -1, flags & FMT_LEFT);
+}
+#endif
+
+
+int BVR_vsnprintf(char *buf, size_t size, const char *fmt, va_list args)
+{
+    fmt_out_t out;
+    uint64_t value;
+    int64_t signed_value;
+    int flags;
+    int width;
+    int precision;
+    char length;
+    char c;
+
+    out.buf  = buf;
+    out.size = (buf != NULL) ? size : 0;
+    out.len  = 0;
+
+    while((c = *fmt++) != '\0')
+    {
+        if(c != '%')
+        {
+            fmt_put(&out, c);
+            continue;
+        }
+
+        // flags
+        flags = 0;
+        for(;; fmt++)
+        {
+            if(*fmt == '-')         {flags |= FMT_LEFT;}
+            else if(*fmt == '+')    {flags |= FMT_PLUS;}
+            else if(*fmt == ' ')    {flags |= FMT_SPACE;}
+            else if(*fmt == '#')    {flags |= FMT_ALT;}
+            else if(*fmt == '0')    {flags |= FMT_ZERO;}
+            else                    {break;}
+        }
+
+        // width
+        width = 0;
+        if(*fmt == '*')
+        {
+            width = va_arg(args, int);
+            if(width < 0){flags |= FMT_LEFT; width = -width;}
+            fmt++;
+        }
+        while((*fmt >= '0') && (*fmt <= '9')){width = (width * 10) + (*fmt++ - '0');}
+
+        // precision, negative is the same as none
+        precision = -1;
+        if(*fmt == '.')
+        {
+            fmt++;
+            precision = 0;
+            if(*fmt == '*')
+            {
+                precision = va_arg(args, int);
+                if(precision < 0){precision = -1;}
+                fmt++;
+            }
+            while((*fmt >= '0') && (*fmt <= '9')){precision = (precision * 10) + (*fmt++ - '0');}
+        }
+
+        // length, H for hh and q for ll
+        length = 0;
+        if((*fmt == 'h') || (*fmt == 'l'))
+        {
+            length = *fmt++;
+            if(*fmt == length){length = (length == 'h') ? 'H' : 'q'; fmt++;}
+        }
+        else if((*fmt == 'z') || (*fmt == 'j') || (*fmt == 't') || (*fmt == 'L'))
+        {
+            length = *fmt++;
+        }
+
+        c = *fmt++;
+        switch(c)
+        {
+            case 'd':
+            case 'i':
+                if(length == 'q' || length == 'j')  {signed_value = va_arg(args, long long);}
+                else if(length == 'l')              {signed_value = va_arg(args, long);}
+                else if(length == 'z' || length == 't') {signed_value = va_arg(args, ptrdiff_t);}
+                else                                {signed_value = va_arg(args, int);}
+                if(length == 'H')       {signed_value = (signed char)signed_value;}
+                else if(length == 'h')  {signed_value = (short)signed_value;}
+
+                value = (signed_value < 0) ? (0 - (uint64_t)signed_value) : (uint64_t)signed_value;
+                fmt_integer(&out, value, signed_value < 0, 10, width, precision, flags);
+                break;
+
+            case 'u':
+            case 'x':
+            case 'X':
+            case 'o':
+                if(length == 'q' || length == 'j')  {value = va_arg(args, unsigned long long);}
+                else if(length == 'l')              {value = va_arg(args, unsigned long);}
+                else if(length == 'z' || length == 't') {value = va_arg(args, size_t);}
+                else                                {value = va_arg(args, unsigned int);}
+                if(length == 'H')       {value = (unsigned char)value;}
+                else if(length == 'h')  {value = (unsigned short)value;}
+
+                if(c == 'X'){flags |= FMT_UPPER;}
+                flags &= ~(FMT_PLUS | FMT_SPACE);
+                fmt_integer(&out, value, 0, (c == 'u') ? 10 : ((c == 'o') ? 8 : 16),
+                            width, precision, flags);
+                break;
+
+            case 'p':
+                value = (uintptr_t)va_arg(args, void *);
+                fmt_integer(&out, value, 0, 16, width, precision, (flags & FMT_LEFT) | FMT_ALT);
+                break;
+
+            case 'c':
+                if(!(flags & FMT_LEFT)){fmt_fill(&out, ' ', width - 1);}
+                fmt_put(&out, (char)va_arg(args, int));
+                if(flags & FMT_LEFT){fmt_fill(&out, ' ', width - 1);}
+                break;
+
+            case 's':
+                fmt_string(&out, va_arg(args, const char *), width, precision, flags);
+                break;
+
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            #if BVR_FORMAT_FLOAT
+                if((c == 'F') || (c == 'E') || (c == 'G')){flags |= FMT_UPPER;}
+                fmt_float(&out, (length == 'L') ? (double)va_arg(args, long double)
+                                                : va_arg(args, double),
+                          width, precision, flags);
+            #else
+                // still take the argument so the rest line up
+                if(length == 'L'){(void)va_arg(args, long double);}
+                else             {(void)va_arg(args, double);}
+                fmt_put(&out, '?');
+            #endif
+                break;
+
+            case '%':
+                fmt_put(&out, '%');
+                break;
+
+            case '\0':
+                // format ended inside a conversion
+                fmt--;
+                break;
+
+            default:
+                // unknown conversion, print it as written
+                fmt_put(&out, '%');
+                fmt_put(&out, c);
+                break;
+        }
+    }
+
+    if(out.size > 0)
+    {
+        out.buf[(out.len < out.size) ? out.len : (out.size - 1)] = '\0';
+    }
+
+    return (int)out.len;
+}
+
+
+int BVR_snprintf(char *buf, size_t size, const char *fmt, ...)
+{
+    va_list args;
+    int len;
+
+    va_start(args, fmt);
+    len = BVR_vsnprintf(buf, size, fmt, args);
+    va_end(args);
+
+    return len;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
@@ -0,0 +1,712 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     bvr_bench.c
+* @brief    host benchmark suite for Main-Utilities
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Times the fifo push and pop by message size, against the level counter
+*       fifo it replaced and BVR::Fifo (bvr_bench_cpp.cpp) too, the CRC, the
+*       cost of one log line, BVR_snprintf against the C library on the
+*       BVR_power_on_information lines, and counts
+*       uart DMA transfers per KB of log for the fifo and the bip buffer, and prints the results as JSON (default) or CSV so a
+*       run can be kept and compared against the next one.
+*
+*       bvr_bench [--csv] [--quick]
+*
+*       Cycles come from the x86 time stamp counter, measured against the
+*       monotonic clock at start up. It ticks at the nominal clock, so with
+*       turbo or power saving they are nominal cycles, not core cycles. They
+*       are 0 on hosts without one.
+*
+*       Host numbers are only good for comparing two builds on the same PC,
+*       they are not what the MCU will do.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "BVR_fifo_buffer.h"
+#include "BVR_debug_logger.h"
+#include "BVR_format.h"
+#include "BVR_utils.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+#define BENCH_FIFO_DEPTH    2048
+#define BENCH_CRC_SIZE      4096
+#define BENCH_MP_PRODUCERS  4
+#define BENCH_STREAM_MSG    16
+#define BENCH_TX_DEPTH      1024
+#define BENCH_TX_LIGHT      400     /**< uart bytes per line logged, mostly idle */
+#define BENCH_TX_HEAVY      80      /**< uart bytes per line logged, a backlog builds */
+
+/**@struct bench_old_fifo_t
+ * @brief the fifo before the SPSC rewrite, kept to compare against
+ * @details push and pop both write level, so a task and the uart ISR needed
+ *          a critical section around every call
+ */
+typedef struct
+{
+    int depth;          /**< fifo depth */
+    int level;          /**< fifo level */
+    int head;           /**< fifo head */
+    int tail;           /**< fifo tail */
+    uint8_t *p_buffer;  /**< fifo buffer pointer */
+}bench_old_fifo_t;
+
+typedef struct
+{
+    const char *name;       /**< what was timed */
+    int size;               /**< bytes per operation, 0 when it has no size */
+    long iterations;        /**< operations timed */
+    double ns_per_op;       /**< mean time for one operation */
+    double cycles_per_op;   /**< ns_per_op in time stamp counter cycles */
+}bench_result_t;
+
+/**@struct bench_tx_t
+ * @brief uart DMA transfers needed to send a log stream
+ * @details each transfer ends in one TX complete interrupt
+ */
+typedef struct
+{
+    const char *name;   /**< buffer that fed the uart */
+    int rate;           /**< uart bytes sent per line logged */
+    long bytes;         /**< log bytes sent */
+    long transfers;     /**< DMA transfers, one TX complete interrupt each */
+}bench_tx_t;
+
+static bench_result_t bench_results[64];
+static int bench_count = 0;
+static bench_tx_t bench_tx[4];
+
+typedef int (*bench_snprintf_t)(char *buf, size_t size, const char *fmt, ...);
+static int bench_tx_count = 0;
+static long bench_scale = 1;
+static double bench_cycles_per_ns = 0.0;
+
+static const int bench_sizes[] = {4, 8, 16, 32, 64, 128, 256, 512};
+
+extern fifo_t dbg_uart_tx_fifo;
+extern double bench_cpp_fifo(int size, long iterations);
+static volatile int bench_uart_pending = 0;
+static fifo_t bench_mp_fifo;
+static fifo_t bench_stream_fifo;
+static bench_old_fifo_t bench_old_fifo;
+static pthread_mutex_t bench_old_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+static double bench_now_ns(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec * 1e9) + now.tv_nsec;
+}
+
+
+/* time stamp counter ticks per ns, over 50 ms of the monotonic clock */
+static void bench_calibrate(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    double start = bench_now_ns();
+    uint64_t cycles = __rdtsc();
+    double elapsed;
+
+    do
+    {
+        elapsed = bench_now_ns() - start;
+    }while(elapsed < 50e6);
+
+    bench_cycles_per_ns = (double)(__rdtsc() - cycles) / elapsed;
+#endif
+}
+
+
+static void bench_add(const char *name, int size, long iterations, double elapsed_ns)
+{
+    bench_result_t *result = &bench_results[bench_count++];
+
+    result->name          = name;
+    result->size          = size;
+    result->iterations    = iterations;
+    result->ns_per_op     = elapsed_ns / iterations;
+    result->cycles_per_op = result->ns_per_op * bench_cycles_per_ns;
+}
+
+
+/* push then pop one message of each size through a fifo of depth bytes */
+static void bench_fifo(const char *name, int depth, int multi_producer)
+{
+    static uint8_t buffer[BENCH_FIFO_DEPTH];
+    uint8_t message[512];
+    uint8_t out[512];
+    fifo_t fifo;
+    unsigned index;
+    long iterations;
+    long i;
+    double start;
+
+    memset(message, 0x5A, sizeof(message));
+
+    for(index = 0; index < ARRAY_SIZE(bench_sizes); index++)
+    {
+        if(multi_producer){BVR_fifo_init_mp(&fifo, buffer, depth);}
+        else{BVR_fifo_init(&fifo, buffer, depth);}
+
+        iterations = (2000000 / bench_sizes[index]) * bench_scale + 1000;
+        start = bench_now_ns();
+        for(i = 0; i < iterations; i++)
+        {
+            if(multi_producer){BVR_fifo_push_mp(&fifo, message, bench_sizes[index]);}
+            else{BVR_fifo_push(&fifo, message, bench_sizes[index]);}
+            BVR_fifo_pop(&fifo, out, bench_sizes[index]);
+        }
+        bench_add(name, bench_sizes[index], iterations, bench_now_ns() - start);
+    }
+}
+
+
+/* BVR_fifo_push as it was, a byte at a time with a wrap check on each */
+static BVR_status_t bench_old_push(bench_old_fifo_t *fifo, uint8_t *data, int buffer_size)
+{
+    int head = fifo->head;
+    int count;
+
+    if((fifo->depth - fifo->level) < buffer_size){return BVR_ERROR;}
+
+    for(count = 0; count < buffer_size; count++)
+    {
+        fifo->p_buffer[head++] = data[count];
+        if(head >= fifo->depth){head = 0;}
+    }
+
+    fifo->head = head;
+    fifo->level += buffer_size;
+    return BVR_OK;
+}
+
+
+/* BVR_fifo_pop as it was */
+static BVR_status_t bench_old_pop(bench_old_fifo_t *fifo, uint8_t *data, int buffer_size)
+{
+    int tail = fifo->tail;
+    int count;
+
+    if(fifo->level < buffer_size){return BVR_ERROR;}
+
+    for(count = 0; count < buffer_size; count++)
+    {
+        data[count] = fifo->p_buffer[tail++];
+        if(tail >= fifo->depth){tail = 0;}
+    }
+
+    fifo->tail = tail;
+    fifo->level -= buffer_size;
+    return BVR_OK;
+}
+
+
+static void bench_old_init(bench_old_fifo_t *fifo, uint8_t buffer[], int depth)
+{
+    fifo->depth    = depth;
+    fifo->level    = 0;
+    fifo->head     = 0;
+    fifo->tail     = 0;
+    fifo->p_buffer = buffer;
+}
+
+
+/* the same push then pop by size through the old level counter fifo */
+static void bench_fifo_old(void)
+{
+    static uint8_t buffer[BENCH_FIFO_DEPTH];
+    uint8_t message[512];
+    uint8_t out[512];
+    bench_old_fifo_t fifo;
+    unsigned index;
+    long iterations;
+    long i;
+    double start;
+
+    memset(message, 0x5A, sizeof(message));
+
+    for(index = 0; index < ARRAY_SIZE(bench_sizes); index++)
+    {
+        bench_old_init(&fifo, buffer, BENCH_FIFO_DEPTH);
+
+        iterations = (2000000 / bench_sizes[index]) * bench_scale + 1000;
+        start = bench_now_ns();
+        for(i = 0; i < iterations; i++)
+        {
+            bench_old_push(&fifo, message, bench_sizes[index]);
+            bench_old_pop(&fifo, out, bench_sizes[index]);
+        }
+        bench_add("fifo_level_old", bench_sizes[index], iterations, bench_now_ns() - start);
+    }
+}
+
+
+/* the same again through BVR::Fifo<uint8_t, 2048>, capacity known at compile time */
+static void bench_fifo_cpp(void)
+{
+    unsigned index;
+    long iterations;
+
+    for(index = 0; index < ARRAY_SIZE(bench_sizes); index++)
+    {
+        iterations = (2000000 / bench_sizes[index]) * bench_scale + 1000;
+        bench_add("fifo_cpp", bench_sizes[index], iterations,
+                  bench_cpp_fifo(bench_sizes[index], iterations));
+    }
+}
+
+
+static void *bench_old_producer(void *arg)
+{
+    uint8_t message[BENCH_STREAM_MSG];
+    long count = (long)(intptr_t)arg;
+    BVR_status_t status;
+
+    memset(message, 0x5A, sizeof(message));
+    while(count > 0)
+    {
+        pthread_mutex_lock(&bench_old_lock);
+        status = bench_old_push(&bench_old_fifo, message, sizeof(message));
+        pthread_mutex_unlock(&bench_old_lock);
+
+        if(status == BVR_OK){count--;}
+        else{sched_yield();}
+    }
+
+    return NULL;
+}
+
+
+static void *bench_spsc_producer(void *arg)
+{
+    uint8_t message[BENCH_STREAM_MSG];
+    long count = (long)(intptr_t)arg;
+
+    memset(message, 0x5A, sizeof(message));
+    while(count > 0)
+    {
+        if(BVR_fifo_push(&bench_stream_fifo, message, sizeof(message)) == BVR_OK){count--;}
+        else{sched_yield();}
+    }
+
+    return NULL;
+}
+
+
+/* a producer thread and this thread as the consumer, the old fifo behind a
+ * lock the way it had to be shared with the ISR, against the lock free one */
+static void bench_fifo_stream(void)
+{
+    static uint8_t buffer[BENCH_FIFO_DEPTH];
+    pthread_t producer;
+    uint8_t out[BENCH_STREAM_MSG];
+    long total = 400000 * bench_scale + 5000;
+    long popped;
+    BVR_status_t status;
+    double start;
+
+    bench_old_init(&bench_old_fifo, buffer, BENCH_FIFO_DEPTH);
+    popped = 0;
+    start = bench_now_ns();
+    pthread_create(&producer, NULL, bench_old_producer, (void *)(intptr_t)total);
+    while(popped < total)
+    {
+        pthread_mutex_lock(&bench_old_lock);
+        status = bench_old_pop(&bench_old_fifo, out, sizeof(out));
+        pthread_mutex_unlock(&bench_old_lock);
+
+        if(status == BVR_OK){popped++;}
+        else{sched_yield();}
+    }
+    pthread_join(producer, NULL);
+    bench_add("stream_level_old_locked", sizeof(out), total, bench_now_ns() - start);
+
+    BVR_fifo_init(&bench_stream_fifo, buffer, BENCH_FIFO_DEPTH);
+    popped = 0;
+    start = bench_now_ns();
+    pthread_create(&producer, NULL, bench_spsc_producer, (void *)(intptr_t)total);
+    while(popped < total)
+    {
+        if(BVR_fifo_pop(&bench_stream_fifo, out, sizeof(out)) == BVR_OK){popped++;}
+        else{sched_yield();}
+    }
+    pthread_join(producer, NULL);
+    bench_add("stream_spsc", sizeof(out), total, bench_now_ns() - start);
+}
+
+
+static void *bench_mp_producer(void *arg)
+{
+    uint8_t message[16];
+    long count = (long)(intptr_t)arg;
+
+    memset(message, 0x5A, sizeof(message));
+    while(count > 0)
+    {
+        if(BVR_fifo_push_mp(&bench_mp_fifo, message, sizeof(message)) == BVR_OK){count--;}
+        else{sched_yield();}
+    }
+
+    return NULL;
+}
+
+
+/* BENCH_MP_PRODUCERS threads push 16 byte messages while this thread pops */
+static void bench_fifo_mp_contended(void)
+{
+    static uint8_t buffer[BENCH_FIFO_DEPTH];
+    pthread_t producers[BENCH_MP_PRODUCERS];
+    uint8_t out[16];
+    long per_producer = 100000 * bench_scale + 2000;
+    long total = per_producer * BENCH_MP_PRODUCERS;
+    long popped = 0;
+    double start;
+    int i;
+
+    BVR_fifo_init_mp(&bench_mp_fifo, buffer, BENCH_FIFO_DEPTH);
+
+    start = bench_now_ns();
+    for(i = 0; i < BENCH_MP_PRODUCERS; i++)
+    {
+        pthread_create(&producers[i], NULL, bench_mp_producer, (void *)(intptr_t)per_producer);
+    }
+    while(popped < total)
+    {
+        if(BVR_fifo_pop(&bench_mp_fifo, out, sizeof(out)) == BVR_OK){popped++;}
+        else{sched_yield();}
+    }
+    for(i = 0; i < BENCH_MP_PRODUCERS; i++)
+    {
+        pthread_join(producers[i], NULL);
+    }
+    bench_add("fifo_mp_4p", sizeof(out), total, bench_now_ns() - start);
+}
+
+
+static void bench_crc(void)
+{
+    static uint8_t data[BENCH_CRC_SIZE];
+    uint32_t checksum = 0;
+    long iterations = 500 * bench_scale + 10;
+    long i;
+    double start;
+
+    for(i = 0; i < BENCH_CRC_SIZE; i++){data[i] = (uint8_t)(i * 7);}
+
+    start = bench_now_ns();
+    for(i = 0; i < iterations; i++)
+    {
+        BVR_calculate_crc(data, BENCH_CRC_SIZE, &checksum);
+    }
+    bench_add("crc", BENCH_CRC_SIZE, iterations, bench_now_ns() - start);
+
+    // keep the result live
+    if(checksum == 0x12345678){puts("");}
+}
+
+
+/* the uart finishes as soon as it starts, the loop below completes it */
+static void bench_uart_tx(UART_HandleTypeDef *huart, const uint8_t *p_data, uint16_t size)
+{
+    UNUSED(huart);
+    UNUSED(p_data);
+    UNUSED(size);
+    bench_uart_pending = 1;
+}
+
+
+static void bench_log(void)
+{
+    char line[LOG_BUFFER_SIZE];
+    long iterations = 200000 * bench_scale + 1000;
+    long i;
+    double start;
+
+    host_uart_tx_hook = bench_uart_tx;
+    BVR_uart_debug_init();
+
+    start = bench_now_ns();
+    for(i = 0; i < iterations; i++)
+    {
+        BVR_LOG(INFO, "sensor %d read %u mV status %s", (int)i, (unsigned)(i * 3), "ok");
+        while(bench_uart_pending)
+        {
+            bench_uart_pending = 0;
+            BVR_uart_debug_tx_cplt();
+        }
+    }
+    bench_add("log_line", 0, iterations, bench_now_ns() - start);
+
+    start = bench_now_ns();
+    for(i = 0; i < iterations; i++)
+    {
+        BVR_snprintf(line, sizeof(line), "INFO\t: sensor %d read %u mV status %s\r\n",
+                     (int)i, (unsigned)(i * 3), "ok");
+    }
+    bench_add("format_bvr", 0, iterations, bench_now_ns() - start);
+
+    start = bench_now_ns();
+    for(i = 0; i < iterations; i++)
+    {
+        snprintf(line, sizeof(line), "INFO\t: sensor %d read %u mV status %s\r\n",
+                 (int)i, (unsigned)(i * 3), "ok");
+    }
+    bench_add("format_libc", 0, iterations, bench_now_ns() - start);
+}
+
+
+/* the lines BVR_power_on_information logs, as log_print formats them */
+static int bench_power_on(bench_snprintf_t format, char *line, size_t size)
+{
+    static const uint8_t uid[12] = {0x20, 0x38, 0x47, 0x53, 0x50, 0x4E, 0x31, 0x09,
+                                    0x00, 0x2A, 0x00, 0x33};
+    int total = 0;
+
+    total += format(line, size, "STARTUP\t: \r\n\r\n\r\n");
+    total += format(line, size, "STARTUP\t: ********************************************************\r\n");
+    total += format(line, size, "STARTUP\t: \tAPPLICATION STARTED:\t V%d.%d.%d\r\n",
+                    V_MAJOR, V_MINOR, V_PATCH);
+    total += format(line, size, "STARTUP\t: \tSYSTEM RESET CAUSE: \t [%s]\r\n", "POWER ON RESET");
+    total += format(line, size, "STARTUP\t: \tFIRMWARE COMPILE DATE:\t %s\r\n",
+                    "[17.10.26][14:00 Hours]");
+    total += format(line, size, "STARTUP\t: ********************************************************\r\n\r\n");
+    total += format(line, size, "INFO\t: --------------------------------------------------------\r\n");
+    total += format(line, size, "INFO\t: \tU ID:\t\t%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X%02X\r\n",
+                    uid[0], uid[1], uid[2], uid[3], uid[4], uid[5], uid[6],
+                    uid[7], uid[8], uid[9], uid[10], uid[11]);
+    total += format(line, size, "INFO\t: \tDEVICE ID:\t%08X\r\n", 0x10036419u);
+    total += format(line, size, "INFO\t: --------------------------------------------------------\r\n\r\n");
+
+    return total;
+}
+
+
+/* one op is one call, both go through a pointer so neither is folded */
+static void bench_power_on_mix(void)
+{
+    char line[LOG_BUFFER_SIZE];
+    long iterations = 50000 * bench_scale + 500;
+    long total = 0;
+    long i;
+    double start;
+
+    start = bench_now_ns();
+    for(i = 0; i < iterations; i++){total += bench_power_on(BVR_snprintf, line, sizeof(line));}
+    bench_add("power_on_bvr", 0, iterations * 10, bench_now_ns() - start);
+
+    start = bench_now_ns();
+    for(i = 0; i < iterations; i++){total -= bench_power_on(snprintf, line, sizeof(line));}
+    bench_add("power_on_libc", 0, iterations * 10, bench_now_ns() - start);
+
+    // both wrote the same number of characters
+    if(total != 0){fprintf(stderr, "power_on: formatters disagree\n");}
+}
+
+
+/* log lines of 20 to 131 bytes feed a uart that sends rate bytes in the
+ * time one line is logged. Whenever a transfer is done the next one takes
+ * the largest contiguous span waiting, the way the logger starts
+ * HAL_UART_Transmit_DMA. The fifo has to split a span at the end of the
+ * buffer, the bip buffer never does */
+static void bench_tx_sim(const char *name, int bip, int rate)
+{
+    static uint8_t buffer[BENCH_TX_DEPTH];
+    uint8_t line[132];
+    fifo_t fifo;
+    bip_fifo_t bip_fifo;
+    temp_buffer_t span;
+    bench_tx_t *tx = &bench_tx[bench_tx_count++];
+    long lines = 200000 * bench_scale + 2000;
+    long n;
+    int in_flight = 0;
+    int budget = 0;
+    int size;
+
+    memset(line, 'x', sizeof(line));
+    if(bip){BVR_bip_init(&bip_fifo, buffer, BENCH_TX_DEPTH);}
+    else{BVR_fifo_init(&fifo, buffer, BENCH_TX_DEPTH);}
+
+    tx->name      = name;
+    tx->rate      = rate;
+    tx->bytes     = 0;
+    tx->transfers = 0;
+
+    for(n = 0; n < lines; n++)
+    {
+        // lines that find no room are dropped, as the logger does
+        size = 20 + (int)((n * 37) % 112);
+        if(bip){BVR_bip_push(&bip_fifo, line, size);}
+        else{BVR_fifo_push(&fifo, line, size);}
+        budget += rate;
+
+        // send until the time for this line runs out or nothing is left
+        while(1)
+        {
+            if(!in_flight)
+            {
+                span = bip ? BVR_bip_read(&bip_fifo) : BVR_fifo_claim(&fifo);
+                if(span.p_temp_buff == NULL)
+                {
+                    // an idle uart does not bank time
+                    budget = 0;
+                    break;
+                }
+                in_flight = span.buff_size;
+                tx->bytes += span.buff_size;
+                tx->transfers++;
+            }
+
+            if(budget < in_flight){break;}
+            budget -= in_flight;
+            if(bip){BVR_bip_release(&bip_fifo, in_flight);}
+            else{BVR_fifo_release(&fifo, in_flight);}
+            in_flight = 0;
+        }
+    }
+}
+
+static void bench_print(int csv)
+{
+    bench_result_t *result;
+    bench_tx_t *tx;
+    double mb_per_s;
+    double bytes_per_cycle;
+    double per_kb;
+    int i;
+
+    if(csv)
+    {
+        printf("name,size,iterations,ns_per_op,mb_per_s,cycles_per_op,bytes_per_cycle\n");
+    }
+    else
+    {
+        printf("{\n  \"suite\": \"bvr_bench\",\n  \"results\": [\n");
+    }
+
+    for(i = 0; i < bench_count; i++)
+    {
+        result = &bench_results[i];
+        mb_per_s = (result->size > 0) ? (result->size * 1e3) / result->ns_per_op : 0.0;
+        bytes_per_cycle = ((result->size > 0) && (result->cycles_per_op > 0.0)) ?
+                          result->size / result->cycles_per_op : 0.0;
+
+        if(csv)
+        {
+            printf("%s,%d,%ld,%.3f,%.3f,%.1f,%.3f\n", result->name, result->size,
+                   result->iterations, result->ns_per_op, mb_per_s,
+                   result->cycles_per_op, bytes_per_cycle);
+        }
+        else
+        {
+            printf("    {\"name\": \"%s\", \"size\": %d, \"iterations\": %ld, "
+                   "\"ns_per_op\": %.3f, \"mb_per_s\": %.3f, \"cycles_per_op\": %.1f, "
+                   "\"bytes_per_cycle\": %.3f}%s\n",
+                   result->name, result->size, result->iterations, result->ns_per_op,
+                   mb_per_s, result->cycles_per_op, bytes_per_cycle,
+                   (i + 1 < bench_count) ? "," : "");
+        }
+    }
+
+    if(csv)
+    {
+        printf("\nbuffer,rate,bytes,transfers,transfers_per_kb\n");
+    }
+    else
+    {
+        printf("  ],\n  \"tx\": [\n");
+    }
+
+    for(i = 0; i < bench_tx_count; i++)
+    {
+        tx = &bench_tx[i];
+        per_kb = (tx->bytes > 0) ? (tx->transfers * 1024.0) / tx->bytes : 0.0;
+
+        if(csv)
+        {
+            printf("%s,%d,%ld,%ld,%.3f\n", tx->name, tx->rate, tx->bytes, tx->transfers, per_kb);
+        }
+        else
+        {
+            printf("    {\"buffer\": \"%s\", \"rate\": %d, \"bytes\": %ld, "
+                   "\"transfers\": %ld, \"transfers_per_kb\": %.3f}%s\n",
+                   tx->name, tx->rate, tx->bytes, tx->transfers, per_kb,
+                   (i + 1 < bench_tx_count) ? "," : "");
+        }
+    }
+
+    if(!csv)
+    {
+        printf("  ]\n}\n");
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    int csv = 0;
+    int i;
+
+    for(i = 1; i < argc; i++)
+    {
+        if(strcmp(argv[i], "--csv") == 0){csv = 1;}
+        else if(strcmp(argv[i], "--quick") == 0){bench_scale = 0;}
+        else
+        {
+            fprintf(stderr, "usage: %s [--csv] [--quick]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    bench_calibrate();
+    bench_fifo("fifo_pow2", BENCH_FIFO_DEPTH, 0);
+    bench_fifo("fifo_odd", BENCH_FIFO_DEPTH - 48, 0);
+    bench_fifo("fifo_mp", BENCH_FIFO_DEPTH, 1);
+    bench_fifo_old();
+    bench_fifo_cpp();
+    bench_fifo_stream();
+    bench_fifo_mp_contended();
+    bench_crc();
+    bench_log();
+    bench_power_on_mix();
+    bench_tx_sim("tx_fifo", 0, BENCH_TX_LIGHT);
+    bench_tx_sim("tx_bip", 1, BENCH_TX_LIGHT);
+    bench_tx_sim("tx_fifo", 0, BENCH_TX_HEAVY);
+    bench_tx_sim("tx_bip", 1, BENCH_TX_HEAVY);
+
+    bench_print(csv);
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
@@ -0,0 +1,63 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     bvr_bench_cpp.cpp
+* @brief    BVR::Fifo half of bvr_bench
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Runs the same push then pop loop as bench_fifo in bvr_bench.c on a
+*       BVR::Fifo<uint8_t, 2048>, so the compile time capacity can be set
+*       against fifo_pow2 with its depth read at run time.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include "BVR_fifo.hpp"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+static BVR::Fifo<uint8_t, 2048> bench_cpp_fifo_2k;
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+/* ns for iterations push then pop of size bytes */
+extern "C" double bench_cpp_fifo(int size, long iterations)
+{
+    uint8_t message[512];
+    uint8_t out[512];
+
+    std::memset(message, 0x5A, sizeof(message));
+    bench_cpp_fifo_2k.pop(out, bench_cpp_fifo_2k.level());
+
+    const auto start = std::chrono::steady_clock::now();
+    for(long i = 0; i < iterations; i++)
+    {
+        bench_cpp_fifo_2k.push(message, size);
+        bench_cpp_fifo_2k.pop(out, size);
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    return std::chrono::duration<double, std::nano>(elapsed).count();
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
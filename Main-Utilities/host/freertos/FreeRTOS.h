@@ -0,0 +1,58 @@
+/**
+********************************************************************************
+* @author       Byron Palavikas
+* @date
+* @file         FreeRTOS.h
+* @brief        stand in for the FreeRTOS kernel header on a PC
+* @version      V0.1.0
+* @copyright    (C) COPYRIGHT
+* @target       Linux host
+* @IDE
+* @repo         git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*           Only the types and macros Main-Utilities uses, enough to build
+*           the logger task on the host. Tasks are pthreads, see task.h.
+*
+********************************************************************************
+*/
+#ifndef HOST_FREERTOS_H_
+#define HOST_FREERTOS_H_
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <stdint.h>
+
+
+/*--DEFINES-------------------------------------------------------------------*/
+#define pdFALSE                 0
+#define pdTRUE                  1
+#define pdPASS                  pdTRUE
+#define portMAX_DELAY           0xFFFFFFFFUL
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(ms))
+#define tskIDLE_PRIORITY        0
+#define taskSCHEDULER_RUNNING   2
+#define portYIELD_FROM_ISR(w)   ((void)(w))
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+typedef long BaseType_t;
+typedef unsigned long UBaseType_t;
+typedef uint32_t TickType_t;
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_FREERTOS_H_ */
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
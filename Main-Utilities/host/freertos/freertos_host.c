@@ -0,0 +1,180 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     freertos_host.c
+* @brief    pthread backed FreeRTOS tasks and notifications for the host build
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Refer to header file for more information
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <pthread.h>
+#include <stdlib.h>
+#include <time.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "host_hal.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+struct host_task
+{
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    uint32_t value;     /**< notification value */
+    int pending;        /**< notified since the last wait returned */
+    TaskFunction_t code;
+    void *argument;
+};
+
+static __thread struct host_task *host_task_current = NULL;
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+static void *host_task_entry(void *argument)
+{
+    struct host_task *task = argument;
+
+    host_task_current = task;
+    task->code(task->argument);
+    return NULL;
+}
+
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char *name, uint32_t stack,
+                       void *argument, UBaseType_t priority, TaskHandle_t *handle)
+{
+    struct host_task *task = calloc(1, sizeof(*task));
+
+    UNUSED(name);
+    UNUSED(stack);
+    UNUSED(priority);
+
+    if(task == NULL){return pdFALSE;}
+
+    pthread_mutex_init(&task->lock, NULL);
+    pthread_cond_init(&task->wake, NULL);
+    task->code     = code;
+    task->argument = argument;
+
+    // the handle is out before the task can run, as with a real scheduler
+    if(handle != NULL){*handle = task;}
+
+    if(pthread_create(&task->thread, NULL, host_task_entry, task) != 0)
+    {
+        if(handle != NULL){*handle = NULL;}
+        free(task);
+        return pdFALSE;
+    }
+    pthread_detach(task->thread);
+
+    return pdPASS;
+}
+
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action)
+{
+    UNUSED(action);
+
+    pthread_mutex_lock(&task->lock);
+    task->value  |= value;
+    task->pending = 1;
+    pthread_cond_signal(&task->wake);
+    pthread_mutex_unlock(&task->lock);
+
+    return pdPASS;
+}
+
+
+BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action,
+                              BaseType_t *woken)
+{
+    if(woken != NULL){*woken = pdFALSE;}
+    return xTaskNotify(task, value, action);
+}
+
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit,
+                           uint32_t *value, TickType_t ticks)
+{
+    struct host_task *task = host_task_current;
+    struct timespec until;
+    BaseType_t received = pdFALSE;
+
+    if(task == NULL){return pdFALSE;}
+
+    clock_gettime(CLOCK_REALTIME, &until);
+    until.tv_sec  += ticks / 1000;
+    until.tv_nsec += (long)(ticks % 1000) * 1000000L;
+    if(until.tv_nsec >= 1000000000L)
+    {
+        until.tv_sec++;
+        until.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&task->lock);
+    if(!task->pending){task->value &= ~clear_on_entry;}
+
+    while(!task->pending)
+    {
+        if(ticks == portMAX_DELAY){pthread_cond_wait(&task->wake, &task->lock);}
+        else if(pthread_cond_timedwait(&task->wake, &task->lock, &until) != 0){break;}
+    }
+
+    if(value != NULL){*value = task->value;}
+    if(task->pending)
+    {
+        task->value  &= ~clear_on_exit;
+        task->pending = 0;
+        received = pdTRUE;
+    }
+    pthread_mutex_unlock(&task->lock);
+
+    return received;
+}
+
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return host_task_current;
+}
+
+
+TickType_t xTaskGetTickCount(void)
+{
+    return HAL_GetTick();
+}
+
+
+BaseType_t xTaskGetSchedulerState(void)
+{
+    return taskSCHEDULER_RUNNING;
+}
+
+
+BaseType_t xPortIsInsideInterrupt(void)
+{
+    return __get_IPSR() != 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
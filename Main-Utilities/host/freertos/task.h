@@ -0,0 +1,68 @@
+/**
+********************************************************************************
+* @author       Byron Palavikas
+* @date
+* @file         task.h
+* @brief        stand in for the FreeRTOS task API on a PC
+* @version      V0.1.0
+* @copyright    (C) COPYRIGHT
+* @target       Linux host
+* @IDE
+* @repo         git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*           Each task is a pthread with its own notification value, priority
+*           and stack size are ignored. The scheduler always counts as
+*           running and a thread with host_ipsr set counts as an interrupt.
+*           Threads not made with xTaskCreate have no task handle.
+*
+********************************************************************************
+*/
+#ifndef HOST_TASK_H_
+#define HOST_TASK_H_
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include "FreeRTOS.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+typedef struct host_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *argument);
+
+typedef enum
+{
+    eSetBits
+}eNotifyAction;
+
+
+/*--FUNCTION--PROTOTYPE-------------------------------------------------------*/
+
+extern BaseType_t xTaskCreate(TaskFunction_t code, const char *name, uint32_t stack,
+                              void *argument, UBaseType_t priority, TaskHandle_t *handle);
+extern BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action);
+extern BaseType_t xTaskNotifyFromISR(TaskHandle_t task, uint32_t value, eNotifyAction action,
+                                     BaseType_t *woken);
+extern BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit,
+                                  uint32_t *value, TickType_t ticks);
+extern TaskHandle_t xTaskGetCurrentTaskHandle(void);
+extern TickType_t xTaskGetTickCount(void);
+extern BaseType_t xTaskGetSchedulerState(void);
+extern BaseType_t xPortIsInsideInterrupt(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_TASK_H_ */
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
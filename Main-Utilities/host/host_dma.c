@@ -0,0 +1,131 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     host_dma.c
+* @brief    simulated memory to memory dma engine for the host build
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Refer to header file for more information
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <sched.h>
+#include <string.h>
+#include "host_dma.h"
+#include "host_hal.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+#define HOST_DMA_CHUNK  16      /* bytes copied between yields */
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+static void *host_dma_worker(void *argument)
+{
+    host_dma_t *engine = argument;
+    uint8_t *dst;
+    const uint8_t *src;
+    int size;
+    int chunk;
+
+    // the complete callback runs as the dma interrupt
+    host_ipsr = 1;
+
+    for(;;)
+    {
+        pthread_mutex_lock(&engine->lock);
+        while(engine->pending != 1)
+        {
+            pthread_cond_wait(&engine->wake, &engine->lock);
+        }
+        dst  = engine->dst;
+        src  = engine->src;
+        size = engine->size;
+        engine->pending = 2;
+        pthread_mutex_unlock(&engine->lock);
+
+        // a bit at a time so the other side runs while the copy is half done
+        while(size > 0)
+        {
+            chunk = (size < HOST_DMA_CHUNK) ? size : HOST_DMA_CHUNK;
+            memcpy(dst, src, chunk);
+            dst  += chunk;
+            src  += chunk;
+            size -= chunk;
+            sched_yield();
+        }
+
+        // the stream is free again before the callback, it may start the next
+        pthread_mutex_lock(&engine->lock);
+        engine->pending = 0;
+        engine->transfers++;
+        pthread_mutex_unlock(&engine->lock);
+
+        if(engine->complete != NULL){engine->complete(engine);}
+    }
+
+    return NULL;
+}
+
+
+BVR_status_t host_dma_init(host_dma_t *engine, host_dma_cplt_t complete)
+{
+    memset(engine, 0, sizeof(*engine));
+    engine->complete = complete;
+    pthread_mutex_init(&engine->lock, NULL);
+    pthread_cond_init(&engine->wake, NULL);
+
+    if(pthread_create(&engine->thread, NULL, host_dma_worker, engine) != 0)
+    {
+        return BVR_ERROR;
+    }
+    pthread_detach(engine->thread);
+
+    return BVR_OK;
+}
+
+
+BVR_status_t host_dma_start(void *dst, const void *src, int size, void *engine)
+{
+    host_dma_t *dma = engine;
+
+    if(size <= 0)
+    {
+        return BVR_ERROR;
+    }
+
+    pthread_mutex_lock(&dma->lock);
+    if(dma->pending)
+    {
+        pthread_mutex_unlock(&dma->lock);
+        return BVR_BUSY;
+    }
+    dma->dst     = dst;
+    dma->src     = src;
+    dma->size    = size;
+    dma->pending = 1;
+    pthread_cond_signal(&dma->wake);
+    pthread_mutex_unlock(&dma->lock);
+
+    return BVR_OK;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
@@ -0,0 +1,98 @@
+/**
+********************************************************************************
+* @author       Byron Palavikas
+* @date
+* @file         host_dma.h
+* @brief        simulated memory to memory dma engine for the host build
+* @version      V0.1.0
+* @copyright    (C) COPYRIGHT
+* @target       Linux host
+* @IDE
+* @repo         git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*           Stands in for a DMA2 memory to memory stream behind fifo_dma_t.
+*           host_dma_start has the fifo_dma_start_t signature and only
+*           queues the copy, a worker thread copies it a chunk at a time and
+*           then runs the complete callback as an interrupt (host_ipsr set),
+*           as XferCpltCallback would on the target
+*           void sensor_dma_cplt(host_dma_t *engine)
+*           {
+*               BVR_fifo_dma_complete(&sensor_dma);
+*           }
+*           host_dma_init(&engine, sensor_dma_cplt);
+*           BVR_fifo_dma_init(&sensor_dma, host_dma_start, &engine, 64, NULL);
+*
+*           One transfer at a time per engine, a start while one is in flight
+*           gets BVR_BUSY.
+*
+********************************************************************************
+*/
+#ifndef HOST_DMA_H_
+#define HOST_DMA_H_
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <pthread.h>
+#include "BVR_error.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+typedef struct host_dma host_dma_t;
+
+/** runs on the worker thread once a transfer has landed */
+typedef void (*host_dma_cplt_t)(host_dma_t *engine);
+
+/**@struct host_dma
+ * @brief simulated dma stream type definition
+ */
+struct host_dma
+{
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    void *dst;                  /**< transfer in flight */
+    const void *src;            /**< transfer in flight */
+    int size;                   /**< transfer in flight */
+    int pending;                /**< a transfer is queued or copying */
+    host_dma_cplt_t complete;   /**< transfer complete callback */
+    volatile long transfers;    /**< transfers finished since init */
+};
+
+
+/*--FUNCTION--PROTOTYPE-------------------------------------------------------*/
+
+/**
+  * @brief Start the worker thread of a simulated dma stream
+  * @param host_dma_t *engine
+  * @param host_dma_cplt_t complete
+  * @retval BVR_status_t
+  */
+extern BVR_status_t host_dma_init(host_dma_t *engine, host_dma_cplt_t complete);
+
+/**
+  * @brief Queue one transfer, fifo_dma_start_t for fifo_dma_t
+  * @param void *dst
+  * @param const void *src
+  * @param int size
+  * @param void *engine the host_dma_t
+  * @retval BVR_status_t BVR_BUSY while a transfer is in flight
+  */
+extern BVR_status_t host_dma_start(void *dst, const void *src, int size, void *engine);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_DMA_H_ */
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
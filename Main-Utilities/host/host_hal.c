@@ -0,0 +1,110 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     host_hal.c
+* @brief    stand in HAL calls and main.c handles for the host build
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Refer to header file for more information
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <time.h>
+#include "host_hal.h"
+#include "BVR_fifo_buffer.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+/* what main.c declares on the target */
+UART_HandleTypeDef huart2;
+DMA_HandleTypeDef  hdma_usart2_rx;
+DMA_HandleTypeDef  hdma_usart2_tx;
+fifo_t dbg_uart_tx_fifo;
+
+static DMA_Stream_TypeDef host_usart2_rx_stream;
+
+host_uart_tx_t host_uart_tx_hook = NULL;
+volatile HAL_StatusTypeDef host_uart_tx_status = HAL_OK;
+__thread unsigned host_ipsr = 0;
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+uint32_t HAL_GetTick(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((now.tv_sec * 1000) + (now.tv_nsec / 1000000));
+}
+
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *p_data, uint16_t size)
+{
+    // a test can make the next transfers fail
+    if(host_uart_tx_status != HAL_OK)
+    {
+        return host_uart_tx_status;
+    }
+
+    huart->pTxBuffPtr = p_data;
+    huart->TxXferSize = size;
+    huart->gState     = HAL_UART_STATE_BUSY_TX;
+
+    if(host_uart_tx_hook != NULL)
+    {
+        host_uart_tx_hook(huart, p_data, size);
+    }
+
+    return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef *huart, uint8_t *p_data, uint16_t size)
+{
+    if(huart->hdmarx == NULL)
+    {
+        huart->hdmarx = &hdma_usart2_rx;
+    }
+    if(huart->hdmarx->Instance == NULL)
+    {
+        huart->hdmarx->Instance = &host_usart2_rx_stream;
+    }
+
+    huart->pRxBuffPtr  = p_data;
+    huart->RxXferCount = 0;
+    huart->gState      = HAL_UART_STATE_READY;
+    huart->hdmarx->Instance->NDTR = size;
+
+    return HAL_OK;
+}
+
+
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef *hdma, uint32_t src, uint32_t dst, uint32_t size)
+{
+    // no memory to memory DMA on the host, callers keep the copy on the CPU
+    UNUSED(hdma);
+    UNUSED(src);
+    UNUSED(dst);
+    UNUSED(size);
+    return HAL_ERROR;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
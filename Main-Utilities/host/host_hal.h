@@ -0,0 +1,123 @@
+/**
+********************************************************************************
+* @author       Byron Palavikas
+* @date
+* @file         host_hal.h
+* @brief        stand in for stm32f4xx_hal.h on a PC
+* @version      V0.1.0
+* @copyright    (C) COPYRIGHT
+* @target       Linux host
+* @IDE
+* @repo         git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*           Only what Main-Utilities uses from the HAL, enough to build it
+*           natively for the benchmarks and tests. Selected through
+*           BVR_MCU_HAL by the CMake host build.
+*
+*           The uart DMA does not move any data, HAL_UART_Transmit_DMA
+*           hands the span to host_uart_tx_hook and the test or benchmark
+*           calls BVR_uart_debug_tx_cplt when it is done with it.
+*           host_ipsr stands in for the IPSR register, set it non zero in a
+*           thread to have it treated as an interrupt.
+*
+********************************************************************************
+*/
+#ifndef HOST_HAL_H_
+#define HOST_HAL_H_
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+#ifdef __cplusplus
+    extern "C" {
+#endif
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <stdint.h>
+
+
+/*--DEFINES-------------------------------------------------------------------*/
+#define UNUSED(x) ((void)(x))
+
+#define DMA_IT_TC   0x01
+#define DMA_IT_HT   0x02
+#define DMA_IT_TE   0x04
+#define __HAL_DMA_DISABLE_IT(h, i) ((void)(h))
+
+#define RCC_FLAG_LPWRRST    0
+#define RCC_FLAG_WWDGRST    0
+#define RCC_FLAG_IWDGRST    0
+#define RCC_FLAG_SFTRST     0
+#define RCC_FLAG_PORRST     0
+#define RCC_FLAG_PINRST     0
+#define RCC_FLAG_BORRST     0
+#define __HAL_RCC_GET_FLAG(f) 0
+#define __HAL_RCC_CLEAR_RESET_FLAGS()
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+typedef enum
+{
+    HAL_OK,
+    HAL_ERROR,
+    HAL_BUSY,
+    HAL_TIMEOUT
+}HAL_StatusTypeDef;
+
+typedef enum
+{
+    HAL_UART_STATE_READY    = 0x20,
+    HAL_UART_STATE_BUSY_TX  = 0x21
+}HAL_UART_StateTypeDef;
+
+typedef struct
+{
+    volatile uint32_t NDTR;
+}DMA_Stream_TypeDef;
+
+typedef struct
+{
+    DMA_Stream_TypeDef *Instance;
+}DMA_HandleTypeDef;
+
+typedef struct
+{
+    const uint8_t *pTxBuffPtr;
+    uint16_t TxXferSize;
+    uint8_t *pRxBuffPtr;
+    volatile uint16_t RxXferCount;
+    DMA_HandleTypeDef *hdmarx;
+    volatile uint32_t gState;
+}UART_HandleTypeDef;
+
+/* called by HAL_UART_Transmit_DMA with the span it was given */
+typedef void (*host_uart_tx_t)(UART_HandleTypeDef *huart, const uint8_t *p_data, uint16_t size);
+
+extern host_uart_tx_t host_uart_tx_hook;
+extern volatile HAL_StatusTypeDef host_uart_tx_status;
+extern __thread unsigned host_ipsr;
+
+
+/*--FUNCTION--PROTOTYPE-------------------------------------------------------*/
+
+static inline unsigned __get_IPSR(void)
+{
+    return host_ipsr;
+}
+
+extern uint32_t HAL_GetTick(void);
+extern HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, const uint8_t *p_data, uint16_t size);
+extern HAL_StatusTypeDef HAL_UART_Receive_DMA(UART_HandleTypeDef *huart, uint8_t *p_data, uint16_t size);
+extern HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef *hdma, uint32_t src, uint32_t dst, uint32_t size);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_HAL_H_ */
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
@@ -0,0 +1,44 @@
+/**
+********************************************************************************
+* @author       Byron Palavikas
+* @date
+* @file         bvr_test.h
+* @brief        checks for the host tests
+* @version      V0.1.0
+* @copyright    (C) COPYRIGHT
+* @target       Linux host
+* @IDE
+* @repo         git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*           Each test is its own program run by ctest, a failed CHECK prints
+*           where and exits non zero.
+*
+********************************************************************************
+*/
+#ifndef BVR_TEST_H_
+#define BVR_TEST_H_
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/*--MACROS--------------------------------------------------------------------*/
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            exit(1); \
+        } \
+    } while (0)
+
+#endif /* BVR_TEST_H_ */
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
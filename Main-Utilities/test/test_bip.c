@@ -0,0 +1,250 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_bip.c
+* @brief    bip buffer blocks stay contiguous and in order
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Random reserve/commit and read/release on one thread checked against
+*       a plain model queue, every reservation has to sit inside the buffer
+*       in one piece. Then a producer thread pushes while this thread reads
+*       and releases spans like the uart DMA would.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include "BVR_fifo_buffer.h"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+#define TEST_OPS        50000
+#define TEST_DEPTH      200
+#define TEST_MAX_BLOCK  70
+#define TEST_BYTES      (4L * 1024 * 1024)
+
+static uint8_t test_buffer[TEST_DEPTH];
+static bip_fifo_t test_bip;
+static uint32_t test_seed = 4242;
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+static int test_rand(int limit)
+{
+    test_seed = (test_seed * 1103515245u) + 12345u;
+    return (int)((test_seed >> 16) % (uint32_t)limit);
+}
+
+
+static void test_errors(void)
+{
+    uint8_t data[TEST_DEPTH + 1];
+
+    CHECK(BVR_bip_init(&test_bip, NULL, TEST_DEPTH) == BVR_ERROR);
+    CHECK(BVR_bip_init(&test_bip, test_buffer, 0) == BVR_ERROR);
+    CHECK(BVR_bip_init(&test_bip, test_buffer, TEST_DEPTH) == BVR_OK);
+
+    // empty, too big and nothing to read
+    CHECK(BVR_bip_read(&test_bip).p_temp_buff == NULL);
+    CHECK(BVR_bip_reserve(&test_bip, 0).p_temp_buff == NULL);
+    CHECK(BVR_bip_reserve(&test_bip, TEST_DEPTH + 1).p_temp_buff == NULL);
+    CHECK(BVR_bip_push(&test_bip, data, TEST_DEPTH + 1) == BVR_ERROR);
+
+    // the whole buffer fits once, then nothing more
+    CHECK(BVR_bip_push(&test_bip, data, TEST_DEPTH) == BVR_OK);
+    CHECK(BVR_bip_push(&test_bip, data, 1) == BVR_ERROR);
+    CHECK(BVR_bip_read(&test_bip).buff_size == TEST_DEPTH);
+    CHECK(BVR_bip_release(&test_bip, TEST_DEPTH + 1) == BVR_ERROR);
+    CHECK(BVR_bip_release(&test_bip, TEST_DEPTH) == BVR_OK);
+}
+
+
+/* a block that does not fit before the end goes to the start, not split */
+static void test_wrap(void)
+{
+    uint8_t data[TEST_DEPTH];
+    temp_buffer_t span;
+
+    CHECK(BVR_bip_init(&test_bip, test_buffer, TEST_DEPTH) == BVR_OK);
+    memset(data, 0xA5, sizeof(data));
+
+    CHECK(BVR_bip_push(&test_bip, data, 150) == BVR_OK);
+    CHECK(BVR_bip_release(&test_bip, 100) == BVR_OK);
+
+    // 50 left at the end, 99 free at the start, a wrapped write stays
+    // one byte behind the reader
+    CHECK(BVR_bip_reserve(&test_bip, 100).p_temp_buff == NULL);
+    span = BVR_bip_reserve(&test_bip, 60);
+    CHECK(span.p_temp_buff == test_buffer);
+    CHECK(span.buff_size == 60);
+    memset(span.p_temp_buff, 0x5A, 60);
+    CHECK(BVR_bip_commit(&test_bip, 60) == BVR_OK);
+
+    // the first region is read to where it ended, then the second
+    span = BVR_bip_read(&test_bip);
+    CHECK(span.p_temp_buff == test_buffer + 100);
+    CHECK(span.buff_size == 50);
+    CHECK(BVR_bip_release(&test_bip, 50) == BVR_OK);
+    span = BVR_bip_read(&test_bip);
+    CHECK(span.p_temp_buff == test_buffer);
+    CHECK(span.buff_size == 60);
+    CHECK(span.p_temp_buff[0] == 0x5A);
+
+    // the reader is back at the start so the old end is free again
+    CHECK(BVR_bip_reserve(&test_bip, 141).p_temp_buff == NULL);
+    CHECK(BVR_bip_reserve(&test_bip, 140).p_temp_buff == test_buffer + 60);
+    CHECK(BVR_bip_commit(&test_bip, 0) == BVR_OK);
+    CHECK(BVR_bip_release(&test_bip, 60) == BVR_OK);
+    CHECK(BVR_bip_read(&test_bip).p_temp_buff == NULL);
+}
+
+
+static void test_model(void)
+{
+    uint8_t model[TEST_DEPTH];
+    temp_buffer_t span;
+    uint8_t next = 0;
+    int level = 0;
+    int size;
+    int used;
+    int op;
+    int i;
+
+    CHECK(BVR_bip_init(&test_bip, test_buffer, TEST_DEPTH) == BVR_OK);
+
+    for(op = 0; op < TEST_OPS; op++)
+    {
+        if(test_rand(2) == 0)
+        {
+            size = 1 + test_rand(TEST_MAX_BLOCK);
+            span = BVR_bip_reserve(&test_bip, size);
+            if(span.p_temp_buff == NULL)
+            {
+                // an empty buffer always has room for a block
+                CHECK(level > 0);
+                continue;
+            }
+
+            // one piece inside the buffer
+            CHECK(span.buff_size == size);
+            CHECK(span.p_temp_buff >= test_buffer);
+            CHECK((span.p_temp_buff + size) <= (test_buffer + TEST_DEPTH));
+
+            // sometimes less is written than reserved
+            used = (test_rand(4) == 0) ? test_rand(size + 1) : size;
+            for(i = 0; i < used; i++){span.p_temp_buff[i] = next + i;}
+            CHECK(BVR_bip_commit(&test_bip, used) == BVR_OK);
+            memcpy(&model[level], span.p_temp_buff, used);
+            level += used;
+            next  += used;
+        }
+        else
+        {
+            span = BVR_bip_read(&test_bip);
+            if(span.p_temp_buff == NULL)
+            {
+                CHECK(level == 0);
+                continue;
+            }
+
+            CHECK(span.buff_size <= level);
+            CHECK(memcmp(span.p_temp_buff, model, span.buff_size) == 0);
+
+            // release all or part of it
+            size = 1 + test_rand(span.buff_size);
+            CHECK(BVR_bip_release(&test_bip, size) == BVR_OK);
+            memmove(model, &model[size], level - size);
+            level -= size;
+        }
+    }
+}
+
+
+static void *test_producer(void *arg)
+{
+    uint8_t block[TEST_MAX_BLOCK];
+    long sent = 0;
+    int size;
+    int i;
+
+    (void)arg;
+
+    while(sent < TEST_BYTES)
+    {
+        size = 1 + (int)(sent % TEST_MAX_BLOCK);
+        if(size > (TEST_BYTES - sent)){size = (int)(TEST_BYTES - sent);}
+        for(i = 0; i < size; i++){block[i] = (uint8_t)(sent + i);}
+
+        if(BVR_bip_push(&test_bip, block, size) == BVR_OK){sent += size;}
+        else{sched_yield();}
+    }
+
+    return NULL;
+}
+
+
+/* the consumer frees each span only after it has been checked, as a dma would */
+static void test_threads(void)
+{
+    pthread_t producer;
+    temp_buffer_t span;
+    long received = 0;
+    int i;
+
+    CHECK(BVR_bip_init(&test_bip, test_buffer, TEST_DEPTH) == BVR_OK);
+    CHECK(pthread_create(&producer, NULL, test_producer, NULL) == 0);
+
+    while(received < TEST_BYTES)
+    {
+        span = BVR_bip_read(&test_bip);
+        if(span.p_temp_buff == NULL)
+        {
+            sched_yield();
+            continue;
+        }
+
+        for(i = 0; i < span.buff_size; i++)
+        {
+            CHECK(span.p_temp_buff[i] == (uint8_t)(received + i));
+        }
+        received += span.buff_size;
+        CHECK(BVR_bip_release(&test_bip, span.buff_size) == BVR_OK);
+    }
+
+    pthread_join(producer, NULL);
+    CHECK(BVR_bip_read(&test_bip).p_temp_buff == NULL);
+}
+
+
+int main(void)
+{
+    test_errors();
+    test_wrap();
+    test_model();
+    test_threads();
+
+    puts("test_bip ok");
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
@@ -0,0 +1,156 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_buffer_pool.c
+* @brief    buffer pool references and lock free alloc/release stress
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Reference counting and misuse on one thread, then several threads
+*       alloc, stamp, share and release small pools as fast as they can. A
+*       block handed to two owners at once (the ABA case the free list tag
+*       guards) shows up as a stamp changed under its owner.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include "BVR_buffer_pool.h"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+#define TEST_BLOCKS     4
+#define TEST_BLOCK_SIZE 64
+#define TEST_THREADS    4
+#define TEST_ROUNDS     50000
+
+static uint8_t test_blocks[TEST_BLOCKS * TEST_BLOCK_SIZE] __attribute__((aligned(BVR_POOL_ALIGN)));
+static pool_meta_t test_meta[TEST_BLOCKS];
+static buffer_pool_t test_pool;
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+static void test_refs(void)
+{
+    uint8_t *blocks[TEST_BLOCKS];
+    int i;
+
+    CHECK(BVR_pool_init(&test_pool, test_blocks, test_meta, TEST_BLOCK_SIZE, TEST_BLOCKS) == BVR_OK);
+    CHECK(BVR_pool_free_count(&test_pool) == TEST_BLOCKS);
+
+    for(i = 0; i < TEST_BLOCKS; i++)
+    {
+        blocks[i] = BVR_pool_alloc(&test_pool);
+        CHECK(blocks[i] != NULL);
+        CHECK(((uintptr_t)blocks[i] % BVR_POOL_ALIGN) == 0);
+        CHECK((i == 0) || (blocks[i] != blocks[i - 1]));
+    }
+    CHECK(BVR_pool_alloc(&test_pool) == NULL);
+
+    // two sinks share block 0, it only goes back after the last release
+    CHECK(BVR_pool_ref(&test_pool, blocks[0]) == BVR_OK);
+    CHECK(BVR_pool_release(&test_pool, blocks[0]) == BVR_OK);
+    CHECK(BVR_pool_free_count(&test_pool) == 0);
+    CHECK(BVR_pool_release(&test_pool, blocks[0]) == BVR_OK);
+    CHECK(BVR_pool_free_count(&test_pool) == 1);
+
+    // misuse is refused and changes nothing
+    CHECK(BVR_pool_release(&test_pool, blocks[0]) == BVR_ERROR);
+    CHECK(BVR_pool_ref(&test_pool, blocks[0]) == BVR_ERROR);
+    CHECK(BVR_pool_release(&test_pool, blocks[1] + 1) == BVR_ERROR);
+    CHECK(BVR_pool_free_count(&test_pool) == 1);
+
+    for(i = 1; i < TEST_BLOCKS; i++)
+    {
+        CHECK(BVR_pool_release(&test_pool, blocks[i]) == BVR_OK);
+    }
+    CHECK(BVR_pool_free_count(&test_pool) == TEST_BLOCKS);
+}
+
+
+static void *test_worker(void *arg)
+{
+    uint32_t stamp[TEST_BLOCK_SIZE / 4];
+    uint8_t *block;
+    uint32_t round;
+    int i;
+
+    for(round = 0; round < TEST_ROUNDS; round++)
+    {
+        block = BVR_pool_alloc(&test_pool);
+        if(block == NULL)
+        {
+            sched_yield();
+            continue;
+        }
+
+        for(i = 0; i < (TEST_BLOCK_SIZE / 4); i++){stamp[i] = ((uint32_t)(uintptr_t)arg << 24) ^ round ^ i;}
+        memcpy(block, stamp, sizeof(stamp));
+
+        // hold it across a reschedule now and then so the others churn the list
+        if((round % 64) == 0){sched_yield();}
+        CHECK(BVR_pool_ref(&test_pool, block) == BVR_OK);
+        CHECK(memcmp(block, stamp, sizeof(stamp)) == 0);
+
+        CHECK(BVR_pool_release(&test_pool, block) == BVR_OK);
+        CHECK(BVR_pool_release(&test_pool, block) == BVR_OK);
+    }
+
+    return NULL;
+}
+
+
+static void test_stress(void)
+{
+    pthread_t workers[TEST_THREADS];
+    int i;
+
+    CHECK(BVR_pool_init(&test_pool, test_blocks, test_meta, TEST_BLOCK_SIZE, TEST_BLOCKS) == BVR_OK);
+
+    for(i = 0; i < TEST_THREADS; i++)
+    {
+        CHECK(pthread_create(&workers[i], NULL, test_worker, (void *)(uintptr_t)i) == 0);
+    }
+    for(i = 0; i < TEST_THREADS; i++)
+    {
+        pthread_join(workers[i], NULL);
+    }
+
+    // nothing lost or handed out twice
+    CHECK(BVR_pool_free_count(&test_pool) == TEST_BLOCKS);
+    for(i = 0; i < TEST_BLOCKS; i++)
+    {
+        CHECK(BVR_pool_alloc(&test_pool) != NULL);
+    }
+    CHECK(BVR_pool_alloc(&test_pool) == NULL);
+}
+
+
+int main(void)
+{
+    test_refs();
+    test_stress();
+    puts("test_buffer_pool ok");
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
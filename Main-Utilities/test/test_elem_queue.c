@@ -0,0 +1,209 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_elem_queue.c
+* @brief    fixed size element queue, copies, in place slots and stats
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Built against bvr_utils_host_stats (BVR_FIFO_STATS set) so the byte
+*       counts can be checked next to the element levels. Batches over the
+*       wrap, in place slots and watermarks on one thread, then a producer
+*       thread fills slots in place while this thread pops batches.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include "BVR_fifo_buffer.h"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+#define TEST_DEPTH      10
+#define TEST_ELEMS      500000
+#define TEST_BATCH      4
+
+typedef struct
+{
+    uint32_t seq;
+    int16_t  x;
+    int16_t  y;
+    int16_t  z;
+}test_sample_t;
+
+static elem_queue_t test_queue;
+static test_sample_t test_slots[TEST_DEPTH];
+static int test_marks[2];
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+static void test_set(test_sample_t *sample, uint32_t seq)
+{
+    sample->seq = seq;
+    sample->x   = (int16_t)seq;
+    sample->y   = (int16_t)(seq * 3);
+    sample->z   = (int16_t)-seq;
+}
+
+
+static void test_check(const test_sample_t *sample, uint32_t seq)
+{
+    CHECK(sample->seq == seq);
+    CHECK(sample->x == (int16_t)seq);
+    CHECK(sample->y == (int16_t)(seq * 3));
+    CHECK(sample->z == (int16_t)-seq);
+}
+
+
+static void test_on_mark(fifo_t *fifo, fifo_mark_t mark, void *ctx)
+{
+    (void)fifo;
+    (void)ctx;
+    test_marks[mark]++;
+}
+
+
+static void test_single(void)
+{
+    fifo_stats_t *stats = &test_queue.slots.ctrl.stats;
+    test_sample_t in[16];
+    test_sample_t out[TEST_DEPTH];
+    test_sample_t *slot;
+    int i;
+
+    for(i = 0; i < 16; i++){test_set(&in[i], (uint32_t)i);}
+    CHECK(BVR_queue_init(&test_queue, test_slots, 0, TEST_DEPTH) == BVR_ERROR);
+    CHECK(BVR_queue_init(&test_queue, test_slots, sizeof(test_sample_t), TEST_DEPTH) == BVR_OK);
+    CHECK(BVR_fifo_set_marks(&test_queue.slots, 8, 2, test_on_mark, NULL) == BVR_OK);
+
+    // empty, all or nothing, levels count elements
+    CHECK(BVR_queue_front(&test_queue) == NULL);
+    CHECK(BVR_queue_pop(&test_queue, out, 1) == BVR_ERROR);
+    CHECK(BVR_queue_push(&test_queue, in, TEST_DEPTH + 1) == BVR_ERROR);
+    CHECK(BVR_queue_level(&test_queue) == 0);
+    CHECK(BVR_queue_push(&test_queue, in, 7) == BVR_OK);
+    CHECK(BVR_queue_level(&test_queue) == 7);
+    CHECK(BVR_queue_pop(&test_queue, out, 5) == BVR_OK);
+    for(i = 0; i < 5; i++){test_check(&out[i], (uint32_t)i);}
+
+    // 6 more run over the wrap
+    CHECK(BVR_queue_push(&test_queue, &in[7], 6) == BVR_OK);
+    CHECK(BVR_queue_level(&test_queue) == 8);
+    CHECK(test_marks[FIFO_MARK_HIGH] == 1);
+    CHECK(BVR_queue_pop(&test_queue, out, 8) == BVR_OK);
+    for(i = 0; i < 8; i++){test_check(&out[i], (uint32_t)(5 + i));}
+    CHECK(test_marks[FIFO_MARK_LOW] == 1);
+
+    // in place, one slot at a time
+    for(i = 0; i < TEST_DEPTH; i++)
+    {
+        slot = BVR_queue_reserve(&test_queue);
+        CHECK(slot != NULL);
+        test_set(slot, (uint32_t)(100 + i));
+        BVR_queue_commit(&test_queue);
+    }
+    CHECK(BVR_queue_reserve(&test_queue) == NULL);
+    CHECK(test_marks[FIFO_MARK_HIGH] == 2);
+
+    for(i = 0; i < TEST_DEPTH; i++)
+    {
+        slot = BVR_queue_front(&test_queue);
+        CHECK(slot != NULL);
+        test_check(slot, (uint32_t)(100 + i));
+        BVR_queue_release(&test_queue);
+    }
+    CHECK(BVR_queue_front(&test_queue) == NULL);
+    CHECK(test_marks[FIFO_MARK_LOW] == 2);
+
+    // stats count bytes, the high water mark counts elements
+    CHECK(stats->bytes_in == (7 + 6 + TEST_DEPTH) * sizeof(test_sample_t));
+    CHECK(stats->bytes_out == (5 + 8 + TEST_DEPTH) * sizeof(test_sample_t));
+    CHECK(stats->high_water == TEST_DEPTH);
+    CHECK(stats->push_fails == 1);
+    CHECK(stats->pop_calls == 3);
+}
+
+
+static void *test_producer(void *arg)
+{
+    test_sample_t *slot;
+    uint32_t seq = 0;
+
+    (void)arg;
+
+    while(seq < TEST_ELEMS)
+    {
+        slot = BVR_queue_reserve(&test_queue);
+        if(slot == NULL)
+        {
+            sched_yield();
+            continue;
+        }
+        test_set(slot, seq++);
+        BVR_queue_commit(&test_queue);
+    }
+
+    return NULL;
+}
+
+
+static void test_threads(void)
+{
+    pthread_t producer;
+    test_sample_t out[TEST_BATCH];
+    uint32_t seq = 0;
+    int count;
+    int i;
+
+    CHECK(BVR_queue_init(&test_queue, test_slots, sizeof(test_sample_t), TEST_DEPTH) == BVR_OK);
+    CHECK(pthread_create(&producer, NULL, test_producer, NULL) == 0);
+
+    while(seq < TEST_ELEMS)
+    {
+        count = 1 + (int)(seq % TEST_BATCH);
+        if(count > (int)(TEST_ELEMS - seq)){count = (int)(TEST_ELEMS - seq);}
+
+        if(BVR_queue_pop(&test_queue, out, count) != BVR_OK)
+        {
+            sched_yield();
+            continue;
+        }
+        for(i = 0; i < count; i++){test_check(&out[i], seq++);}
+    }
+
+    pthread_join(producer, NULL);
+    CHECK(BVR_queue_level(&test_queue) == 0);
+    CHECK(test_queue.slots.ctrl.stats.bytes_in == TEST_ELEMS * sizeof(test_sample_t));
+    CHECK(test_queue.slots.ctrl.stats.bytes_out == TEST_ELEMS * sizeof(test_sample_t));
+}
+
+
+int main(void)
+{
+    test_single();
+    test_threads();
+
+    puts("test_elem_queue ok");
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
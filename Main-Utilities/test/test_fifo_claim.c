@@ -0,0 +1,193 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_fifo_claim.c
+* @brief    claimed spans stay put until they are released
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Claims in flight, unclaim and release checked on one thread, then a
+*       producer thread pushes as fast as it can while this thread claims
+*       two spans ahead and only checks and releases them afterwards, as a
+*       uart DMA would. A push into space that is still claimed shows up as
+*       a changed byte.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <pthread.h>
+#include <sched.h>
+#include "BVR_fifo_buffer.h"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+#define TEST_BYTES      (4L * 1024 * 1024)
+#define TEST_MAX_CHUNK  45
+
+static fifo_t test_fifo;
+static uint8_t test_buffer[250];
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+static void test_single(void)
+{
+    uint8_t data[200];
+    temp_buffer_t first;
+    temp_buffer_t second;
+    int i;
+
+    for(i = 0; i < 200; i++){data[i] = (uint8_t)i;}
+    CHECK(BVR_fifo_init(&test_fifo, test_buffer, 100) == BVR_OK);
+
+    // empty
+    CHECK(BVR_fifo_claim(&test_fifo).p_temp_buff == NULL);
+    CHECK(BVR_fifo_release(&test_fifo, 1) == BVR_ERROR);
+
+    // a claim leaves the data counted, a second claim carries on after it
+    CHECK(BVR_fifo_push(&test_fifo, data, 30) == BVR_OK);
+    first = BVR_fifo_claim(&test_fifo);
+    CHECK(first.p_temp_buff == test_buffer);
+    CHECK(first.buff_size == 30);
+    CHECK(BVR_fifo_level(&test_fifo) == 30);
+    CHECK(BVR_fifo_claim(&test_fifo).p_temp_buff == NULL);
+
+    CHECK(BVR_fifo_push(&test_fifo, data + 30, 20) == BVR_OK);
+    second = BVR_fifo_claim(&test_fifo);
+    CHECK(second.p_temp_buff == test_buffer + 30);
+    CHECK(second.buff_size == 20);
+
+    // claimed space is not free to the producer
+    CHECK(BVR_fifo_push(&test_fifo, data, 51) == BVR_ERROR);
+
+    // released in order, never more than was claimed
+    CHECK(BVR_fifo_release(&test_fifo, 51) == BVR_ERROR);
+    CHECK(BVR_fifo_release(&test_fifo, 30) == BVR_OK);
+    CHECK(BVR_fifo_level(&test_fifo) == 20);
+    CHECK(BVR_fifo_release(&test_fifo, 20) == BVR_OK);
+    CHECK(BVR_fifo_level(&test_fifo) == 0);
+
+    // a span stops at the end of the buffer, the rest is the next claim
+    CHECK(BVR_fifo_push(&test_fifo, data, 80) == BVR_OK);
+    first = BVR_fifo_claim(&test_fifo);
+    CHECK(first.p_temp_buff == test_buffer + 50);
+    CHECK(first.buff_size == 50);
+    second = BVR_fifo_claim(&test_fifo);
+    CHECK(second.p_temp_buff == test_buffer);
+    CHECK(second.buff_size == 30);
+    CHECK(second.p_temp_buff[0] == 50);
+
+    // dma did not start, both spans are handed out again
+    BVR_fifo_unclaim(&test_fifo);
+    first = BVR_fifo_claim(&test_fifo);
+    CHECK(first.p_temp_buff == test_buffer + 50);
+    CHECK(first.buff_size == 50);
+    CHECK(BVR_fifo_release(&test_fifo, 50) == BVR_OK);
+    second = BVR_fifo_claim(&test_fifo);
+    CHECK(second.buff_size == 30);
+    CHECK(BVR_fifo_release(&test_fifo, 30) == BVR_OK);
+    CHECK(BVR_fifo_level(&test_fifo) == 0);
+
+    // an overwrite fifo can move the tail under a claim so it has none
+    CHECK(BVR_fifo_push(&test_fifo, data, 10) == BVR_OK);
+    CHECK(BVR_fifo_set_policy(&test_fifo, FIFO_OVERWRITE, 0) == BVR_OK);
+    CHECK(BVR_fifo_claim(&test_fifo).p_temp_buff == NULL);
+    CHECK(BVR_fifo_release(&test_fifo, 0) == BVR_ERROR);
+}
+
+
+static void *test_producer(void *arg)
+{
+    uint8_t chunk[TEST_MAX_CHUNK];
+    long sent = 0;
+    int size;
+    int i;
+
+    (void)arg;
+
+    while(sent < TEST_BYTES)
+    {
+        size = 1 + (int)(sent % TEST_MAX_CHUNK);
+        if(size > (TEST_BYTES - sent)){size = (int)(TEST_BYTES - sent);}
+        for(i = 0; i < size; i++){chunk[i] = (uint8_t)(sent + i);}
+
+        if(BVR_fifo_push(&test_fifo, chunk, size) == BVR_OK){sent += size;}
+        else{sched_yield();}
+    }
+
+    return NULL;
+}
+
+
+/* up to two spans claimed, the oldest transmitting and the next behind it */
+static void test_threads(void)
+{
+    pthread_t producer;
+    temp_buffer_t spans[2];
+    temp_buffer_t span;
+    long received = 0;
+    int count = 0;
+    int i;
+
+    CHECK(BVR_fifo_init(&test_fifo, test_buffer, sizeof(test_buffer)) == BVR_OK);
+    CHECK(pthread_create(&producer, NULL, test_producer, NULL) == 0);
+
+    while(received < TEST_BYTES)
+    {
+        if(count < 2)
+        {
+            span = BVR_fifo_claim(&test_fifo);
+            if(span.p_temp_buff != NULL)
+            {
+                spans[count++] = span;
+                continue;
+            }
+        }
+
+        // give the producer time to run over the claimed spans if it could
+        sched_yield();
+        if(count == 0){continue;}
+
+        for(i = 0; i < spans[0].buff_size; i++)
+        {
+            CHECK(spans[0].p_temp_buff[i] == (uint8_t)(received + i));
+        }
+        received += spans[0].buff_size;
+        CHECK(BVR_fifo_release(&test_fifo, spans[0].buff_size) == BVR_OK);
+
+        spans[0] = spans[1];
+        count--;
+    }
+
+    pthread_join(producer, NULL);
+    CHECK(count == 0);
+    CHECK(BVR_fifo_level(&test_fifo) == 0);
+}
+
+
+int main(void)
+{
+    test_single();
+    test_threads();
+
+    puts("test_fifo_claim ok");
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
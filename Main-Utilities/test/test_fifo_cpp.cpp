@@ -0,0 +1,135 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_fifo_cpp.cpp
+* @brief    BVR::Fifo<T, N> wrap, all or nothing and SPSC stress
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Single thread checks of the array and pointer overloads either side
+*       of the wrap, then one std::thread pushes numbered samples while the
+*       main thread pops them in batches.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <cstdint>
+#include <thread>
+#include "BVR_fifo.hpp"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+struct test_sample_t
+{
+    uint32_t seq;
+    int16_t axis[3];
+};
+
+static constexpr uint32_t TEST_SAMPLES = 200000;
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+static void test_wrap(void)
+{
+    BVR::Fifo<test_sample_t, 8> fifo;
+    test_sample_t in[5];
+    test_sample_t out[5];
+    uint32_t next_in = 0;
+    uint32_t next_out = 0;
+    int round;
+    int i;
+
+    static_assert(BVR::Fifo<test_sample_t, 8>::capacity() == 8, "capacity");
+    CHECK(fifo.empty() && !fifo.full());
+
+    // five in and five out moves the start round every index of the ring
+    for(round = 0; round < 16; round++)
+    {
+        for(i = 0; i < 5; i++){in[i] = {next_in++, {(int16_t)i, 0, (int16_t)-i}};}
+        CHECK(fifo.push(in) == BVR_OK);
+        CHECK(fifo.level() == 5);
+        CHECK(fifo.push(in, 4) == BVR_ERROR);
+        CHECK(fifo.level() == 5);
+
+        CHECK(fifo.pop(out) == BVR_OK);
+        for(i = 0; i < 5; i++)
+        {
+            CHECK(out[i].seq == next_out++);
+            CHECK(out[i].axis[2] == -i);
+        }
+        CHECK(fifo.pop(out[0]) == BVR_ERROR);
+    }
+
+    // the whole capacity is usable
+    for(i = 0; i < 8; i++){CHECK(fifo.push(in[0]) == BVR_OK);}
+    CHECK(fifo.full() && (fifo.space() == 0));
+    CHECK(fifo.push(in[0]) == BVR_ERROR);
+}
+
+
+static void test_threads(void)
+{
+    static BVR::Fifo<test_sample_t, 64> fifo;
+    test_sample_t batch[7];
+    uint32_t expected = 0;
+
+    std::thread producer([]()
+    {
+        test_sample_t sample = {0, {1, 2, 3}};
+
+        while(sample.seq < TEST_SAMPLES)
+        {
+            if(fifo.push(sample) == BVR_OK){sample.seq++;}
+            else{std::this_thread::yield();}
+        }
+    });
+
+    while(expected < TEST_SAMPLES)
+    {
+        std::size_t count = TEST_SAMPLES - expected;
+        if(count > 7){count = 7;}
+
+        if(fifo.pop(batch, count) != BVR_OK)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        for(std::size_t i = 0; i < count; i++)
+        {
+            CHECK(batch[i].seq == expected++);
+            CHECK(batch[i].axis[1] == 2);
+        }
+    }
+
+    producer.join();
+    CHECK(fifo.empty());
+}
+
+
+int main(void)
+{
+    test_wrap();
+    test_threads();
+    puts("test_fifo_cpp ok");
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
@@ -0,0 +1,258 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_fifo_dma.c
+* @brief    fifo_dma_t pushes and pops across the wrap on the simulated dma
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Blocks of varying size go in and out through host_dma_t engines,
+*       which copy on a worker thread and complete as an interrupt. The
+*       ring sits between guard bytes so a wrapped transfer that runs off
+*       the end is caught, and every block is checked byte for byte.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include "BVR_fifo_buffer.h"
+#include "host_dma.h"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+#define TEST_THRESHOLD  64
+#define TEST_MAX_BLOCK  300
+#define TEST_BLOCKS     3000
+#define TEST_GUARD      64
+
+static struct
+{
+    uint8_t before[TEST_GUARD];
+    uint8_t ring[1024];
+    uint8_t after[TEST_GUARD];
+}test_mem;
+
+static fifo_t test_fifo;
+static host_dma_t test_push_engine;
+static host_dma_t test_pop_engine;
+static fifo_dma_t test_push_dma;
+static fifo_dma_t test_pop_dma;
+static volatile int test_push_done;
+static volatile int test_pop_done;
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+static void test_push_cplt(host_dma_t *engine)
+{
+    (void)engine;
+    BVR_fifo_dma_complete(&test_push_dma);
+}
+
+
+static void test_pop_cplt(host_dma_t *engine)
+{
+    (void)engine;
+    BVR_fifo_dma_complete(&test_pop_dma);
+}
+
+
+static void test_pushed(fifo_t *fifo, int size)
+{
+    (void)fifo;
+    (void)size;
+    BVR_ATOMIC_ADD(&test_push_done, 1);
+}
+
+
+static void test_popped(fifo_t *fifo, int size)
+{
+    (void)fifo;
+    (void)size;
+    BVR_ATOMIC_ADD(&test_pop_done, 1);
+}
+
+
+static int test_size(uint32_t seq)
+{
+    // every third block is under the threshold and stays on the CPU
+    if((seq % 3) == 0){return 1 + (int)(seq % (TEST_THRESHOLD - 1));}
+    return TEST_THRESHOLD + (int)((seq * 37) % (TEST_MAX_BLOCK - TEST_THRESHOLD + 1));
+}
+
+
+static void test_fill(uint8_t *block, uint32_t seq, int size)
+{
+    int i;
+
+    for(i = 0; i < size; i++){block[i] = (uint8_t)((seq * 7) + i);}
+}
+
+
+static void test_guards(void)
+{
+    int i;
+
+    for(i = 0; i < TEST_GUARD; i++)
+    {
+        CHECK(test_mem.before[i] == 0xEE);
+        CHECK(test_mem.after[i] == 0xEE);
+    }
+}
+
+
+static void test_setup(int depth)
+{
+    memset(&test_mem, 0xEE, sizeof(test_mem));
+    CHECK(BVR_fifo_init(&test_fifo, test_mem.ring, depth) == BVR_OK);
+    CHECK(BVR_fifo_dma_init(&test_push_dma, host_dma_start, &test_push_engine,
+                            TEST_THRESHOLD, test_pushed) == BVR_OK);
+    CHECK(BVR_fifo_dma_init(&test_pop_dma, host_dma_start, &test_pop_engine,
+                            TEST_THRESHOLD, test_popped) == BVR_OK);
+    test_push_done = 0;
+    test_pop_done  = 0;
+}
+
+
+/* one block in, one block out, so every offset of the wrap comes round */
+static void test_in_turn(int depth)
+{
+    uint8_t block[TEST_MAX_BLOCK];
+    uint8_t out[TEST_MAX_BLOCK];
+    long transfers = test_push_engine.transfers + test_pop_engine.transfers;
+    long expected = 0;
+    int wrapped = 0;
+    int index = 5;
+    uint32_t seq;
+    int size;
+
+    test_setup(depth);
+
+    // keep a few bytes ahead of each block so it lands at a new offset
+    CHECK(BVR_fifo_push(&test_fifo, block, 5) == BVR_OK);
+
+    for(seq = 0; seq < TEST_BLOCKS; seq++)
+    {
+        size = test_size(seq);
+        test_fill(block, seq, size);
+
+        // a block over the end is two transfers each way
+        if(size >= TEST_THRESHOLD)
+        {
+            expected += 2;
+            if((depth - index) < size)
+            {
+                expected += 2;
+                wrapped++;
+            }
+        }
+
+        CHECK(BVR_fifo_push_dma(&test_push_dma, &test_fifo, block, size) == BVR_OK);
+        while(test_push_done != (int)seq + 1){sched_yield();}
+        CHECK(BVR_fifo_level(&test_fifo) == 5 + size);
+
+        memset(out, 0, sizeof(out));
+        CHECK(BVR_fifo_pop(&test_fifo, out, 5) == BVR_OK);
+        CHECK(BVR_fifo_pop_dma(&test_pop_dma, &test_fifo, out, size) == BVR_OK);
+        while(test_pop_done != (int)seq + 1){sched_yield();}
+        CHECK(memcmp(out, block, size) == 0);
+        CHECK(BVR_fifo_level(&test_fifo) == 0);
+        CHECK(BVR_fifo_push(&test_fifo, block, 5) == BVR_OK);
+        index = (index + size + 5) % depth;
+
+        test_guards();
+    }
+
+    CHECK(wrapped > 0);
+    CHECK((test_push_engine.transfers + test_pop_engine.transfers - transfers) == expected);
+}
+
+
+static void *test_producer(void *arg)
+{
+    uint8_t block[TEST_MAX_BLOCK];
+    uint32_t seq;
+    int size;
+
+    (void)arg;
+
+    for(seq = 0; seq < TEST_BLOCKS; seq++)
+    {
+        size = test_size(seq);
+        test_fill(block, seq, size);
+
+        // full, wait for the consumer
+        while(BVR_fifo_push_dma(&test_push_dma, &test_fifo, block, size) != BVR_OK)
+        {
+            sched_yield();
+        }
+        // block must stay put until the dma is done with it
+        while(test_push_done != (int)seq + 1){sched_yield();}
+    }
+
+    return NULL;
+}
+
+
+/* a producer thread and this thread both copying through their own dma */
+static void test_concurrent(int depth)
+{
+    pthread_t producer;
+    uint8_t expect[TEST_MAX_BLOCK];
+    uint8_t out[TEST_MAX_BLOCK];
+    uint32_t seq;
+    int size;
+
+    test_setup(depth);
+    CHECK(pthread_create(&producer, NULL, test_producer, NULL) == 0);
+
+    for(seq = 0; seq < TEST_BLOCKS; seq++)
+    {
+        size = test_size(seq);
+        test_fill(expect, seq, size);
+
+        while(BVR_fifo_level(&test_fifo) < size){sched_yield();}
+        CHECK(BVR_fifo_pop_dma(&test_pop_dma, &test_fifo, out, size) == BVR_OK);
+        while(test_pop_done != (int)seq + 1){sched_yield();}
+        CHECK(memcmp(out, expect, size) == 0);
+    }
+
+    pthread_join(producer, NULL);
+    CHECK(BVR_fifo_level(&test_fifo) == 0);
+    test_guards();
+}
+
+
+int main(void)
+{
+    CHECK(host_dma_init(&test_push_engine, test_push_cplt) == BVR_OK);
+    CHECK(host_dma_init(&test_pop_engine, test_pop_cplt) == BVR_OK);
+
+    test_in_turn(1024);
+    test_in_turn(1000);
+    test_concurrent(1024);
+    test_concurrent(997);
+
+    puts("test_fifo_dma ok");
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
@@ -0,0 +1,226 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_fifo_marks.c
+* @brief    high and low watermark callbacks and task notifications
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Built against bvr_utils_host_rtos (BVR_FIFO_RTOS set, host/freertos)
+*       for BVR_fifo_notify_task. Each crossing calls back once, with the
+*       low mark only after the high mark. Then a producer and a consumer
+*       thread both cross the marks at once and the counts have to pair up,
+*       and a task sleeps until the marks notify it.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <unistd.h>
+#include "BVR_fifo_buffer.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+#define TEST_DEPTH      100
+#define TEST_BYTES      (2L * 1024 * 1024)
+
+static fifo_t test_fifo;
+static uint8_t test_buffer[TEST_DEPTH];
+static int test_marks[2];
+static int test_level_at[2];
+static volatile uint32_t test_bits;
+static volatile int test_task_step;
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+static void test_on_mark(fifo_t *fifo, fifo_mark_t mark, void *ctx)
+{
+    CHECK(fifo == &test_fifo);
+    CHECK(ctx == test_marks);
+    BVR_ATOMIC_ADD(&test_marks[mark], 1);
+    test_level_at[mark] = BVR_fifo_level(fifo);
+}
+
+
+static void test_single(void)
+{
+    uint8_t data[TEST_DEPTH];
+    temp_buffer_t first;
+    temp_buffer_t second;
+
+    memset(data, 0x55, sizeof(data));
+    CHECK(BVR_fifo_init(&test_fifo, test_buffer, TEST_DEPTH) == BVR_OK);
+
+    // high 1 to depth, low under high, high 0 is off
+    CHECK(BVR_fifo_set_marks(&test_fifo, TEST_DEPTH + 1, 0, test_on_mark, test_marks) == BVR_ERROR);
+    CHECK(BVR_fifo_set_marks(&test_fifo, 50, 50, test_on_mark, test_marks) == BVR_ERROR);
+    CHECK(BVR_fifo_set_marks(&test_fifo, 50, -1, test_on_mark, test_marks) == BVR_ERROR);
+    CHECK(BVR_fifo_set_marks(&test_fifo, -1, 0, test_on_mark, test_marks) == BVR_ERROR);
+    CHECK(BVR_fifo_set_marks(&test_fifo, 80, 20, test_on_mark, test_marks) == BVR_OK);
+
+    // up to the mark, then past it, only the first crossing calls back
+    CHECK(BVR_fifo_push(&test_fifo, data, 79) == BVR_OK);
+    CHECK(test_marks[FIFO_MARK_HIGH] == 0);
+    CHECK(BVR_fifo_push(&test_fifo, data, 1) == BVR_OK);
+    CHECK(test_marks[FIFO_MARK_HIGH] == 1);
+    CHECK(test_level_at[FIFO_MARK_HIGH] == 80);
+    CHECK(BVR_fifo_push(&test_fifo, data, 10) == BVR_OK);
+    CHECK(test_marks[FIFO_MARK_HIGH] == 1);
+
+    // between the marks nothing happens either way
+    CHECK(BVR_fifo_pop(&test_fifo, data, 60) == BVR_OK);
+    CHECK(BVR_fifo_push(&test_fifo, data, 50) == BVR_OK);
+    CHECK(test_marks[FIFO_MARK_HIGH] == 1);
+    CHECK(test_marks[FIFO_MARK_LOW] == 0);
+
+    // down to the low mark, then further
+    CHECK(BVR_fifo_skip(&test_fifo, 60) == BVR_OK);
+    CHECK(test_marks[FIFO_MARK_LOW] == 1);
+    CHECK(test_level_at[FIFO_MARK_LOW] == 20);
+    CHECK(BVR_fifo_pop(&test_fifo, data, 20) == BVR_OK);
+    CHECK(test_marks[FIFO_MARK_LOW] == 1);
+
+    // falling under the low mark without reaching high first does nothing
+    CHECK(BVR_fifo_push(&test_fifo, data, 50) == BVR_OK);
+    CHECK(BVR_fifo_pop(&test_fifo, data, 50) == BVR_OK);
+    CHECK(test_marks[FIFO_MARK_LOW] == 1);
+
+    // a claim leaves the data counted, the release is what crosses
+    CHECK(BVR_fifo_push(&test_fifo, data, 90) == BVR_OK);
+    CHECK(test_marks[FIFO_MARK_HIGH] == 2);
+    first  = BVR_fifo_claim(&test_fifo);
+    second = BVR_fifo_claim(&test_fifo);
+    CHECK((first.buff_size + second.buff_size) == 90);
+    CHECK(test_marks[FIFO_MARK_LOW] == 1);
+    CHECK(BVR_fifo_release(&test_fifo, first.buff_size) == BVR_OK);
+    CHECK(BVR_fifo_release(&test_fifo, second.buff_size) == BVR_OK);
+    CHECK(test_marks[FIFO_MARK_LOW] == 2);
+
+    // off
+    CHECK(BVR_fifo_set_marks(&test_fifo, 0, 0, test_on_mark, test_marks) == BVR_OK);
+    CHECK(BVR_fifo_push(&test_fifo, data, TEST_DEPTH) == BVR_OK);
+    CHECK(test_marks[FIFO_MARK_HIGH] == 2);
+}
+
+
+static void *test_producer(void *arg)
+{
+    uint8_t chunk[37];
+    long sent = 0;
+
+    (void)arg;
+    memset(chunk, 0x66, sizeof(chunk));
+
+    while(sent < TEST_BYTES)
+    {
+        if(BVR_fifo_push(&test_fifo, chunk, sizeof(chunk)) == BVR_OK){sent += sizeof(chunk);}
+        else{sched_yield();}
+    }
+
+    return NULL;
+}
+
+
+/* both sides cross all the time, one call back per crossing */
+static void test_threads(void)
+{
+    pthread_t producer;
+    uint8_t chunk[23];
+    long received = 0;
+    int size;
+
+    CHECK(BVR_fifo_init(&test_fifo, test_buffer, TEST_DEPTH) == BVR_OK);
+    CHECK(BVR_fifo_set_marks(&test_fifo, 70, 30, test_on_mark, test_marks) == BVR_OK);
+    test_marks[FIFO_MARK_HIGH] = 0;
+    test_marks[FIFO_MARK_LOW]  = 0;
+    CHECK(pthread_create(&producer, NULL, test_producer, NULL) == 0);
+
+    while(received < TEST_BYTES)
+    {
+        size = (int)sizeof(chunk);
+        if(size > (TEST_BYTES - received)){size = (int)(TEST_BYTES - received);}
+        if(BVR_fifo_pop(&test_fifo, chunk, size) == BVR_OK){received += size;}
+        else{sched_yield();}
+    }
+
+    pthread_join(producer, NULL);
+
+    // the fifo ended empty so every high has had its low
+    CHECK(test_marks[FIFO_MARK_HIGH] > 0);
+    CHECK(test_marks[FIFO_MARK_HIGH] == test_marks[FIFO_MARK_LOW]);
+}
+
+
+static void test_task(void *argument)
+{
+    uint32_t bits;
+
+    (void)argument;
+
+    CHECK(BVR_fifo_notify_task(&test_fifo, 60, 10, xTaskGetCurrentTaskHandle()) == BVR_OK);
+    test_task_step = 1;
+
+    while(test_task_step < 3)
+    {
+        if(xTaskNotifyWait(0x00, 0xFFFFFFFF, &bits, 1000) == pdTRUE)
+        {
+            test_bits |= bits;
+            test_task_step++;
+        }
+    }
+}
+
+
+static void test_notify(void)
+{
+    uint8_t data[TEST_DEPTH];
+
+    CHECK(BVR_fifo_init(&test_fifo, test_buffer, TEST_DEPTH) == BVR_OK);
+    CHECK(BVR_fifo_notify_task(&test_fifo, 60, 10, NULL) == BVR_ERROR);
+    test_task_step = 0;
+    test_bits = 0;
+    CHECK(xTaskCreate(test_task, "marks", 256, NULL, 1, NULL) == pdPASS);
+    while(test_task_step == 0){usleep(1000);}
+
+    CHECK(BVR_fifo_push(&test_fifo, data, 60) == BVR_OK);
+    while(test_task_step == 1){usleep(1000);}
+    CHECK(test_bits == FIFO_NOTIFY_HIGH);
+
+    CHECK(BVR_fifo_pop(&test_fifo, data, 50) == BVR_OK);
+    while(test_task_step == 2){usleep(1000);}
+    CHECK(test_bits == (FIFO_NOTIFY_HIGH | FIFO_NOTIFY_LOW));
+}
+
+
+int main(void)
+{
+    test_single();
+    test_threads();
+    test_notify();
+
+    puts("test_fifo_marks ok");
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
@@ -0,0 +1,222 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_fifo_mp.c
+* @brief    multi producer fifo torture test
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Several threads push numbered records of different lengths into one
+*       BVR_fifo_init_mp fifo while one thread pops them. Every record must
+*       come out whole, once, and in order for its producer.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+#include "BVR_fifo_buffer.h"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+#define TEST_PRODUCERS  4
+#define TEST_RECORDS    20000
+#define TEST_HEADER     6       /* id, length, 32 bit sequence */
+#define TEST_MAX_RECORD 40
+
+static fifo_t test_fifo;
+static uint8_t test_buffer[1000];
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+static int test_length(uint32_t seq)
+{
+    return TEST_HEADER + (int)(seq % (TEST_MAX_RECORD - TEST_HEADER + 1));
+}
+
+
+static void *test_producer(void *arg)
+{
+    uint8_t record[TEST_MAX_RECORD];
+    uint8_t id = (uint8_t)(uintptr_t)arg;
+    uint32_t seq;
+    int length;
+    int i;
+
+    for(seq = 0; seq < TEST_RECORDS; seq++)
+    {
+        length = test_length(seq);
+        record[0] = id;
+        record[1] = (uint8_t)length;
+        memcpy(&record[2], &seq, 4);
+        for(i = TEST_HEADER; i < length; i++){record[i] = (uint8_t)(id ^ seq ^ i);}
+
+        // full or out of commit slots, let the consumer run
+        while(BVR_fifo_push_mp(&test_fifo, record, length) != BVR_OK)
+        {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+
+static void test_torture(void)
+{
+    pthread_t producers[TEST_PRODUCERS];
+    uint32_t expected[TEST_PRODUCERS] = {0};
+    uint8_t record[TEST_MAX_RECORD];
+    long received = 0;
+    uint32_t seq;
+    struct timespec start;
+    struct timespec end;
+    double seconds;
+    int i;
+
+    CHECK(BVR_fifo_init_mp(&test_fifo, test_buffer, sizeof(test_buffer)) == BVR_OK);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(i = 0; i < TEST_PRODUCERS; i++)
+    {
+        CHECK(pthread_create(&producers[i], NULL, test_producer, (void *)(uintptr_t)i) == 0);
+    }
+
+    while(received < (long)TEST_PRODUCERS * TEST_RECORDS)
+    {
+        if(BVR_fifo_level(&test_fifo) < 2)
+        {
+            sched_yield();
+            continue;
+        }
+
+        // a published header means the whole record is published
+        CHECK(BVR_fifo_pop(&test_fifo, record, 2) == BVR_OK);
+        CHECK(record[0] < TEST_PRODUCERS);
+        CHECK((record[1] >= TEST_HEADER) && (record[1] <= TEST_MAX_RECORD));
+        CHECK(BVR_fifo_pop(&test_fifo, record + 2, record[1] - 2) == BVR_OK);
+
+        memcpy(&seq, &record[2], 4);
+        CHECK(seq == expected[record[0]]);
+        CHECK(record[1] == test_length(seq));
+        for(i = TEST_HEADER; i < record[1]; i++)
+        {
+            CHECK(record[i] == (uint8_t)(record[0] ^ seq ^ i));
+        }
+
+        expected[record[0]]++;
+        received++;
+    }
+
+    for(i = 0; i < TEST_PRODUCERS; i++)
+    {
+        pthread_join(producers[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    CHECK(BVR_fifo_level(&test_fifo) == 0);
+
+    // preempted writers must not stall everyone else, this was ~1k/s when they did
+    seconds = (end.tv_sec - start.tv_sec) + ((end.tv_nsec - start.tv_nsec) / 1e9);
+    printf("mp torture: %ld records in %.3f s (%.0f/s)\n", received, seconds, received / seconds);
+    CHECK((received / seconds) > 20000.0);
+}
+
+
+static void test_failed_push(void)
+{
+    uint8_t data[64];
+    uint32_t msgs;
+
+    memset(data, 0xA5, sizeof(data));
+    CHECK(BVR_fifo_init_mp(&test_fifo, test_buffer, 100) == BVR_OK);
+
+    // a rejected push takes no ticket so it holds nothing back
+    CHECK(BVR_fifo_push_mp(&test_fifo, data, 64) == BVR_OK);
+    CHECK(BVR_fifo_push_mp(&test_fifo, data, 64) == BVR_ERROR);
+    CHECK(BVR_fifo_push_mp(&test_fifo, data, 30) == BVR_OK);
+    CHECK(BVR_fifo_level(&test_fifo) == 94);
+
+    CHECK(BVR_fifo_pop(&test_fifo, data, 64) == BVR_OK);
+    CHECK(BVR_fifo_push_mp(&test_fifo, data, 60) == BVR_OK);
+    CHECK(BVR_fifo_level(&test_fifo) == 90);
+
+    BVR_fifo_get_drops(&test_fifo, &msgs, NULL);
+    CHECK(msgs == 1);
+}
+
+
+static BVR_status_t test_dma_start(void *dst, const void *src, int size, void *engine)
+{
+    (void)dst;
+    (void)src;
+    (void)size;
+    (void)engine;
+    return BVR_ERROR;
+}
+
+
+static void test_single_producer_calls(void)
+{
+    record_fifo_t rec;
+    fifo_dma_t dma;
+    prio_fifo_t prio;
+    fifo_t *lanes[1] = {&test_fifo};
+    const uint8_t weights[1] = {1};
+    struct bvr_iov iov = {test_buffer, 4};
+    uint8_t data[8] = {0};
+    temp_buffer_t span;
+
+    CHECK(BVR_fifo_init_mp(&test_fifo, test_buffer, 100) == BVR_OK);
+
+    // the head only moves through BVR_fifo_push_mp
+    CHECK(BVR_fifo_push(&test_fifo, data, 4) == BVR_ERROR);
+    CHECK(BVR_fifo_pushv(&test_fifo, &iov, 1) == BVR_ERROR);
+    span = BVR_fifo_reserve(&test_fifo, 16);
+    CHECK((span.p_temp_buff == NULL) && (span.buff_size == 0));
+    CHECK(BVR_fifo_commit(&test_fifo, 0) == BVR_ERROR);
+    CHECK(BVR_fifo_dma_init(&dma, test_dma_start, NULL, 0, NULL) == BVR_OK);
+    CHECK(BVR_fifo_push_dma(&dma, &test_fifo, data, 4) == BVR_ERROR);
+    CHECK(BVR_fifo_level(&test_fifo) == 0);
+
+    CHECK(BVR_record_init(&rec, test_buffer, 100) == BVR_OK);
+    rec.fifo.ctrl.mp = 0x01;
+    CHECK(BVR_record_push(&rec, data, 4) == BVR_ERROR);
+
+    // a prio lane set up for several producers is pushed the mp way
+    CHECK(BVR_fifo_init_mp(&test_fifo, test_buffer, 100) == BVR_OK);
+    CHECK(BVR_prio_init(&prio, lanes, weights, 1) == BVR_OK);
+    CHECK(BVR_prio_push(&prio, 0, data, 4) == BVR_OK);
+    CHECK(BVR_fifo_level(&test_fifo) == 4);
+}
+
+
+int main(void)
+{
+    test_single_producer_calls();
+    test_failed_push();
+    test_torture();
+    puts("test_fifo_mp ok");
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
@@ -0,0 +1,188 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_fifo_peek.c
+* @brief    peek, skip and find for parsing in place
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Bounds and the wrap checked on one thread, then a producer thread
+*       pushes newline terminated lines in odd sized pieces while this
+*       thread finds each newline, peeks the line out and skips it, the way
+*       a command parser reads a uart rx fifo.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <string.h>
+#include "BVR_fifo_buffer.h"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+#define TEST_DEPTH      50
+#define TEST_LINES      100000
+#define TEST_MAX_LINE   24
+
+static fifo_t test_fifo;
+static uint8_t test_buffer[TEST_DEPTH];
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+static void test_single(void)
+{
+    uint8_t data[TEST_DEPTH];
+    uint8_t out[TEST_DEPTH];
+    int i;
+
+    for(i = 0; i < TEST_DEPTH; i++){data[i] = (uint8_t)i;}
+    CHECK(BVR_fifo_init(&test_fifo, test_buffer, TEST_DEPTH) == BVR_OK);
+
+    // empty
+    CHECK(BVR_fifo_find(&test_fifo, 0, 0) == -1);
+    CHECK(BVR_fifo_peek(&test_fifo, 0, out, 1) == BVR_ERROR);
+    CHECK(BVR_fifo_peek(&test_fifo, 0, out, 0) == BVR_OK);
+    CHECK(BVR_fifo_skip(&test_fifo, 1) == BVR_ERROR);
+
+    // 0..39 stored from index 30, so 20 before the end and 20 after
+    CHECK(BVR_fifo_push(&test_fifo, data, 30) == BVR_OK);
+    CHECK(BVR_fifo_skip(&test_fifo, 30) == BVR_OK);
+    CHECK(BVR_fifo_push(&test_fifo, data, 40) == BVR_OK);
+
+    // nothing is removed
+    CHECK(BVR_fifo_peek(&test_fifo, 15, out, 10) == BVR_OK);
+    for(i = 0; i < 10; i++){CHECK(out[i] == (uint8_t)(15 + i));}
+    CHECK(BVR_fifo_level(&test_fifo) == 40);
+    CHECK(BVR_fifo_peek(&test_fifo, 30, out, 10) == BVR_OK);
+    CHECK(BVR_fifo_peek(&test_fifo, 30, out, 11) == BVR_ERROR);
+    CHECK(BVR_fifo_peek(&test_fifo, -1, out, 1) == BVR_ERROR);
+    CHECK(BVR_fifo_peek(&test_fifo, 0, out, -1) == BVR_ERROR);
+
+    // found before the wrap, after it, from an offset and not at all
+    CHECK(BVR_fifo_find(&test_fifo, 0, 5) == 5);
+    CHECK(BVR_fifo_find(&test_fifo, 0, 25) == 25);
+    CHECK(BVR_fifo_find(&test_fifo, 22, 25) == 25);
+    CHECK(BVR_fifo_find(&test_fifo, 6, 5) == -1);
+    CHECK(BVR_fifo_find(&test_fifo, 0, 40) == -1);
+    CHECK(BVR_fifo_find(&test_fifo, 39, 39) == 39);
+    CHECK(BVR_fifo_find(&test_fifo, 40, 39) == -1);
+    CHECK(BVR_fifo_find(&test_fifo, -1, 0) == -1);
+
+    // skipped bytes are gone, the space is free again
+    CHECK(BVR_fifo_skip(&test_fifo, 41) == BVR_ERROR);
+    CHECK(BVR_fifo_skip(&test_fifo, -1) == BVR_ERROR);
+    CHECK(BVR_fifo_skip(&test_fifo, 24) == BVR_OK);
+    CHECK(BVR_fifo_find(&test_fifo, 0, 25) == 1);
+    CHECK(BVR_fifo_space(&test_fifo) == 34);
+    CHECK(BVR_fifo_skip(&test_fifo, 0) == BVR_OK);
+    CHECK(BVR_fifo_skip(&test_fifo, 16) == BVR_OK);
+    CHECK(BVR_fifo_level(&test_fifo) == 0);
+}
+
+
+/* line seq is "L<seq>" padded with '.' to a length that changes each line */
+static int test_line(char *line, uint32_t seq)
+{
+    int size = snprintf(line, TEST_MAX_LINE, "L%lu", (unsigned long)seq);
+
+    while(size < (int)(8 + (seq % 14))){line[size++] = '.';}
+    line[size++] = '\n';
+    return size;
+}
+
+
+static void *test_producer(void *arg)
+{
+    char line[TEST_MAX_LINE];
+    uint32_t seq;
+    int size;
+    int sent;
+    int piece;
+
+    (void)arg;
+
+    for(seq = 0; seq < TEST_LINES; seq++)
+    {
+        size = test_line(line, seq);
+
+        // the consumer sees lines arrive a few bytes at a time
+        for(sent = 0; sent < size; sent += piece)
+        {
+            piece = 1 + (int)((seq + sent) % 5);
+            if(piece > (size - sent)){piece = size - sent;}
+            while(BVR_fifo_push(&test_fifo, (uint8_t *)&line[sent], piece) != BVR_OK){sched_yield();}
+        }
+    }
+
+    return NULL;
+}
+
+
+static void test_threads(void)
+{
+    pthread_t producer;
+    char expect[TEST_MAX_LINE];
+    uint8_t line[TEST_MAX_LINE];
+    uint32_t seq = 0;
+    int searched = 0;
+    int level;
+    int end;
+
+    CHECK(BVR_fifo_init(&test_fifo, test_buffer, TEST_DEPTH) == BVR_OK);
+    CHECK(pthread_create(&producer, NULL, test_producer, NULL) == 0);
+
+    while(seq < TEST_LINES)
+    {
+        // carry on from where the last search stopped, at least the level
+        // taken before the search has been looked at
+        level = BVR_fifo_level(&test_fifo);
+        end   = BVR_fifo_find(&test_fifo, searched, '\n');
+        if(end < 0)
+        {
+            searched = level;
+            sched_yield();
+            continue;
+        }
+
+        CHECK((end + 1) == test_line(expect, seq));
+        CHECK(BVR_fifo_peek(&test_fifo, 0, line, end + 1) == BVR_OK);
+        CHECK(memcmp(line, expect, end + 1) == 0);
+        CHECK(BVR_fifo_skip(&test_fifo, end + 1) == BVR_OK);
+        searched = 0;
+        seq++;
+    }
+
+    pthread_join(producer, NULL);
+    CHECK(BVR_fifo_level(&test_fifo) == 0);
+}
+
+
+int main(void)
+{
+    test_single();
+    test_threads();
+
+    puts("test_fifo_peek ok");
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
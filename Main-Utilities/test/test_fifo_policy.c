@@ -0,0 +1,270 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_fifo_policy.c
+* @brief    overflow policies, what a push into a full fifo does
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Built against bvr_utils_host_rtos (BVR_FIFO_RTOS set, host/freertos)
+*       so FIFO_BLOCK can wait. REJECT, OVERWRITE and TRUNCATE are checked
+*       on one thread for what is kept and what is counted as dropped, the
+*       calls an overwrite fifo refuses are checked too. FIFO_BLOCK pushes
+*       from a task while this thread pops, then times out with no consumer
+*       and does not wait at all from an "interrupt".
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <sched.h>
+#include <string.h>
+#include <unistd.h>
+#include "BVR_fifo_buffer.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "host_hal.h"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+#define TEST_DEPTH      64
+#define TEST_BLOCKS     2000
+
+static fifo_t test_fifo;
+static uint8_t test_buffer[TEST_DEPTH];
+static volatile int test_task_done;
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+static void test_drops(uint32_t msgs, uint32_t bytes)
+{
+    uint32_t got_msgs;
+    uint32_t got_bytes;
+
+    BVR_fifo_get_drops(&test_fifo, &got_msgs, &got_bytes);
+    CHECK(got_msgs == msgs);
+    CHECK(got_bytes == bytes);
+}
+
+
+static void test_reject(void)
+{
+    uint8_t data[TEST_DEPTH];
+    uint8_t out[TEST_DEPTH];
+
+    memset(data, 0x11, sizeof(data));
+    CHECK(BVR_fifo_init(&test_fifo, test_buffer, TEST_DEPTH) == BVR_OK);
+    CHECK(test_fifo.ctrl.policy == FIFO_REJECT);
+    CHECK(BVR_fifo_set_policy(&test_fifo, (fifo_policy_t)(FIFO_BLOCK + 1), 0) == BVR_ERROR);
+
+    // nothing of a message that does not fit is written
+    CHECK(BVR_fifo_push(&test_fifo, data, 50) == BVR_OK);
+    CHECK(BVR_fifo_push(&test_fifo, data, 15) == BVR_ERROR);
+    CHECK(BVR_fifo_level(&test_fifo) == 50);
+    test_drops(1, 15);
+
+    CHECK(BVR_fifo_push(&test_fifo, data, 14) == BVR_OK);
+    CHECK(BVR_fifo_pop(&test_fifo, out, TEST_DEPTH) == BVR_OK);
+}
+
+
+/* no engine, every copy falls back to the CPU */
+static BVR_status_t test_dma_start(void *dst, const void *src, int size, void *engine)
+{
+    (void)dst;
+    (void)src;
+    (void)size;
+    (void)engine;
+    return BVR_ERROR;
+}
+
+
+static void test_overwrite(void)
+{
+    uint8_t data[TEST_DEPTH + 1];
+    uint8_t out[TEST_DEPTH];
+    fifo_dma_t dma;
+    fifo_t mp_fifo;
+    int i;
+
+    for(i = 0; i <= TEST_DEPTH; i++){data[i] = (uint8_t)i;}
+    CHECK(BVR_fifo_init(&test_fifo, test_buffer, TEST_DEPTH) == BVR_OK);
+    CHECK(BVR_fifo_set_policy(&test_fifo, FIFO_OVERWRITE, 0) == BVR_OK);
+
+    // the oldest bytes go to make room, one message per push that overwrote
+    CHECK(BVR_fifo_push(&test_fifo, data, 40) == BVR_OK);
+    CHECK(BVR_fifo_push(&test_fifo, data + 40, 20) == BVR_OK);
+    CHECK(BVR_fifo_push(&test_fifo, data, 10) == BVR_OK);
+    CHECK(BVR_fifo_level(&test_fifo) == TEST_DEPTH);
+    test_drops(1, 6);
+
+    CHECK(BVR_fifo_pop(&test_fifo, out, TEST_DEPTH) == BVR_OK);
+    for(i = 0; i < 54; i++){CHECK(out[i] == (uint8_t)(i + 6));}
+    for(i = 0; i < 10; i++){CHECK(out[54 + i] == (uint8_t)i);}
+
+    // a full ring of new data replaces all of it, more than that is rejected
+    CHECK(BVR_fifo_push(&test_fifo, data, 30) == BVR_OK);
+    CHECK(BVR_fifo_push(&test_fifo, data + 1, TEST_DEPTH) == BVR_OK);
+    test_drops(2, 36);
+    CHECK(BVR_fifo_push(&test_fifo, data, TEST_DEPTH + 1) == BVR_ERROR);
+    test_drops(3, 36 + TEST_DEPTH + 1);
+    CHECK(BVR_fifo_pop(&test_fifo, out, TEST_DEPTH) == BVR_OK);
+    CHECK(memcmp(out, data + 1, TEST_DEPTH) == 0);
+
+    // the calls that hold the tail across a push refuse an overwrite fifo,
+    // the record pops are covered in test_record
+    CHECK(BVR_fifo_push(&test_fifo, data, 10) == BVR_OK);
+    CHECK(BVR_fifo_claim(&test_fifo).p_temp_buff == NULL);
+    CHECK(BVR_fifo_release(&test_fifo, 0) == BVR_ERROR);
+    CHECK(BVR_fifo_dma_init(&dma, test_dma_start, NULL, 1, NULL) == BVR_OK);
+    CHECK(BVR_fifo_pop_dma(&dma, &test_fifo, out, 10) == BVR_ERROR);
+    CHECK(BVR_fifo_level(&test_fifo) == 10);
+
+    // peek, skip and pop still work
+    CHECK(BVR_fifo_peek(&test_fifo, 2, out, 1) == BVR_OK);
+    CHECK(out[0] == 2);
+    CHECK(BVR_fifo_skip(&test_fifo, 5) == BVR_OK);
+    CHECK(BVR_fifo_pop(&test_fifo, out, 5) == BVR_OK);
+    CHECK(out[0] == 5);
+
+    // the producer would move the tail under the other producers
+    CHECK(BVR_fifo_init_mp(&mp_fifo, test_buffer, TEST_DEPTH) == BVR_OK);
+    CHECK(BVR_fifo_set_policy(&mp_fifo, FIFO_OVERWRITE, 0) == BVR_ERROR);
+}
+
+
+static void test_truncate(void)
+{
+    uint8_t data[TEST_DEPTH];
+    uint8_t out[TEST_DEPTH];
+    int i;
+
+    for(i = 0; i < TEST_DEPTH; i++){data[i] = (uint8_t)i;}
+    CHECK(BVR_fifo_init(&test_fifo, test_buffer, TEST_DEPTH) == BVR_OK);
+    CHECK(BVR_fifo_set_policy(&test_fifo, FIFO_TRUNCATE, 0) == BVR_OK);
+
+    // what fits goes in, the rest is counted as bytes not messages
+    CHECK(BVR_fifo_push(&test_fifo, data, 44) == BVR_OK);
+    CHECK(BVR_fifo_push(&test_fifo, data, 30) == BVR_ERROR);
+    CHECK(BVR_fifo_level(&test_fifo) == TEST_DEPTH);
+    test_drops(0, 10);
+
+    // full, nothing fits so the whole message is dropped
+    CHECK(BVR_fifo_push(&test_fifo, data, 5) == BVR_ERROR);
+    test_drops(1, 15);
+
+    CHECK(BVR_fifo_pop(&test_fifo, out, TEST_DEPTH) == BVR_OK);
+    CHECK(memcmp(out + 44, data, 20) == 0);
+}
+
+
+static void test_block_producer(void *argument)
+{
+    uint8_t block[TEST_DEPTH];
+    uint32_t seq;
+    int size;
+    int i;
+
+    (void)argument;
+
+    for(seq = 0; seq < TEST_BLOCKS; seq++)
+    {
+        size = 1 + (int)((seq * 13) % TEST_DEPTH);
+        for(i = 0; i < size; i++){block[i] = (uint8_t)(seq + i);}
+        // never full for longer than the consumer takes to pop
+        CHECK(BVR_fifo_push(&test_fifo, block, size) == BVR_OK);
+    }
+
+    test_task_done = 1;
+}
+
+
+static void test_block_timeout(void *argument)
+{
+    uint8_t data[TEST_DEPTH];
+    uint32_t start;
+
+    (void)argument;
+    memset(data, 0x22, sizeof(data));
+
+    // nobody pops, the push gives up after the timeout
+    CHECK(BVR_fifo_push(&test_fifo, data, TEST_DEPTH) == BVR_OK);
+    start = HAL_GetTick();
+    CHECK(BVR_fifo_push(&test_fifo, data, 1) == BVR_ERROR);
+    CHECK((HAL_GetTick() - start) >= 30);
+    test_drops(1, 1);
+
+    // an interrupt never waits
+    host_ipsr = 1;
+    start = HAL_GetTick();
+    CHECK(BVR_fifo_push(&test_fifo, data, 1) == BVR_ERROR);
+    CHECK((HAL_GetTick() - start) < 30);
+    host_ipsr = 0;
+    test_drops(2, 2);
+
+    test_task_done = 1;
+}
+
+
+static void test_block(void)
+{
+    uint8_t block[TEST_DEPTH];
+    uint32_t seq;
+    int size;
+    int i;
+
+    // a producer task that sleeps on a full fifo until this thread pops
+    CHECK(BVR_fifo_init(&test_fifo, test_buffer, TEST_DEPTH) == BVR_OK);
+    CHECK(BVR_fifo_set_policy(&test_fifo, FIFO_BLOCK, 1000) == BVR_OK);
+    test_task_done = 0;
+    CHECK(xTaskCreate(test_block_producer, "producer", 256, NULL, 1, NULL) == pdPASS);
+
+    for(seq = 0; seq < TEST_BLOCKS; seq++)
+    {
+        size = 1 + (int)((seq * 13) % TEST_DEPTH);
+        while(BVR_fifo_pop(&test_fifo, block, size) != BVR_OK){sched_yield();}
+        for(i = 0; i < size; i++){CHECK(block[i] == (uint8_t)(seq + i));}
+
+        // let the fifo fill so the producer has to wait
+        if((seq % 100) == 0){usleep(2000);}
+    }
+
+    while(!test_task_done){sched_yield();}
+    test_drops(0, 0);
+
+    CHECK(BVR_fifo_init(&test_fifo, test_buffer, TEST_DEPTH) == BVR_OK);
+    CHECK(BVR_fifo_set_policy(&test_fifo, FIFO_BLOCK, 30) == BVR_OK);
+    test_task_done = 0;
+    CHECK(xTaskCreate(test_block_timeout, "timeout", 256, NULL, 1, NULL) == pdPASS);
+    while(!test_task_done){usleep(1000);}
+}
+
+
+int main(void)
+{
+    test_reject();
+    test_overwrite();
+    test_truncate();
+    test_block();
+
+    puts("test_fifo_policy ok");
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
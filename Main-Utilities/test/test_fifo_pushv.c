@@ -0,0 +1,187 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_fifo_pushv.c
+* @brief    scatter gather push is one write, over the wrap and across threads
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Pieces of every size, empty ones too, are pushed as one write and
+*       read back joined up. A producer thread then pushes header, payload
+*       and trailer as three pieces while this thread watches the level,
+*       any byte of a frame that is visible means all of it is.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include "BVR_fifo_buffer.h"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+#define TEST_DEPTH      100
+#define TEST_FRAMES     200000
+#define TEST_MAX_DATA   40
+
+static fifo_t test_fifo;
+static uint8_t test_buffer[TEST_DEPTH];
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+static void test_single(void)
+{
+    uint8_t a[30];
+    uint8_t b[50];
+    uint8_t out[TEST_DEPTH];
+    bvr_iov_t iov[4];
+    uint32_t msgs;
+    uint32_t bytes;
+    fifo_t mp_fifo;
+    int i;
+
+    for(i = 0; i < 30; i++){a[i] = (uint8_t)i;}
+    for(i = 0; i < 50; i++){b[i] = (uint8_t)(30 + i);}
+    CHECK(BVR_fifo_init(&test_fifo, test_buffer, TEST_DEPTH) == BVR_OK);
+
+    // no pieces and empty pieces push nothing and succeed
+    CHECK(BVR_fifo_pushv(&test_fifo, iov, 0) == BVR_OK);
+    iov[0].base = a;
+    iov[0].len  = 0;
+    CHECK(BVR_fifo_pushv(&test_fifo, iov, 1) == BVR_OK);
+    CHECK(BVR_fifo_level(&test_fifo) == 0);
+
+    // move the head on so the pieces run over the wrap
+    CHECK(BVR_fifo_push(&test_fifo, b, 45) == BVR_OK);
+    CHECK(BVR_fifo_pop(&test_fifo, out, 45) == BVR_OK);
+
+    iov[0].base = a;
+    iov[0].len  = 30;
+    iov[1].base = b;
+    iov[1].len  = 0;
+    iov[2].base = b;
+    iov[2].len  = 50;
+    iov[3].base = a;
+    iov[3].len  = 5;
+    CHECK(BVR_fifo_pushv(&test_fifo, iov, 4) == BVR_OK);
+    CHECK(BVR_fifo_level(&test_fifo) == 85);
+
+    CHECK(BVR_fifo_pop(&test_fifo, out, 85) == BVR_OK);
+    for(i = 0; i < 80; i++){CHECK(out[i] == (uint8_t)i);}
+    for(i = 0; i < 5; i++){CHECK(out[80 + i] == (uint8_t)i);}
+
+    // all or nothing, one dropped message of every byte
+    CHECK(BVR_fifo_push(&test_fifo, a, 20) == BVR_OK);
+    CHECK(BVR_fifo_pushv(&test_fifo, iov, 4) == BVR_ERROR);
+    CHECK(BVR_fifo_level(&test_fifo) == 20);
+    BVR_fifo_get_drops(&test_fifo, &msgs, &bytes);
+    CHECK(msgs == 1);
+    CHECK(bytes == 85);
+
+    // one head update can not cover writes from several producers
+    CHECK(BVR_fifo_init_mp(&mp_fifo, test_buffer, TEST_DEPTH) == BVR_OK);
+    CHECK(BVR_fifo_pushv(&mp_fifo, iov, 1) == BVR_ERROR);
+}
+
+
+static void *test_producer(void *arg)
+{
+    uint8_t header[2];
+    uint8_t data[TEST_MAX_DATA];
+    uint8_t trailer;
+    bvr_iov_t iov[3];
+    uint32_t seq;
+    int size;
+    int i;
+
+    (void)arg;
+
+    iov[0].base = header;
+    iov[0].len  = sizeof(header);
+    iov[1].base = data;
+    iov[2].base = &trailer;
+    iov[2].len  = 1;
+
+    for(seq = 0; seq < TEST_FRAMES; seq++)
+    {
+        size = (int)(seq % TEST_MAX_DATA);
+        header[0] = (uint8_t)size;
+        header[1] = (uint8_t)seq;
+        for(i = 0; i < size; i++){data[i] = (uint8_t)(seq + i);}
+        trailer     = (uint8_t)~seq;
+        iov[1].len  = size;
+
+        while(BVR_fifo_pushv(&test_fifo, iov, 3) != BVR_OK){sched_yield();}
+    }
+
+    return NULL;
+}
+
+
+static void test_threads(void)
+{
+    pthread_t producer;
+    uint8_t frame[2 + TEST_MAX_DATA + 1];
+    uint32_t seq = 0;
+    int level;
+    int size;
+    int i;
+
+    CHECK(BVR_fifo_init(&test_fifo, test_buffer, TEST_DEPTH) == BVR_OK);
+    CHECK(pthread_create(&producer, NULL, test_producer, NULL) == 0);
+
+    while(seq < TEST_FRAMES)
+    {
+        level = BVR_fifo_level(&test_fifo);
+        if(level == 0)
+        {
+            sched_yield();
+            continue;
+        }
+
+        // the header is there so the whole frame must be
+        CHECK(BVR_fifo_peek(&test_fifo, 0, frame, 1) == BVR_OK);
+        size = frame[0];
+        CHECK(level >= (2 + size + 1));
+
+        CHECK(BVR_fifo_pop(&test_fifo, frame, 2 + size + 1) == BVR_OK);
+        CHECK(size == (int)(seq % TEST_MAX_DATA));
+        CHECK(frame[1] == (uint8_t)seq);
+        for(i = 0; i < size; i++){CHECK(frame[2 + i] == (uint8_t)(seq + i));}
+        CHECK(frame[2 + size] == (uint8_t)~seq);
+        seq++;
+    }
+
+    pthread_join(producer, NULL);
+    CHECK(BVR_fifo_level(&test_fifo) == 0);
+}
+
+
+int main(void)
+{
+    test_single();
+    test_threads();
+
+    puts("test_fifo_pushv ok");
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
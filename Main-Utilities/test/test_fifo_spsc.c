@@ -0,0 +1,107 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_fifo_spsc.c
+* @brief    single producer single consumer fifo stress test
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       One thread pushes a counting byte stream in chunks of varying size
+*       while another pops it in chunks of a different size, with no lock
+*       between them. Every byte has to come out once and in order.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <pthread.h>
+#include <sched.h>
+#include "BVR_fifo_buffer.h"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+#define TEST_BYTES      (4L * 1024 * 1024)
+#define TEST_MAX_CHUNK  61
+
+static fifo_t test_fifo;
+static uint8_t test_buffer[509];
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+static void *test_producer(void *arg)
+{
+    uint8_t chunk[TEST_MAX_CHUNK];
+    long sent = 0;
+    int size;
+    int i;
+
+    (void)arg;
+
+    while(sent < TEST_BYTES)
+    {
+        size = 1 + (int)(sent % TEST_MAX_CHUNK);
+        if(size > (TEST_BYTES - sent)){size = (int)(TEST_BYTES - sent);}
+        for(i = 0; i < size; i++){chunk[i] = (uint8_t)(sent + i);}
+
+        if(BVR_fifo_push(&test_fifo, chunk, size) == BVR_OK){sent += size;}
+        else{sched_yield();}
+    }
+
+    return NULL;
+}
+
+
+int main(void)
+{
+    pthread_t producer;
+    uint8_t chunk[TEST_MAX_CHUNK];
+    long received = 0;
+    int size;
+    int i;
+
+    CHECK(BVR_fifo_init(&test_fifo, test_buffer, sizeof(test_buffer)) == BVR_OK);
+    CHECK(pthread_create(&producer, NULL, test_producer, NULL) == 0);
+
+    while(received < TEST_BYTES)
+    {
+        size = 1 + (int)((received / 7) % 37);
+        if(size > (TEST_BYTES - received)){size = (int)(TEST_BYTES - received);}
+
+        // a failed pop must leave the fifo as it was
+        if(BVR_fifo_pop(&test_fifo, chunk, size) != BVR_OK)
+        {
+            sched_yield();
+            continue;
+        }
+
+        for(i = 0; i < size; i++)
+        {
+            CHECK(chunk[i] == (uint8_t)(received + i));
+        }
+        received += size;
+    }
+
+    pthread_join(producer, NULL);
+    CHECK(BVR_fifo_level(&test_fifo) == 0);
+
+    puts("test_fifo_spsc ok");
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
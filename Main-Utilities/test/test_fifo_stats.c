@@ -0,0 +1,164 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_fifo_stats.c
+* @brief    fifo statistics counters and BVR_fifo_dump_stats
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Built against bvr_utils_host_stats (BVR_FIFO_STATS set). Every
+*       counter is checked after a known run of pushes, pops, claims and
+*       failures, then the dump is read back from the debug uart.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <string.h>
+#include <unistd.h>
+#include "BVR_fifo_buffer.h"
+#include "BVR_debug_logger.h"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+#define TEST_DEPTH  64
+
+static fifo_t test_fifo;
+static fifo_t test_other;
+static uint8_t test_buffer[TEST_DEPTH];
+static uint8_t test_other_buffer[16];
+static char test_out[4096];
+static int test_out_len = 0;
+static volatile int test_pending = 0;
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+/* keep what was sent, the test completes the transfer */
+static void test_uart_tx(UART_HandleTypeDef *huart, const uint8_t *p_data, uint16_t size)
+{
+    UNUSED(huart);
+    CHECK((test_out_len + size) < (int)sizeof(test_out));
+    memcpy(&test_out[test_out_len], p_data, size);
+    test_out_len += size;
+    test_out[test_out_len] = '\0';
+    test_pending = 1;
+}
+
+
+static void test_drain(void)
+{
+    while(test_pending)
+    {
+        test_pending = 0;
+        BVR_uart_debug_tx_cplt();
+    }
+}
+
+
+static void test_counters(void)
+{
+    fifo_stats_t *stats = &test_fifo.ctrl.stats;
+    uint8_t data[TEST_DEPTH];
+    temp_buffer_t span;
+
+    memset(data, 0x44, sizeof(data));
+    CHECK(BVR_fifo_init(&test_fifo, test_buffer, TEST_DEPTH) == BVR_OK);
+    CHECK(stats->bytes_in == 0);
+    CHECK(stats->pop_calls == 0);
+
+    // bytes in and the high water mark come from the producer side
+    CHECK(BVR_fifo_push(&test_fifo, data, 40) == BVR_OK);
+    CHECK(stats->bytes_in == 40);
+    CHECK(stats->high_water == 40);
+    CHECK(BVR_fifo_push(&test_fifo, data, 30) == BVR_ERROR);
+    CHECK(stats->push_fails == 1);
+    CHECK(stats->bytes_in == 40);
+
+    // every consumer call counts, bytes out only once the space is free
+    CHECK(BVR_fifo_pop(&test_fifo, data, 20) == BVR_OK);
+    CHECK(BVR_fifo_pop(&test_fifo, data, 30) == BVR_ERROR);
+    CHECK(stats->pop_calls == 2);
+    CHECK(stats->bytes_out == 20);
+    CHECK(stats->high_water == 40);
+
+    span = BVR_fifo_claim(&test_fifo);
+    CHECK(span.buff_size == 20);
+    CHECK(stats->pop_calls == 3);
+    CHECK(stats->bytes_out == 20);
+    CHECK(BVR_fifo_release(&test_fifo, span.buff_size) == BVR_OK);
+    CHECK(stats->bytes_out == 40);
+
+    // full, then the time it stayed full is kept when it drains
+    CHECK(BVR_fifo_push(&test_fifo, data, TEST_DEPTH) == BVR_OK);
+    CHECK(stats->high_water == TEST_DEPTH);
+    CHECK(stats->full);
+    usleep(30 * 1000);
+    CHECK(BVR_fifo_skip(&test_fifo, 1) == BVR_OK);
+    CHECK(!stats->full);
+    CHECK(stats->longest_full >= 30);
+    CHECK(stats->longest_full < 1000);
+    CHECK(stats->bytes_in == 40 + TEST_DEPTH);
+    CHECK(stats->bytes_out == 41);
+
+    // a truncated push is one failure
+    CHECK(BVR_fifo_set_policy(&test_fifo, FIFO_TRUNCATE, 0) == BVR_OK);
+    CHECK(BVR_fifo_push(&test_fifo, data, 5) == BVR_ERROR);
+    CHECK(stats->push_fails == 2);
+    CHECK(stats->bytes_in == 40 + TEST_DEPTH + 1);
+}
+
+
+static void test_dump(void)
+{
+    uint8_t data[8];
+
+    host_uart_tx_hook = test_uart_tx;
+    BVR_uart_debug_init();
+    test_drain();
+    test_out_len = 0;
+    test_out[0] = '\0';
+
+    // registering twice still lists the fifo once
+    CHECK(BVR_fifo_init(&test_other, test_other_buffer, sizeof(test_other_buffer)) == BVR_OK);
+    BVR_fifo_register(&test_fifo, "adc");
+    BVR_fifo_register(&test_other, "gps");
+    BVR_fifo_register(&test_fifo, "adc");
+    CHECK(BVR_fifo_push(&test_other, data, 8) == BVR_OK);
+
+    BVR_fifo_dump_stats();
+    test_drain();
+
+    CHECK(strstr(test_out, "FIFO adc depth 64 level 64 high 64\r\n") != NULL);
+    CHECK(strstr(test_out, "in 105 out 41 fails 2 full max ") != NULL);
+    CHECK(strstr(test_out, "FIFO gps depth 16 level 8 high 8\r\n") != NULL);
+    CHECK(strstr(test_out, "in 8 out 0 fails 0 full max 0ms pops/s 0\r\n") != NULL);
+    CHECK(strstr(strstr(test_out, "FIFO adc") + 1, "FIFO adc") == NULL);
+}
+
+
+int main(void)
+{
+    test_counters();
+    test_dump();
+
+    puts("test_fifo_stats ok");
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
@@ -0,0 +1,261 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_fifo_wait.c
+* @brief    BVR_fifo_push_wait and BVR_fifo_pop_wait on the FreeRTOS stand-in
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Built against bvr_utils_host_rtos (BVR_FIFO_RTOS set, host/freertos).
+*       Timeouts, one waiter per side, calls from an "interrupt" and the
+*       wakeup from the other side are checked in turn, then a producer and
+*       a consumer task pass a long stream through a small fifo with no
+*       polling. A lost wakeup shows up as a timeout.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <string.h>
+#include <unistd.h>
+#include "BVR_fifo_buffer.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "host_hal.h"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+#define TEST_DEPTH      32
+#define TEST_BYTES      (1L * 1024 * 1024)
+#define TEST_MAX_CHUNK  16  /**< push + pop chunk <= depth + 1, or both sides can wait at once */
+
+static fifo_t test_fifo;
+static uint8_t test_buffer[TEST_DEPTH];
+static volatile int test_step;
+static volatile int test_done;
+static volatile BVR_status_t test_status;
+static volatile uint32_t test_waited;
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+/* wait in a task for the main thread to move the test on */
+static void test_wait_step(int step)
+{
+    while(test_step != step){usleep(500);}
+}
+
+
+static void test_timeouts(void *argument)
+{
+    uint8_t data[TEST_DEPTH + 1];
+    uint32_t start;
+    uint32_t msgs;
+    fifo_t mp_fifo;
+
+    (void)argument;
+    memset(data, 0x77, sizeof(data));
+
+    // nothing there, the pop gives up after the timeout
+    start = HAL_GetTick();
+    CHECK(BVR_fifo_pop_wait(&test_fifo, data, 1, 30) == BVR_TIMEOUT);
+    CHECK((HAL_GetTick() - start) >= 30);
+
+    // no room, the push gives up and counts the message as dropped
+    CHECK(BVR_fifo_push(&test_fifo, data, TEST_DEPTH) == BVR_OK);
+    start = HAL_GetTick();
+    CHECK(BVR_fifo_push_wait(&test_fifo, data, 1, 30) == BVR_TIMEOUT);
+    CHECK((HAL_GetTick() - start) >= 30);
+    BVR_fifo_get_drops(&test_fifo, &msgs, NULL);
+    CHECK(msgs == 1);
+
+    // more than the fifo can ever hold, and a multi producer fifo
+    CHECK(BVR_fifo_pop_wait(&test_fifo, data, TEST_DEPTH + 1, 30) == BVR_ERROR);
+    CHECK(BVR_fifo_init_mp(&mp_fifo, test_buffer, TEST_DEPTH) == BVR_OK);
+    CHECK(BVR_fifo_push_wait(&mp_fifo, data, 1, 30) == BVR_ERROR);
+
+    // an interrupt never waits, it is a plain push or pop
+    CHECK(BVR_fifo_pop(&test_fifo, data, TEST_DEPTH) == BVR_OK);
+    host_ipsr = 1;
+    start = HAL_GetTick();
+    CHECK(BVR_fifo_pop_wait(&test_fifo, data, 1, 1000) == BVR_ERROR);
+    CHECK(BVR_fifo_push_wait(&test_fifo, data, 4, 1000) == BVR_OK);
+    CHECK(BVR_fifo_pop_wait(&test_fifo, data, 4, 1000) == BVR_OK);
+    CHECK((HAL_GetTick() - start) < 500);
+    host_ipsr = 0;
+
+    test_done = 1;
+}
+
+
+/* sleeps in pop_wait until the main thread pushes */
+static void test_popper(void *argument)
+{
+    uint8_t data[8];
+    uint32_t start = HAL_GetTick();
+
+    (void)argument;
+
+    test_step = 1;
+    test_status = BVR_fifo_pop_wait(&test_fifo, data, 8, 5000);
+    test_waited = HAL_GetTick() - start;
+    test_done = 1;
+}
+
+
+/* a second task on the same side is turned away */
+static void test_second(void *argument)
+{
+    uint8_t data[8];
+
+    (void)argument;
+
+    test_status = BVR_fifo_pop_wait(&test_fifo, data, 8, 5000);
+    test_done = 2;
+}
+
+
+/* sleeps in push_wait until the main thread pops */
+static void test_pusher(void *argument)
+{
+    uint8_t data[8];
+    uint32_t start = HAL_GetTick();
+
+    (void)argument;
+    memset(data, 0x88, sizeof(data));
+
+    test_step = 1;
+    test_status = BVR_fifo_push_wait(&test_fifo, data, 8, 5000);
+    test_waited = HAL_GetTick() - start;
+    test_done = 1;
+}
+
+
+static void test_wakeups(void)
+{
+    uint8_t data[TEST_DEPTH];
+
+    memset(data, 0x99, sizeof(data));
+
+    // the pop wakes when enough has been pushed, not on the first byte
+    CHECK(BVR_fifo_init(&test_fifo, test_buffer, TEST_DEPTH) == BVR_OK);
+    test_step = 0;
+    test_done = 0;
+    CHECK(xTaskCreate(test_popper, "popper", 256, NULL, 1, NULL) == pdPASS);
+    test_wait_step(1);
+    usleep(20 * 1000);
+
+    CHECK(xTaskCreate(test_second, "second", 256, NULL, 1, NULL) == pdPASS);
+    while(test_done != 2){usleep(500);}
+    CHECK(test_status == BVR_BUSY);
+    test_done = 0;
+
+    CHECK(BVR_fifo_push(&test_fifo, data, 4) == BVR_OK);
+    usleep(20 * 1000);
+    CHECK(!test_done);
+    CHECK(BVR_fifo_push(&test_fifo, data, 4) == BVR_OK);
+    while(!test_done){usleep(500);}
+    CHECK(test_status == BVR_OK);
+    CHECK(test_waited >= 40);
+    CHECK(test_waited < 1000);
+    CHECK(BVR_fifo_level(&test_fifo) == 0);
+
+    // the push wakes when a pop makes room
+    CHECK(BVR_fifo_push(&test_fifo, data, TEST_DEPTH - 4) == BVR_OK);
+    test_step = 0;
+    test_done = 0;
+    CHECK(xTaskCreate(test_pusher, "pusher", 256, NULL, 1, NULL) == pdPASS);
+    test_wait_step(1);
+    usleep(20 * 1000);
+    CHECK(!test_done);
+    CHECK(BVR_fifo_pop(&test_fifo, data, 4) == BVR_OK);
+    while(!test_done){usleep(500);}
+    CHECK(test_status == BVR_OK);
+    CHECK(test_waited >= 20);
+    CHECK(test_waited < 1000);
+    CHECK(BVR_fifo_level(&test_fifo) == TEST_DEPTH);
+}
+
+
+static void test_producer(void *argument)
+{
+    uint8_t chunk[TEST_MAX_CHUNK];
+    long sent = 0;
+    int size;
+    int i;
+
+    (void)argument;
+
+    while(sent < TEST_BYTES)
+    {
+        size = 1 + (int)(sent % TEST_MAX_CHUNK);
+        if(size > (TEST_BYTES - sent)){size = (int)(TEST_BYTES - sent);}
+        for(i = 0; i < size; i++){chunk[i] = (uint8_t)(sent + i);}
+
+        CHECK(BVR_fifo_push_wait(&test_fifo, chunk, size, 2000) == BVR_OK);
+        sent += size;
+    }
+
+    BVR_ATOMIC_ADD(&test_done, 1);
+}
+
+
+static void test_consumer(void *argument)
+{
+    uint8_t chunk[TEST_MAX_CHUNK];
+    long received = 0;
+    int size;
+    int i;
+
+    (void)argument;
+
+    while(received < TEST_BYTES)
+    {
+        size = 1 + (int)((received / 3) % TEST_MAX_CHUNK);
+        if(size > (TEST_BYTES - received)){size = (int)(TEST_BYTES - received);}
+
+        CHECK(BVR_fifo_pop_wait(&test_fifo, chunk, size, 2000) == BVR_OK);
+        for(i = 0; i < size; i++){CHECK(chunk[i] == (uint8_t)(received + i));}
+        received += size;
+    }
+
+    BVR_ATOMIC_ADD(&test_done, 1);
+}
+
+
+int main(void)
+{
+    CHECK(BVR_fifo_init(&test_fifo, test_buffer, TEST_DEPTH) == BVR_OK);
+    test_done = 0;
+    CHECK(xTaskCreate(test_timeouts, "timeouts", 256, NULL, 1, NULL) == pdPASS);
+    while(!test_done){usleep(1000);}
+
+    test_wakeups();
+
+    CHECK(BVR_fifo_init(&test_fifo, test_buffer, TEST_DEPTH) == BVR_OK);
+    test_done = 0;
+    CHECK(xTaskCreate(test_producer, "producer", 256, NULL, 1, NULL) == pdPASS);
+    CHECK(xTaskCreate(test_consumer, "consumer", 256, NULL, 1, NULL) == pdPASS);
+    while(test_done != 2){usleep(1000);}
+    CHECK(BVR_fifo_level(&test_fifo) == 0);
+
+    puts("test_fifo_wait ok");
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
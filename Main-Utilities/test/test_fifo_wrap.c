@@ -0,0 +1,124 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_fifo_wrap.c
+* @brief    fifo copies across the wrap, power of two and odd depths
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Random pushes and pops on rings of several depths, masked and
+*       compared, checked byte for byte against a plain model queue so the
+*       two segment copies at the wrap are covered from every offset.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <string.h>
+#include "BVR_fifo_buffer.h"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+#define TEST_OPS        20000
+#define TEST_MAX_DEPTH  128
+
+static const int test_depths[] = {1, 16, 64, 128, 3, 17, 60, 127};
+static uint32_t test_seed = 12345;
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+static int test_rand(int limit)
+{
+    test_seed = (test_seed * 1103515245u) + 12345u;
+    return (int)((test_seed >> 16) % (uint32_t)limit);
+}
+
+
+static void test_depth(int depth)
+{
+    static uint8_t buffer[TEST_MAX_DEPTH];
+    uint8_t model[TEST_MAX_DEPTH];
+    uint8_t data[TEST_MAX_DEPTH + 1];
+    fifo_t fifo;
+    uint8_t next = 0;
+    int level = 0;
+    int size;
+    int op;
+    int i;
+
+    CHECK(BVR_fifo_init(&fifo, buffer, depth) == BVR_OK);
+
+    // power of two rings take the masked path, the rest the compare
+    CHECK(fifo.ctrl.mask == (((depth & (depth - 1)) == 0) ? (depth - 1) : 0));
+
+    for(op = 0; op < TEST_OPS; op++)
+    {
+        size = test_rand(depth + 1) + 1;
+
+        if(test_rand(2) == 0)
+        {
+            for(i = 0; i < size; i++){data[i] = next + i;}
+
+            if(size <= (depth - level))
+            {
+                CHECK(BVR_fifo_push(&fifo, data, size) == BVR_OK);
+                memcpy(&model[level], data, size);
+                level += size;
+                next  += size;
+            }
+            else
+            {
+                CHECK(BVR_fifo_push(&fifo, data, size) == BVR_ERROR);
+            }
+        }
+        else
+        {
+            if(size <= level)
+            {
+                CHECK(BVR_fifo_pop(&fifo, data, size) == BVR_OK);
+                CHECK(memcmp(data, model, size) == 0);
+                memmove(model, &model[size], level - size);
+                level -= size;
+            }
+            else
+            {
+                CHECK(BVR_fifo_pop(&fifo, data, size) == BVR_ERROR);
+            }
+        }
+
+        CHECK(BVR_fifo_level(&fifo) == level);
+        CHECK(BVR_fifo_space(&fifo) == (depth - level));
+    }
+}
+
+
+int main(void)
+{
+    unsigned index;
+
+    for(index = 0; index < (sizeof(test_depths) / sizeof(test_depths[0])); index++)
+    {
+        test_depth(test_depths[index]);
+    }
+
+    puts("test_fifo_wrap ok");
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
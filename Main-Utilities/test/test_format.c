@@ -0,0 +1,190 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_format.c
+* @brief    BVR_snprintf compared against the C library
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Every conversion, flag, width, precision and length the formatter
+*       takes is run through BVR_snprintf and snprintf and the text and
+*       return have to match, at every buffer size from 0 up. Built twice,
+*       test_format_float has BVR_FORMAT_FLOAT on and checks %f against
+*       libc (values kept off exact binary halves, where libc rounds to
+*       even and the formatter rounds up).
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "BVR_format.h"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+#define TEST_LINE 160
+
+static int test_cases = 0;
+
+/* format with both and compare, then again cut short at every size */
+#define TEST_FMT(...) \
+    do { \
+        char _want[TEST_LINE]; \
+        char _got[TEST_LINE]; \
+        int _want_len = snprintf(_want, sizeof(_want), __VA_ARGS__); \
+        int _got_len = BVR_snprintf(_got, sizeof(_got), __VA_ARGS__); \
+        size_t _size; \
+        if ((_got_len != _want_len) || (strcmp(_got, _want) != 0)) { \
+            fprintf(stderr, "%s:%d: \"%s\" (%d) != libc \"%s\" (%d)\n", \
+                    __FILE__, __LINE__, _got, _got_len, _want, _want_len); \
+            exit(1); \
+        } \
+        for (_size = 0; _size <= (size_t)_want_len + 1; _size++) { \
+            memset(_got, 0x7E, sizeof(_got)); \
+            CHECK(BVR_snprintf((_size > 0) ? _got : NULL, _size, __VA_ARGS__) == _want_len); \
+            if (_size > 0) { \
+                CHECK(strncmp(_got, _want, _size - 1) == 0); \
+                CHECK(_got[(_size - 1 < (size_t)_want_len) ? _size - 1 : (size_t)_want_len] == '\0'); \
+            } \
+            CHECK((_size == 0) || ((unsigned char)_got[_size] == 0x7E)); \
+        } \
+        test_cases++; \
+    } while (0)
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+static void test_integers(void)
+{
+    static const int ints[] = {0, 1, -1, 7, -42, 255, 1000, -32768, 65535, INT_MAX, INT_MIN};
+    static const unsigned uints[] = {0u, 1u, 9u, 10u, 0xFFu, 0x1234u, 0xDEADBEEFu, UINT_MAX};
+    static const char *const signed_fmts[] =
+    {
+        "%d", "%i", "%5d", "%-5d|", "%05d", "%+d", "% d", "%+05d", "%-+8d|",
+        "%.3d", "%8.3d", "%-8.3d|", "%08.3d", "%.0d", "%+.0d", "%hhd", "%hd", "%ld",
+    };
+    static const char *const unsigned_fmts[] =
+    {
+        "%u", "%x", "%X", "%o", "%#x", "%#X", "%#o", "%08x", "%-8x|", "%#010x",
+        "%.6x", "%#.6x", "%.0u", "%#.0x", "%#.0o", "%12o", "%hhx", "%hu", "%lx",
+    };
+    unsigned f;
+    unsigned v;
+
+    for(f = 0; f < sizeof(signed_fmts) / sizeof(signed_fmts[0]); f++)
+    {
+        for(v = 0; v < sizeof(ints) / sizeof(ints[0]); v++)
+        {
+            TEST_FMT(signed_fmts[f], ints[v]);
+        }
+    }
+    for(f = 0; f < sizeof(unsigned_fmts) / sizeof(unsigned_fmts[0]); f++)
+    {
+        for(v = 0; v < sizeof(uints) / sizeof(uints[0]); v++)
+        {
+            TEST_FMT(unsigned_fmts[f], uints[v]);
+        }
+    }
+
+    // wider lengths and star arguments
+    TEST_FMT("%lld %llu %llx", LLONG_MIN, ULLONG_MAX, 0x0123456789ABCDEFULL);
+    TEST_FMT("%lld %+lld %020lld", LLONG_MAX, 5LL, -123456789012LL);
+    TEST_FMT("%zu %zd %jd %ju %td", (size_t)123456, (ptrdiff_t)-5, (intmax_t)-9,
+             (uintmax_t)9, (ptrdiff_t)77);
+    TEST_FMT("%*d|%-*d|%.*d|%*.*x", 6, 42, 6, 42, 4, 42, 8, 3, 0xAu);
+    TEST_FMT("%*d|", -6, 42);
+    TEST_FMT("%.*d|", -1, 42);
+}
+
+
+static void test_text(void)
+{
+    int marker = 0;
+
+    TEST_FMT("%s", "");
+    TEST_FMT("%s|%10s|%-10s|%.3s|%8.2s|", "sensor", "ok", "ok", "truncate", "ab");
+    TEST_FMT("%c%c%c|%3c|%-3c|", 'a', 'b', 'c', 'x', 'y');
+    TEST_FMT("100%% %s %d%%", "done", 5);
+    TEST_FMT("%p", (void *)&marker);
+    TEST_FMT("%20p|%-20p|", (void *)&marker, (void *)&marker);
+    TEST_FMT("no conversions at all");
+    TEST_FMT("INFO\t: sensor %d read %u mV status %s\r\n", -3, 3300u, "ok");
+}
+
+
+static void test_limits(void)
+{
+    char line[8];
+
+    // NULL with size 0 still reports the full length
+    CHECK(BVR_snprintf(NULL, 0, "%d-%s", 12345, "abc") == 9);
+
+    // never writes past size
+    memset(line, 'Z', sizeof(line));
+    CHECK(BVR_snprintf(line, 4, "%s", "overflow") == 8);
+    CHECK((strcmp(line, "ove") == 0) && (line[4] == 'Z'));
+
+#if !BVR_FORMAT_FLOAT
+    CHECK(BVR_snprintf(line, sizeof(line), "%f", 1.5) == 1);
+    CHECK(strcmp(line, "?") == 0);
+#endif
+}
+
+
+#if BVR_FORMAT_FLOAT
+static void test_floats(void)
+{
+    static const double values[] = {0.0, 1.0, -1.0, 3.14159265, -2.71828183, 0.001,
+                                    1234.5678, 100.0, 65535.999, 1e9 + 0.3, 0.1};
+    static const char *const fmts[] =
+    {
+        "%f", "%.0f", "%.1f", "%.2f", "%.3f", "%.6f", "%10.2f|", "%-10.2f|",
+        "%010.3f", "%+.2f", "% .2f", "%#.0f", "%F",
+    };
+    unsigned f;
+    unsigned v;
+
+    for(f = 0; f < sizeof(fmts) / sizeof(fmts[0]); f++)
+    {
+        for(v = 0; v < sizeof(values) / sizeof(values[0]); v++)
+        {
+            TEST_FMT(fmts[f], values[v]);
+        }
+    }
+    TEST_FMT("%.2f %.2f", -0.0, 1e-9);
+    TEST_FMT("%*.*f|", 9, 2, 2.345678);
+}
+#endif
+
+
+int main(void)
+{
+    test_integers();
+    test_text();
+    test_limits();
+#if BVR_FORMAT_FLOAT
+    test_floats();
+#endif
+    printf("test_format ok, %d formats\n", test_cases);
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
@@ -0,0 +1,216 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_log_deferred.c
+* @brief    deferred binary log records and the bvr_log_decode.py decoder
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Built against bvr_utils_host_deferred (LOG_DEFERRED set) and linked
+*       without PIE, so a format address fits the 32 bit word of a record
+*       the same as on the target. Every record sent is walked and checked
+*       against what was logged, text from log_print and BVR_LOG_TEXT has to
+*       come through between records. The capture is written out to
+*       test_log_deferred.bin for test_log_deferred_decode, which runs the
+*       decoder on this ELF and checks the text it rebuilds.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <stdio.h>
+#include <string.h>
+#include "BVR_debug_logger.h"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+#define TEST_CAPTURE    "test_log_deferred.bin"
+#define TEST_BURST      400
+
+static uint8_t test_out[64 * 1024];
+static int test_out_len = 0;
+static int test_at = 0;
+static volatile int test_pending = 0;
+static const char test_flash[] = "from flash";
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+/* keep what was sent, the test completes the transfer */
+static void test_uart_tx(UART_HandleTypeDef *huart, const uint8_t *p_data, uint16_t size)
+{
+    UNUSED(huart);
+    CHECK((test_out_len + size) <= (int)sizeof(test_out));
+    memcpy(&test_out[test_out_len], p_data, size);
+    test_out_len += size;
+    test_pending = 1;
+}
+
+
+static void test_drain(void)
+{
+    while(test_pending)
+    {
+        test_pending = 0;
+        BVR_uart_debug_tx_cplt();
+    }
+}
+
+
+static uint32_t test_word(int pos)
+{
+    uint32_t word;
+
+    memcpy(&word, &test_out[pos], 4);
+    return word;
+}
+
+
+/* the next record in the capture is fmt with these arguments */
+static void test_record(const char *fmt, int nargs, const uint32_t *args)
+{
+    uint32_t tick;
+    int i;
+
+    CHECK((test_at + 10) <= test_out_len);
+    CHECK(test_out[test_at] == LOG_DEFERRED_SYNC);
+    CHECK(test_out[test_at + 1] == nargs);
+    CHECK(strcmp((const char *)(uintptr_t)test_word(test_at + 2), fmt) == 0);
+    tick = test_word(test_at + 6);
+    CHECK(tick <= HAL_GetTick());
+    CHECK((test_at + 10 + (4 * nargs)) <= test_out_len);
+    for(i = 0; i < nargs; i++){CHECK(test_word(test_at + 10 + (4 * i)) == args[i]);}
+
+    test_at += 10 + (4 * nargs);
+}
+
+
+/* the next bytes in the capture are plain text */
+static void test_text(const char *text)
+{
+    int size = (int)strlen(text);
+
+    CHECK((test_at + size) <= test_out_len);
+    CHECK(memcmp(&test_out[test_at], text, size) == 0);
+    test_at += size;
+}
+
+
+static void test_records(void)
+{
+    const uint32_t none[1] = {0};
+    const uint32_t ints[4] = {7, (uint32_t)-3, 0x2a, 'c'};
+    const uint32_t str[1]  = {(uint32_t)(uintptr_t)test_flash};
+    const uint32_t mod[2]  = {(uint32_t)(uintptr_t)"MOTOR", 1500};
+    const uint32_t warn[1] = {3};
+    char ram[16];
+
+    snprintf(ram, sizeof(ram), "built %d", 42);
+
+    // the first record goes straight out, the rest queue behind it
+    BVR_LOG(INFO, "deferred start");
+    BVR_LOG(INFO, "deferred ints %d %d 0x%x %c", 7, -3, 0x2a, 'c');
+    BVR_LOG(DBG, "deferred string %s", test_flash);
+    BVR_LOG_ID(INFO, "MOTOR", "deferred speed %u", 1500);
+    log_print("plain text\r\n");
+    BVR_LOG_TEXT(INFO, "deferred ram %s", ram);
+    BVR_LOG(WARN, "deferred warning %d", 3);
+    test_drain();
+
+    // the warning was queued on the urgent lane so it overtakes the bulk lane
+    test_record("INFO\t: deferred start\r\n", 0, none);
+    test_record("WARN\t: deferred warning %d\r\n", 1, warn);
+    test_record("INFO\t: deferred ints %d %d 0x%x %c\r\n", 4, ints);
+    test_record("DBG\t: deferred string %s\r\n", 1, str);
+    test_record("INFO <-> %s : deferred speed %u\r\n", 2, mod);
+    test_text("plain text\r\n");
+    test_text("INFO\t: deferred ram built 42\r\n");
+    CHECK(test_at == test_out_len);
+}
+
+
+/* a stalled uart drops records whole and the marker is a record too */
+static void test_drops(void)
+{
+    uint32_t line;
+    uint32_t next = 0;
+    uint32_t kept = 0;
+    uint32_t lost = 0;
+
+    for(line = 0; line < TEST_BURST; line++)
+    {
+        BVR_LOG(INFO, "deferred burst %lu", (unsigned long)line);
+    }
+    test_drain();
+    BVR_LOG(INFO, "deferred after burst");
+    test_drain();
+
+    // records only, each one complete, the kept lines in order
+    while(test_at < test_out_len)
+    {
+        const char *fmt;
+
+        CHECK(test_out[test_at] == LOG_DEFERRED_SYNC);
+        fmt = (const char *)(uintptr_t)test_word(test_at + 2);
+
+        if(strcmp(fmt, "INFO\t: deferred burst %lu\r\n") == 0)
+        {
+            CHECK(test_word(test_at + 10) >= next);
+            next = test_word(test_at + 10) + 1;
+            kept++;
+            test_at += 14;
+        }
+        else if(strcmp(fmt, "WARN\t: %lu log messages dropped\r\n") == 0)
+        {
+            lost += test_word(test_at + 10);
+            test_at += 14;
+        }
+        else
+        {
+            test_record("INFO\t: deferred after burst\r\n", 0, NULL);
+        }
+    }
+
+    CHECK(test_at == test_out_len);
+    // every line is either sent or counted in a marker
+    CHECK(lost > 0);
+    CHECK((kept + lost) == TEST_BURST);
+}
+
+
+int main(void)
+{
+    FILE *capture;
+
+    host_uart_tx_hook = test_uart_tx;
+    BVR_uart_debug_init();
+
+    test_records();
+    test_drops();
+
+    // for test_log_deferred_decode
+    capture = fopen(TEST_CAPTURE, "wb");
+    CHECK(capture != NULL);
+    CHECK(fwrite(test_out, 1, test_out_len, capture) == (size_t)test_out_len);
+    fclose(capture);
+
+    puts("test_log_deferred ok");
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
@@ -0,0 +1,180 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_log_drops.c
+* @brief    lost log lines are reported once per burst on the bulk lane
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       The uart is held busy so the bulk lane fills and drops lines, then it
+*       is let go. Then it is kept slower than the logging so the lane never
+*       empties. Either way the markers must come out while the lines are
+*       still being lost, add up to every line lost and not flood the uart.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <string.h>
+#include "BVR_debug_logger.h"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+static char test_out[256 * 1024];
+static int test_out_len = 0;
+static volatile int test_pending = 0;
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+/* keep what was sent, the test completes the transfer */
+static void test_uart_tx(UART_HandleTypeDef *huart, const uint8_t *p_data, uint16_t size)
+{
+    UNUSED(huart);
+    CHECK((test_out_len + size) < (int)sizeof(test_out));
+    memcpy(&test_out[test_out_len], p_data, size);
+    test_out_len += size;
+    test_pending = 1;
+}
+
+
+static void test_drain(void)
+{
+    while(test_pending)
+    {
+        test_pending = 0;
+        BVR_uart_debug_tx_cplt();
+    }
+}
+
+
+static int test_count(const char *text)
+{
+    const char *at = test_out;
+    int count = 0;
+
+    test_out[test_out_len] = '\0';
+    while((at = strstr(at, text)) != NULL)
+    {
+        count++;
+        at++;
+    }
+
+    return count;
+}
+
+
+/* total of the counts in every marker sent so far */
+static unsigned long test_reported(void)
+{
+    const char *at = test_out;
+    unsigned long total = 0;
+    unsigned long lost;
+
+    test_out[test_out_len] = '\0';
+    while((at = strstr(at, "WARN\t: ")) != NULL)
+    {
+        at += 7;
+        if(sscanf(at, "%lu log messages dropped", &lost) == 1){total += lost;}
+    }
+
+    return total;
+}
+
+
+/* the uart is stalled for the whole burst then catches up */
+static void test_burst(void)
+{
+    const char *marker;
+    int line;
+
+    // the first line starts a transfer that is not completed, the rest queue
+    for(line = 0; line < 200; line++)
+    {
+        BVR_LOG(INFO, "bulk line %03d padded out to fill the lane quickly", line);
+        if((line % 20) == 0){BVR_LOG(WARN, "warning %03d", line);}
+    }
+    test_drain();
+
+    BVR_LOG(INFO, "after the burst");
+    test_drain();
+
+    // every lost line is counted once, on the bulk lane after the lines kept
+    CHECK(test_count("messages dropped") >= 1);
+    CHECK(test_reported() == (unsigned long)(200 - test_count("bulk line")));
+    marker = strstr(test_out, "messages dropped");
+    CHECK(strstr(marker, "INFO\t: after the burst") != NULL);
+    CHECK(test_count("warning") == 10);
+}
+
+
+/* the uart sends 40 bytes in the time a 60 byte line is logged, so there is
+ * always a transfer in flight and the bulk lane never empties. The drops
+ * must still be reported while it lasts */
+static void test_sustained(void)
+{
+    int start = test_out_len;
+    int markers = test_count("messages dropped");
+    int sent = test_count("steady line");
+    int budget = 0;
+    int line;
+
+    for(line = 0; line < 2000; line++)
+    {
+        BVR_LOG(INFO, "steady line %04d padded out to fill the lane quickly", line);
+
+        budget += 40;
+        if(test_pending && (budget >= DBG_HUART.TxXferSize))
+        {
+            budget -= DBG_HUART.TxXferSize;
+            test_pending = 0;
+            BVR_uart_debug_tx_cplt();
+        }
+        CHECK(test_pending);
+    }
+
+    CHECK(test_count("messages dropped") > (markers + 1));
+    CHECK((test_out_len - start) > 0);
+    sent = test_count("steady line") - sent;
+    CHECK(sent < 2000);
+
+    // once it catches up the counts add up to every line lost
+    test_drain();
+    BVR_LOG(INFO, "after the overload");
+    test_drain();
+    CHECK(test_reported() == (unsigned long)((200 + 2000) - test_count("bulk line") -
+                                             test_count("steady line")));
+
+    // one marker each time the lane fills, not one per line lost
+    CHECK((test_count("messages dropped") - markers) < ((2000 - sent) / 2));
+}
+
+
+int main(void)
+{
+    host_uart_tx_hook = test_uart_tx;
+    BVR_uart_debug_init();
+
+    test_burst();
+    test_sustained();
+
+    puts("test_log_drops ok");
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
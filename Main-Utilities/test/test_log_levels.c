@@ -0,0 +1,124 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_log_levels.c
+* @brief    runtime module levels for BVR_LOG_ID
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       The table starts zeroed and every module starts at LOG_LEVEL, then
+*       all modules are turned down and one turned back up.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <string.h>
+#include "BVR_debug_logger.h"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+static char test_out[4096];
+static int test_out_len = 0;
+static volatile int test_pending = 0;
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+/* keep what was sent, the test completes the transfer */
+static void test_uart_tx(UART_HandleTypeDef *huart, const uint8_t *p_data, uint16_t size)
+{
+    UNUSED(huart);
+    CHECK((test_out_len + size) < (int)sizeof(test_out));
+    memcpy(&test_out[test_out_len], p_data, size);
+    test_out_len += size;
+    test_out[test_out_len] = '\0';
+    test_pending = 1;
+}
+
+
+static void test_drain(void)
+{
+    while(test_pending)
+    {
+        test_pending = 0;
+        BVR_uart_debug_tx_cplt();
+    }
+}
+
+
+static int test_sent(const char *text)
+{
+    return strstr(test_out, text) != NULL;
+}
+
+
+int main(void)
+{
+    host_uart_tx_hook = test_uart_tx;
+    BVR_uart_debug_init();
+
+    // nothing set, every module logs everything compiled in
+    CHECK(BVR_log_get_level(NULL) == LOG_LEVEL);
+    BVR_LOG_ID(TRACE, "IMU", "imu trace %d", 1);
+    test_drain();
+    CHECK(test_sent("TRACE <-> IMU : imu trace 1\r\n"));
+    CHECK(BVR_log_get_level("IMU") == LOG_LEVEL);
+
+    // everything down to WARN, then IMU back up
+    BVR_log_set_level(NULL, WARN);
+    BVR_LOG_ID(INFO, "IMU", "imu info %d", 2);
+    BVR_LOG_ID(WARN, "IMU", "imu warn %d", 3);
+    test_drain();
+    CHECK(!test_sent("imu info 2"));
+    CHECK(test_sent("WARN <-> IMU : imu warn 3\r\n"));
+
+    BVR_log_set_level("IMU", TRACE);
+    BVR_LOG_ID(DBG, "IMU", "imu dbg %d", 4);
+    test_drain();
+    CHECK(test_sent("DBG <-> IMU : imu dbg 4\r\n"));
+    CHECK(BVR_log_get_level("IMU") == TRACE);
+
+    // a module first seen now starts at the default that was set
+    BVR_LOG_ID(INFO, "GPS", "gps info %d", 5);
+    BVR_LOG_ID(ERR, "GPS", "gps err %d", 6);
+    test_drain();
+    CHECK(!test_sent("gps info 5"));
+    CHECK(test_sent("ERR <-> GPS : gps err 6\r\n"));
+    CHECK(BVR_log_get_level("GPS") == WARN);
+
+    // FATAL always prints, out of range levels are clamped
+    BVR_log_set_level("GPS", 0);
+    CHECK(BVR_log_get_level("GPS") == FATAL);
+    BVR_LOG_ID(FATAL, "GPS", "gps fatal %d", 7);
+    test_drain();
+    CHECK(test_sent("FATAL <-> GPS : gps fatal 7\r\n"));
+    BVR_log_set_level("GPS", LOG_LEVEL + 5);
+    CHECK(BVR_log_get_level("GPS") == LOG_LEVEL);
+
+    // no id, never filtered at runtime
+    BVR_log_set_level(NULL, FATAL);
+    BVR_LOG(TRACE, "plain trace %d", 8);
+    test_drain();
+    CHECK(test_sent("TRACE\t: plain trace 8\r\n"));
+
+    puts("test_log_levels ok");
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
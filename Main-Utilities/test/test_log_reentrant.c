@@ -0,0 +1,207 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_log_reentrant.c
+* @brief    log_print from several tasks and an interrupt at once
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Three task threads and one thread with host_ipsr set log as fast as
+*       they can while a fourth, also marked as an interrupt, completes the
+*       uart transfers. Every line that comes out must be whole, once and in
+*       order for its writer, and the lines that did not must add up to what
+*       the drop markers report.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "BVR_debug_logger.h"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+#define TEST_TASKS      3
+#define TEST_LINES      3000
+#define TEST_ISR_ID     TEST_TASKS
+
+static char test_out[1024 * 1024];
+static int test_out_len = 0;
+static pthread_mutex_t test_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t test_pending = 0;
+static uint32_t test_stop = 0;
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+/* called by whichever context started the transfer */
+static void test_uart_tx(UART_HandleTypeDef *huart, const uint8_t *p_data, uint16_t size)
+{
+    UNUSED(huart);
+
+    pthread_mutex_lock(&test_lock);
+    CHECK((test_out_len + size) < (int)sizeof(test_out));
+    memcpy(&test_out[test_out_len], p_data, size);
+    test_out_len += size;
+    test_out[test_out_len] = '\0';
+    pthread_mutex_unlock(&test_lock);
+
+    BVR_STORE_RELEASE(&test_pending, 1);
+}
+
+
+/* the uart DMA complete interrupt */
+static void *test_dma_isr(void *arg)
+{
+    (void)arg;
+    host_ipsr = 1;
+
+    while(!BVR_LOAD_ACQUIRE(&test_stop))
+    {
+        if(BVR_LOAD_ACQUIRE(&test_pending))
+        {
+            BVR_STORE_RELEASE(&test_pending, 0);
+            BVR_uart_debug_tx_cplt();
+        }
+        else
+        {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
+
+
+static void *test_writer(void *arg)
+{
+    int id = (int)(uintptr_t)arg;
+    int line;
+
+    if(id == TEST_ISR_ID){host_ipsr = 1;}
+
+    for(line = 0; line < TEST_LINES; line++)
+    {
+        if(id == TEST_ISR_ID){BVR_LOG(WARN, "isr line %05d", line);}
+        else{BVR_LOG(INFO, "writer %d line %05d", id, line);}
+        // yield now and then, often enough that some lines get out, not so
+        // often that the lanes never fill and drop
+        if((line % 32) == 0){sched_yield();}
+    }
+
+    return NULL;
+}
+
+
+static int test_wait_for(const char *text)
+{
+    int tries;
+    int found = 0;
+
+    for(tries = 0; (tries < 2000) && !found; tries++)
+    {
+        pthread_mutex_lock(&test_lock);
+        found = (strstr(test_out, text) != NULL);
+        pthread_mutex_unlock(&test_lock);
+        if(!found){usleep(1000);}
+    }
+
+    return found;
+}
+
+
+int main(void)
+{
+    pthread_t writers[TEST_TASKS + 1];
+    pthread_t dma;
+    int last[TEST_TASKS + 1];
+    long received = 0;
+    long dropped = 0;
+    char *line;
+    char *end;
+    int id;
+    int seq;
+    unsigned long lost;
+
+    host_uart_tx_hook = test_uart_tx;
+    BVR_uart_debug_init();
+
+    CHECK(pthread_create(&dma, NULL, test_dma_isr, NULL) == 0);
+    for(id = 0; id <= TEST_TASKS; id++)
+    {
+        last[id] = -1;
+        CHECK(pthread_create(&writers[id], NULL, test_writer, (void *)(uintptr_t)id) == 0);
+    }
+    for(id = 0; id <= TEST_TASKS; id++)
+    {
+        pthread_join(writers[id], NULL);
+    }
+
+    // once the burst is out the next line carries any drop marker
+    BVR_LOG(INFO, "writers done");
+    CHECK(test_wait_for("INFO\t: writers done\r\n"));
+    BVR_LOG(INFO, "end");
+    CHECK(test_wait_for("INFO\t: end\r\n"));
+
+    BVR_STORE_RELEASE(&test_stop, 1);
+    pthread_join(dma, NULL);
+
+    // every line whole, nothing from another line mixed in
+    for(line = test_out; *line != '\0'; line = end + 2)
+    {
+        end = strstr(line, "\r\n");
+        CHECK(end != NULL);
+        *end = '\0';
+
+        if(sscanf(line, "INFO\t: writer %d line %d", &id, &seq) == 2)
+        {
+            CHECK((id >= 0) && (id < TEST_TASKS));
+        }
+        else if(sscanf(line, "WARN\t: isr line %d", &seq) == 1)
+        {
+            id = TEST_ISR_ID;
+        }
+        else if(sscanf(line, "WARN\t: %lu log messages dropped", &lost) == 1)
+        {
+            dropped += (long)lost;
+            continue;
+        }
+        else
+        {
+            CHECK((strcmp(line, "INFO\t: writers done") == 0) || (strcmp(line, "INFO\t: end") == 0));
+            continue;
+        }
+
+        CHECK(seq > last[id]);
+        CHECK(seq < TEST_LINES);
+        last[id] = seq;
+        received++;
+    }
+
+    printf("log reentrant: %ld lines out, %ld reported dropped\n", received, dropped);
+    CHECK((received + dropped) == ((long)(TEST_TASKS + 1) * TEST_LINES));
+
+    puts("test_log_reentrant ok");
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
@@ -0,0 +1,185 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_log_task.c
+* @brief    logger task build, lines from several tasks and a failing uart
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Built against bvr_utils_host_task (LOG_TASK set, host/freertos). The
+*       uart completes from an "interrupt" as soon as it starts. Every line
+*       from every thread must come out once and whole, and a transfer the
+*       HAL refuses must stay queued until the next line is logged.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+#include "BVR_debug_logger.h"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+#define TEST_THREADS    3
+#define TEST_LINES      200
+
+static char test_out[64 * 1024];
+static int test_out_len = 0;
+static int test_transfers = 0;
+static pthread_mutex_t test_lock = PTHREAD_MUTEX_INITIALIZER;
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+/* runs in the logger task, keep the span and complete it from an "ISR" */
+static void test_uart_tx(UART_HandleTypeDef *huart, const uint8_t *p_data, uint16_t size)
+{
+    UNUSED(huart);
+
+    pthread_mutex_lock(&test_lock);
+    CHECK((test_out_len + size) < (int)sizeof(test_out));
+    memcpy(&test_out[test_out_len], p_data, size);
+    test_out_len += size;
+    test_out[test_out_len] = '\0';
+    test_transfers++;
+    pthread_mutex_unlock(&test_lock);
+
+    host_ipsr = 1;
+    BVR_uart_debug_tx_cplt();
+    host_ipsr = 0;
+}
+
+
+/* wait up to two seconds for text to have been sent */
+static int test_wait_for(const char *text)
+{
+    int tries;
+    int found = 0;
+
+    for(tries = 0; (tries < 2000) && !found; tries++)
+    {
+        pthread_mutex_lock(&test_lock);
+        found = (strstr(test_out, text) != NULL);
+        pthread_mutex_unlock(&test_lock);
+        if(!found){usleep(1000);}
+    }
+
+    return found;
+}
+
+
+static void *test_writer(void *arg)
+{
+    int id = (int)(intptr_t)arg;
+    int line;
+
+    for(line = 0; line < TEST_LINES; line++)
+    {
+        BVR_LOG(INFO, "writer %d line %03d", id, line);
+        if((line % 16) == 0){usleep(100);}
+    }
+
+    return NULL;
+}
+
+
+static void test_many_tasks(void)
+{
+    pthread_t writers[TEST_THREADS];
+    char line[64];
+    const char *at;
+    int id;
+    int n;
+
+    for(id = 0; id < TEST_THREADS; id++)
+    {
+        CHECK(pthread_create(&writers[id], NULL, test_writer, (void *)(intptr_t)id) == 0);
+    }
+    for(id = 0; id < TEST_THREADS; id++)
+    {
+        pthread_join(writers[id], NULL);
+    }
+
+    BVR_LOG(INFO, "writers done");
+    CHECK(test_wait_for("INFO\t: writers done\r\n"));
+
+    // every line once, whole, and in order for its writer
+    for(id = 0; id < TEST_THREADS; id++)
+    {
+        at = test_out;
+        for(n = 0; n < TEST_LINES; n++)
+        {
+            snprintf(line, sizeof(line), "INFO\t: writer %d line %03d\r\n", id, n);
+            at = strstr(at, line);
+            CHECK(at != NULL);
+            CHECK(strstr(at + 1, line) == NULL);
+        }
+    }
+}
+
+
+static void test_refused(void)
+{
+    int transfers;
+
+    // the HAL refuses, the task must hand the span back and not wait for it
+    host_uart_tx_status = HAL_ERROR;
+    BVR_LOG(INFO, "held back");
+    usleep(20000);
+    CHECK(strstr(test_out, "held back") == NULL);
+
+    pthread_mutex_lock(&test_lock);
+    transfers = test_transfers;
+    pthread_mutex_unlock(&test_lock);
+
+    host_uart_tx_status = HAL_OK;
+    BVR_LOG(INFO, "uart back");
+    CHECK(test_wait_for("INFO\t: held back\r\nINFO\t: uart back\r\n"));
+    CHECK(test_transfers > transfers);
+}
+
+
+static void test_retried(void)
+{
+    // refused with nothing logged after it, the task must try again by itself
+    host_uart_tx_status = HAL_ERROR;
+    BVR_LOG(INFO, "last line");
+    usleep(20000);
+    CHECK(strstr(test_out, "last line") == NULL);
+
+    host_uart_tx_status = HAL_OK;
+    CHECK(test_wait_for("INFO\t: last line\r\n"));
+}
+
+
+int main(void)
+{
+    host_uart_tx_hook = test_uart_tx;
+    BVR_uart_debug_init();
+
+    test_many_tasks();
+    test_refused();
+    test_retried();
+
+    puts("test_log_task ok");
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
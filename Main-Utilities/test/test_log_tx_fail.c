@@ -0,0 +1,90 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_log_tx_fail.c
+* @brief    a uart DMA that will not start does not wedge the logger
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       HAL_UART_Transmit_DMA is made to fail. The claim has to be handed back
+*       and busy cleared so the lines go out once the uart works again.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <string.h>
+#include "BVR_debug_logger.h"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+static char test_out[4096];
+static int test_out_len = 0;
+static volatile int test_pending = 0;
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+/* keep what was sent, the test completes the transfer */
+static void test_uart_tx(UART_HandleTypeDef *huart, const uint8_t *p_data, uint16_t size)
+{
+    UNUSED(huart);
+    CHECK((test_out_len + size) < (int)sizeof(test_out));
+    memcpy(&test_out[test_out_len], p_data, size);
+    test_out_len += size;
+    test_out[test_out_len] = '\0';
+    test_pending = 1;
+}
+
+
+static void test_drain(void)
+{
+    while(test_pending)
+    {
+        test_pending = 0;
+        BVR_uart_debug_tx_cplt();
+    }
+}
+
+
+int main(void)
+{
+    host_uart_tx_hook = test_uart_tx;
+    BVR_uart_debug_init();
+
+    // the DMA refuses, the line has to stay queued and the uart not look busy
+    host_uart_tx_status = HAL_ERROR;
+    BVR_LOG(INFO, "first line");
+    BVR_LOG(WARN, "urgent line");
+    CHECK(BVR_uart_debug_send((uint8_t *)"raw\r\n", 5) == BVR_ERROR);
+    CHECK(test_out_len == 0);
+
+    // the next line starts the uart and everything goes out, urgent first
+    host_uart_tx_status = HAL_OK;
+    BVR_LOG(INFO, "second line");
+    test_drain();
+
+    CHECK(strstr(test_out, "WARN\t: urgent line") != NULL);
+    CHECK(strstr(test_out, "INFO\t: first line\r\nraw\r\nINFO\t: second line\r\n") != NULL);
+    CHECK(strstr(test_out, "WARN") < strstr(test_out, "first line"));
+
+    puts("test_log_tx_fail ok");
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
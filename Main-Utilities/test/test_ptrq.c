@@ -0,0 +1,211 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_ptrq.c
+* @brief    pointer queue SPSC and MPMC stress
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Numbered pointers go through an spsc queue in batches, then three
+*       producers and two consumers share one mpmc queue. Every pointer must
+*       come out exactly once, and in order per producer for each consumer.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <pthread.h>
+#include <sched.h>
+#include "BVR_fifo_buffer.h"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+#define TEST_DEPTH      16
+#define TEST_ITEMS      100000
+#define TEST_PRODUCERS  3
+#define TEST_CONSUMERS  2
+
+/* producer in the top byte, sequence + 1 below so no item is NULL */
+#define TEST_ITEM(p, s)     ((void *)(uintptr_t)(((uint32_t)(p) << 24) | ((s) + 1)))
+#define TEST_PRODUCER(i)    ((int)((uintptr_t)(i) >> 24))
+#define TEST_SEQ(i)         ((uint32_t)((uintptr_t)(i) & 0xFFFFFF) - 1)
+
+static ptr_queue_t test_queue;
+static void *test_slots[TEST_DEPTH];
+static uint32_t test_seq[TEST_DEPTH];
+static uint8_t test_seen[TEST_PRODUCERS][TEST_ITEMS];
+static uint32_t test_popped = 0;
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+static void *test_spsc_producer(void *arg)
+{
+    void *items[5];
+    uint32_t next = 0;
+    int count;
+    int i;
+
+    (void)arg;
+
+    while(next < TEST_ITEMS)
+    {
+        count = 1 + (int)(next % 5);
+        if((next + count) > TEST_ITEMS){count = (int)(TEST_ITEMS - next);}
+        for(i = 0; i < count; i++){items[i] = TEST_ITEM(0, next + i);}
+
+        // a batch pushes what fits, the rest goes next time
+        count = BVR_ptrq_push_batch(&test_queue, items, count);
+        if(count == 0){sched_yield();}
+        next += count;
+    }
+
+    return NULL;
+}
+
+
+static void test_spsc(void)
+{
+    pthread_t producer;
+    void *items[7];
+    uint32_t expected = 0;
+    int count;
+    int i;
+
+    CHECK(BVR_ptrq_init(&test_queue, test_slots, TEST_DEPTH) == BVR_OK);
+    CHECK(BVR_ptrq_init(&test_queue, test_slots, 12) == BVR_ERROR);
+    CHECK(BVR_ptrq_init(&test_queue, test_slots, TEST_DEPTH) == BVR_OK);
+    CHECK(pthread_create(&producer, NULL, test_spsc_producer, NULL) == 0);
+
+    while(expected < TEST_ITEMS)
+    {
+        count = BVR_ptrq_pop_batch(&test_queue, items, 7);
+        if(count == 0){sched_yield();}
+        for(i = 0; i < count; i++)
+        {
+            CHECK(items[i] == TEST_ITEM(0, expected));
+            expected++;
+        }
+    }
+
+    pthread_join(producer, NULL);
+    CHECK(BVR_ptrq_level(&test_queue) == 0);
+}
+
+
+static void *test_mpmc_producer(void *arg)
+{
+    int id = (int)(uintptr_t)arg;
+    uint32_t next = 0;
+
+    while(next < TEST_ITEMS)
+    {
+        if(BVR_ptrq_push(&test_queue, TEST_ITEM(id, next)) == BVR_OK){next++;}
+        else{sched_yield();}
+    }
+
+    return NULL;
+}
+
+
+static void *test_mpmc_consumer(void *arg)
+{
+    uint32_t last[TEST_PRODUCERS];
+    void *items[4];
+    int count;
+    int producer;
+    int i;
+
+    (void)arg;
+    for(i = 0; i < TEST_PRODUCERS; i++){last[i] = UINT32_MAX;}
+
+    while(BVR_LOAD_ACQUIRE(&test_popped) < (TEST_PRODUCERS * TEST_ITEMS))
+    {
+        // mix single pops and batches
+        if((BVR_LOAD_ACQUIRE(&test_popped) & 1) == 0)
+        {
+            count = (BVR_ptrq_pop(&test_queue, &items[0]) == BVR_OK) ? 1 : 0;
+        }
+        else
+        {
+            count = BVR_ptrq_pop_batch(&test_queue, items, 4);
+        }
+
+        if(count == 0)
+        {
+            sched_yield();
+            continue;
+        }
+
+        for(i = 0; i < count; i++)
+        {
+            producer = TEST_PRODUCER(items[i]);
+            CHECK(producer < TEST_PRODUCERS);
+            CHECK(TEST_SEQ(items[i]) < TEST_ITEMS);
+            CHECK((last[producer] == UINT32_MAX) || (TEST_SEQ(items[i]) > last[producer]));
+            last[producer] = TEST_SEQ(items[i]);
+            test_seen[producer][TEST_SEQ(items[i])]++;
+        }
+        BVR_ATOMIC_ADD(&test_popped, count);
+    }
+
+    return NULL;
+}
+
+
+static void test_mpmc(void)
+{
+    pthread_t producers[TEST_PRODUCERS];
+    pthread_t consumers[TEST_CONSUMERS];
+    int producer;
+    int i;
+
+    CHECK(BVR_ptrq_init_mpmc(&test_queue, test_slots, test_seq, TEST_DEPTH) == BVR_OK);
+
+    for(i = 0; i < TEST_CONSUMERS; i++)
+    {
+        CHECK(pthread_create(&consumers[i], NULL, test_mpmc_consumer, NULL) == 0);
+    }
+    for(i = 0; i < TEST_PRODUCERS; i++)
+    {
+        CHECK(pthread_create(&producers[i], NULL, test_mpmc_producer, (void *)(uintptr_t)i) == 0);
+    }
+    for(i = 0; i < TEST_PRODUCERS; i++){pthread_join(producers[i], NULL);}
+    for(i = 0; i < TEST_CONSUMERS; i++){pthread_join(consumers[i], NULL);}
+
+    // every pointer exactly once
+    for(producer = 0; producer < TEST_PRODUCERS; producer++)
+    {
+        for(i = 0; i < TEST_ITEMS; i++)
+        {
+            CHECK(test_seen[producer][i] == 1);
+        }
+    }
+    CHECK(BVR_ptrq_level(&test_queue) == 0);
+}
+
+
+int main(void)
+{
+    test_spsc();
+    test_mpmc();
+    puts("test_ptrq ok");
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
@@ -0,0 +1,200 @@
+/**
+********************************************************************************
+* @author   Byron Palavikas
+* @date
+* @file     test_record.c
+* @brief    record fifo keeps records whole and in order
+* @version  V0.1
+* @target   Linux host
+* @IDE
+* @repo     git@github.com:bpalavikas/STM32-helper.git
+*
+********************************************************************************
+* @attention
+*       Single and batch pops on one thread, with records over the wrap
+*       and a pop buffer that is too small, then a producer thread pushes
+*       records of every length while this thread pops them one at a time
+*       and in batches. Each record carries its sequence number so a torn
+*       or lost record is caught.
+********************************************************************************
+*/
+
+
+/******************************************************************************/
+/*                                                                            */
+/******************************************************************************/
+
+
+/*--INCLUDES------------------------------------------------------------------*/
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include "BVR_fifo_buffer.h"
+#include "bvr_test.h"
+
+
+/*--DATA--TYPE----------------------------------------------------------------*/
+
+#define TEST_RECORDS    200000
+#define TEST_MAX_RECORD 90
+#define TEST_BATCH      128
+
+static record_fifo_t test_rec;
+static uint8_t test_buffer[301];
+
+
+/*--FUNCTION------------------------------------------------------------------*/
+
+/* record seq is seq % TEST_MAX_RECORD long, filled from seq */
+static int test_fill(uint8_t *record, uint32_t seq)
+{
+    int size = (int)(seq % TEST_MAX_RECORD);
+    int i;
+
+    for(i = 0; i < size; i++){record[i] = (uint8_t)(seq + i);}
+    return size;
+}
+
+
+static void test_check(const uint8_t *record, int size, uint32_t seq)
+{
+    uint8_t expect[TEST_MAX_RECORD];
+
+    CHECK(size == test_fill(expect, seq));
+    CHECK(memcmp(record, expect, size) == 0);
+}
+
+
+static void test_single(void)
+{
+    uint8_t data[TEST_MAX_RECORD];
+    uint8_t out[TEST_BATCH];
+    uint32_t msgs;
+    int size;
+
+    memset(data, 0x33, sizeof(data));
+    CHECK(BVR_record_init(&test_rec, test_buffer, 64) == BVR_OK);
+
+    // empty, then a zero length record is still a record
+    CHECK(BVR_record_pop(&test_rec, out, sizeof(out), &size) == BVR_ERROR);
+    CHECK(BVR_record_pop_batch(&test_rec, out, sizeof(out)) == 0);
+    CHECK(BVR_record_push(&test_rec, data, 0) == BVR_OK);
+    CHECK(BVR_fifo_level(&test_rec.fifo) == RECORD_HEADER_SIZE);
+    CHECK(BVR_record_pop(&test_rec, out, 0, &size) == BVR_OK);
+    CHECK(size == 0);
+
+    // header and data have to fit together, a miss is one dropped message
+    CHECK(BVR_record_push(&test_rec, data, 63) == BVR_ERROR);
+    CHECK(BVR_record_push(&test_rec, data, -1) == BVR_ERROR);
+    CHECK(BVR_record_push(&test_rec, data, RECORD_MAX_SIZE + 1) == BVR_ERROR);
+    BVR_fifo_get_drops(&test_rec.fifo, &msgs, NULL);
+    CHECK(msgs == 3);
+    CHECK(BVR_fifo_level(&test_rec.fifo) == 0);
+
+    // move the tail on so the next record runs over the wrap
+    CHECK(BVR_record_push(&test_rec, data, 50) == BVR_OK);
+    CHECK(BVR_record_pop(&test_rec, out, sizeof(out), &size) == BVR_OK);
+    CHECK(test_fill(data, 20) == 20);
+    CHECK(BVR_record_push(&test_rec, data, 20) == BVR_OK);
+
+    // too small a buffer leaves the record where it is
+    CHECK(BVR_record_pop(&test_rec, out, 19, &size) == BVR_ERROR);
+    CHECK(BVR_fifo_level(&test_rec.fifo) == RECORD_HEADER_SIZE + 20);
+    CHECK(BVR_record_pop(&test_rec, out, 20, &size) == BVR_OK);
+    test_check(out, size, 20);
+
+    // a batch stops before the record that would not fit
+    CHECK(BVR_record_push(&test_rec, data, 10) == BVR_OK);
+    CHECK(BVR_record_push(&test_rec, data, 10) == BVR_OK);
+    CHECK(BVR_record_push(&test_rec, data, 10) == BVR_OK);
+    CHECK(BVR_record_pop_batch(&test_rec, out, 2 * (RECORD_HEADER_SIZE + 10) + 5) ==
+          2 * (RECORD_HEADER_SIZE + 10));
+    CHECK((out[0] | (out[1] << 8)) == 10);
+    CHECK(BVR_record_pop_batch(&test_rec, out, RECORD_HEADER_SIZE + 9) == 0);
+    CHECK(BVR_record_pop_batch(&test_rec, out, sizeof(out)) == RECORD_HEADER_SIZE + 10);
+
+    // an overwrite can cut a record anywhere so record pops refuse it
+    CHECK(BVR_record_push(&test_rec, data, 10) == BVR_OK);
+    CHECK(BVR_fifo_set_policy(&test_rec.fifo, FIFO_OVERWRITE, 0) == BVR_OK);
+    CHECK(BVR_record_pop(&test_rec, out, sizeof(out), &size) == BVR_ERROR);
+    CHECK(BVR_record_pop_batch(&test_rec, out, sizeof(out)) == 0);
+}
+
+
+static void *test_producer(void *arg)
+{
+    uint8_t record[TEST_MAX_RECORD];
+    uint32_t seq;
+    int size;
+
+    (void)arg;
+
+    for(seq = 0; seq < TEST_RECORDS; seq++)
+    {
+        size = test_fill(record, seq);
+        while(BVR_record_push(&test_rec, record, size) != BVR_OK){sched_yield();}
+    }
+
+    return NULL;
+}
+
+
+/* odd passes pop one record, even passes split a batch by its length prefixes */
+static void test_threads(void)
+{
+    pthread_t producer;
+    uint8_t out[TEST_BATCH];
+    uint32_t seq = 0;
+    int offset;
+    int total;
+    int size;
+
+    CHECK(BVR_record_init(&test_rec, test_buffer, sizeof(test_buffer)) == BVR_OK);
+    CHECK(pthread_create(&producer, NULL, test_producer, NULL) == 0);
+
+    while(seq < TEST_RECORDS)
+    {
+        if(seq & 0x01)
+        {
+            if(BVR_record_pop(&test_rec, out, sizeof(out), &size) != BVR_OK)
+            {
+                sched_yield();
+                continue;
+            }
+            test_check(out, size, seq++);
+            continue;
+        }
+
+        total = BVR_record_pop_batch(&test_rec, out, sizeof(out));
+        if(total == 0)
+        {
+            sched_yield();
+            continue;
+        }
+
+        for(offset = 0; offset < total; offset += RECORD_HEADER_SIZE + size)
+        {
+            size = out[offset] | (out[offset + 1] << 8);
+            CHECK((offset + RECORD_HEADER_SIZE + size) <= total);
+            test_check(&out[offset + RECORD_HEADER_SIZE], size, seq++);
+        }
+    }
+
+    pthread_join(producer, NULL);
+    CHECK(BVR_fifo_level(&test_rec.fifo) == 0);
+}
+
+
+int main(void)
+{
+    test_single();
+    test_threads();
+
+    puts("test_record ok");
+    return 0;
+}
+
+
+/******************************************************************************/
+/*                             END OF FILE                                    */
+/******************************************************************************/
@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""
+Decode BVR_debug_logger deferred records (LOG_DEFERRED) back to text.
+
+The format strings are read from the .bvr_log_fmt section of the firmware
+ELF, %s arguments are read from the loaded sections (flash strings).
+Bytes outside a record (log_print text) are passed straight through.
+
+    python3 bvr_log_decode.py firmware.elf capture.bin
+    python3 bvr_log_decode.py firmware.elf - < /dev/ttyACM0
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+LOG_DEFERRED_SYNC = 0xB5
+LOG_FMT_SECTION = ".bvr_log_fmt"
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+# printf conversion, length modifiers are dropped for python
+CONVERSION = re.compile(r"%([-+ #0]*)(\d+|\*)?(?:\.(\d+|\*))?(?:hh|h|ll|l|j|z|t|L)?([diouxXcspfFeEgG%])")
+
+
+class Elf:
+    """just enough ELF to read sections by name and memory by address"""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+
+        if self.data[:4] != b"\x7fELF":
+            raise ValueError("%s is not an ELF file" % path)
+
+        is_64 = self.data[4] == 2
+        self.end = "<" if self.data[5] == 1 else ">"
+
+        if is_64:
+            shoff, = struct.unpack_from(self.end + "Q", self.data, 0x28)
+            shentsize, shnum, shstrndx = struct.unpack_from(self.end + "HHH", self.data, 0x3A)
+            header = "IIQQQQIIQQ"
+        else:
+            shoff, = struct.unpack_from(self.end + "I", self.data, 0x20)
+            shentsize, shnum, shstrndx = struct.unpack_from(self.end + "HHH", self.data, 0x2E)
+            header = "IIIIIIIIII"
+
+        raw = [struct.unpack_from(self.end + header, self.data, shoff + i * shentsize)
+               for i in range(shnum)]
+        names = raw[shstrndx][4]
+
+        # name, type, flags, addr, offset, size
+        self.sections = [(self.cstring_at(names + s[0]), s[1], s[2], s[3], s[4], s[5]) for s in raw]
+
+    def cstring_at(self, offset):
+        end = self.data.index(b"\0", offset)
+        return self.data[offset:end].decode("latin-1")
+
+    def section(self, name):
+        for section in self.sections:
+            if section[0] == name:
+                return section
+        return None
+
+    def string_at(self, addr):
+        """constant string at a target address, None if it is not in the image"""
+        for name, kind, flags, base, offset, size in self.sections:
+            if (flags & SHF_ALLOC) and kind != SHT_NOBITS and base <= addr < base + size:
+                return self.cstring_at(offset + addr - base)
+        return None
+
+
+def load_formats(elf):
+    section = elf.section(LOG_FMT_SECTION)
+    if section is None:
+        raise ValueError("no %s section, is LOG_DEFERRED set?" % LOG_FMT_SECTION)
+
+    _, _, _, base, offset, size = section
+    formats = {}
+    pos = 0
+
+    # strings are packed back to back, the id is the address of each
+    while pos < size:
+        end = elf.data.index(b"\0", offset + pos)
+        formats[base + pos] = elf.data[offset + pos:end].decode("latin-1")
+        pos = end - offset + 1
+        # skip alignment padding
+        while pos < size and elf.data[offset + pos] == 0:
+            pos += 1
+
+    return formats
+
+
+def render(fmt, args, elf):
+    """printf fmt with 32 bit argument words"""
+    args = list(args)
+
+    def take():
+        return args.pop(0) if args else 0
+
+    def convert(match):
+        flags, width, precision, kind = match.groups()
+        if kind == "%":
+            return "%"
+
+        if width == "*":
+            width = str(take())
+        if precision == "*":
+            precision = str(take())
+
+        word = take()
+        spec = "%" + flags + (width or "") + ("." + precision if precision else "")
+
+        if kind in "di":
+            return (spec + "d") % (word - (1 << 32) if word & 0x80000000 else word)
+        if kind in "ouxX":
+            return (spec + ("d" if kind == "u" else kind)) % word
+        if kind == "c":
+            return (spec + "c") % chr(word & 0xFF)
+        if kind == "p":
+            return (spec + "s") % ("0x%08x" % word)
+        if kind == "s":
+            text = elf.string_at(word)
+            return (spec + "s") % (text if text is not None else "<0x%08x>" % word)
+        # floats are not carried in a record
+        return "<float>"
+
+    return CONVERSION.sub(convert, fmt)
+
+
+def decode(stream, elf, formats, out, ticks):
+    data = b""
+    text = bytearray()
+
+    def flush_text():
+        if text:
+            out.write(text.decode("latin-1"))
+            text.clear()
+
+    while True:
+        chunk = stream.read(4096)
+        if not chunk:
+            break
+        data += chunk
+        pos = 0
+
+        while pos < len(data):
+            if data[pos] != LOG_DEFERRED_SYNC:
+                text.append(data[pos])
+                pos += 1
+                continue
+
+            # wait for the whole record
+            if pos + 10 > len(data):
+                break
+            nargs = data[pos + 1]
+            if pos + 10 + 4 * nargs > len(data):
+                break
+
+            fmt_id, tick = struct.unpack_from("<II", data, pos + 2)
+            if fmt_id not in formats:
+                # not a record after all
+                text.append(data[pos])
+                pos += 1
+                continue
+
+            args = struct.unpack_from("<%dI" % nargs, data, pos + 10)
+            flush_text()
+            if ticks:
+                out.write("[%10.3f] " % (tick / 1000.0))
+            out.write(render(formats[fmt_id], args, elf))
+            pos += 10 + 4 * nargs
+
+        data = data[pos:]
+        flush_text()
+        out.flush()
+
+    text.extend(data)
+    flush_text()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("elf", help="firmware ELF built with LOG_DEFERRED")
+    parser.add_argument("capture", help="uart capture file, - for stdin")
+    parser.add_argument("--no-ticks", action="store_true", help="do not print the tick")
+    options = parser.parse_args()
+
+    elf = Elf(options.elf)
+    formats = load_formats(elf)
+    stream = sys.stdin.buffer if options.capture == "-" else open(options.capture, "rb")
+
+    try:
+        decode(stream, elf, formats, sys.stdout, not options.no_ticks)
+    finally:
+        if stream is not sys.stdin.buffer:
+            stream.close()
+
+
+if __name__ == "__main__":
+    main()